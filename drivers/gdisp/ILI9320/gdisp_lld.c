@@ -399,6 +399,33 @@ void gdisp_lld_draw_pixel(coord_t x, coord_t y, color_t color) {
 	}
 #endif
 
+#if (GDISP_NEED_PIXELREAD && GDISP_HARDWARE_READAREA) || defined(__DOXYGEN__)
+	void gdisp_lld_read_area(coord_t x, coord_t y, coord_t cx, coord_t cy, pixel_t *buffer) {
+		coord_t stride, i;
+		volatile uint16_t dummy;
+
+		stride = cx;
+		#if GDISP_NEED_VALIDATION || GDISP_NEED_CLIP
+			if (x < 0) { cx += x; buffer -= x; x = 0; }
+			if (y < 0) { cy += y; buffer -= y*stride; y = 0; }
+			if (cx <= 0 || cy <= 0 || x >= GDISP.Width || y >= GDISP.Height) return;
+			if (x+cx > GDISP.Width)		cx = GDISP.Width - x;
+			if (y+cy > GDISP.Height)	cy = GDISP.Height - y;
+		#endif
+
+		/* The window is set once and then the whole area streamed back */
+		lld_lcdSetViewPort(x, y, cx, cy);
+		lld_lcdReadStreamStart();
+		dummy = lld_lcdReadData();
+		(void)dummy;
+		for(; cy; cy--, buffer += stride)
+			for(i = 0; i < cx; i++)
+				buffer[i] = lld_lcdReadData();
+		lld_lcdReadStreamStop();
+		lld_lcdResetViewPort();
+	}
+#endif
+
 #if (GDISP_NEED_SCROLL && GDISP_HARDWARE_SCROLL) || defined(__DOXYGEN__)
 	void gdisp_lld_vertical_scroll(coord_t x, coord_t y, coord_t cx, coord_t cy, int lines, color_t bgcolor) {
 		static color_t buf[((GDISP_SCREEN_HEIGHT > GDISP_SCREEN_WIDTH ) ? GDISP_SCREEN_HEIGHT : GDISP_SCREEN_WIDTH)];
@@ -117,6 +117,166 @@ static __inline void setviewport(coord_t x, coord_t y, coord_t cx, coord_t cy) {
 	}
 }
 
+// Fill an already clipped area of the panel with a color.
+static void panel_fill_area(coord_t x, coord_t y, coord_t cx, coord_t cy, color_t color) {
+	unsigned tuples;
+
+	tuples = (cx*cy+1)>>1;				// With an odd sized area we over-print by one pixel.
+										// This extra pixel overwrites the first pixel (harmless as it is the same colour)
+
+	acquire_bus();
+	setviewport(x, y, cx, cy);
+	write_cmd(RAMWR);
+	while(tuples--)
+		write_data3(((color >> 4) & 0xFF), (((color << 4) & 0xF0)|((color >> 8) & 0x0F)), (color & 0xFF));
+	release_bus();
+}
+
+// Fill an already clipped area of the panel with a bitmap.
+static void panel_blit_area(coord_t x, coord_t y, coord_t cx, coord_t cy, coord_t srcx, coord_t srcy, coord_t srccx, const pixel_t *buffer) {
+	coord_t		lg;
+	color_t		c1, c2;
+	unsigned	tuples;
+	#if GDISP_PACKED_PIXELS
+		unsigned		pnum, pstart;
+		const uint8_t	*p;
+	#else
+		const pixel_t	*p;
+	#endif
+
+	/* Set up the data window to transfer */
+	tuples = (cx * cy + 1)>>1;
+	acquire_bus();
+	setviewport(x, y, cx, cy);
+	write_cmd(RAMWR);
+
+	/*
+	 * Due to the way the Nokia6610 handles a decrementing column or page,
+	 * we have to make adjustments as to where it is actually drawing from in the bitmap.
+	 * For example, for 90 degree rotation the column is decremented on each
+	 * memory write. The controller always starts with column 0 and then decrements
+	 * to column cx-1, cx-2 etc. We therefore have to write-out the last bitmap line first.
+	 */
+	switch(GDISP.Orientation) {
+	case GDISP_ROTATE_0:		x = 0;		y = 0;		break;
+	case GDISP_ROTATE_90:		x = 0;		y = cy-1;	break;
+	case GDISP_ROTATE_180:		x = cx-1;	y = cy-1;	break;
+	case GDISP_ROTATE_270:		x = cx-1;	y = 0;		break;
+	}
+
+	#if !GDISP_PACKED_PIXELS
+		// Although this controller uses packed pixels we support unpacked pixel
+		//  formats in this blit by packing the data as we feed it to the controller.
+
+		lg = srccx - cx;						// The buffer gap between lines
+		buffer += srcy * srccx + srcx;			// The buffer start position
+		p = buffer + srccx*y + x;				// Adjustment for controller craziness
+
+		while(tuples--) {
+			/* Get a pixel */
+			c1 = *p++;
+
+			/* Check for line or buffer wrapping */
+			if (++x >= cx) {
+				x = 0;
+				p += lg;
+				if (++y >= cy) {
+					y = 0;
+					p = buffer;
+				}
+			}
+
+			/* Get the next pixel */
+			c2 = *p++;
+
+			/* Check for line or buffer wrapping */
+			if (++x >= cx) {
+				x = 0;
+				p += lg;
+				if (++y >= cy) {
+					y = 0;
+					p = buffer;
+				}
+			}
+
+			/* Write the pair of pixels to the display */
+			write_data3(((c1 >> 4) & 0xFF), (((c1 << 4) & 0xF0)|((c2 >> 8) & 0x0F)), (c2 & 0xFF));
+		}
+
+	#else
+
+		// Although this controller uses packed pixels, we may have to feed it into
+		//  the controller with different packing to the source bitmap
+		// There are 2 pixels per 3 bytes
+
+		#if !GDISP_PACKED_LINES
+			srccx = (srccx + 1) & ~1;
+		#endif
+		pstart = srcy * srccx + srcx;												// The starting pixel number
+		buffer = (const pixel_t)(((const uint8_t *)buffer) + ((pstart>>1) * 3));	// The buffer start position
+		lg = ((srccx-cx)>>1)*3;														// The buffer gap between lines
+		pnum = pstart + srccx*y + x;												// Adjustment for controller craziness
+		p = ((const uint8_t *)buffer) + (((srccx*y + x)>>1)*3);						// Adjustment for controller craziness
+
+		while (tuples--) {
+			/* Get a pixel */
+			switch(pnum++ & 1) {
+			case 0:		c1 = (((color_t)p[0]) << 4)|(((color_t)p[1])>>4);				break;
+			case 1:		c1 = (((color_t)p[1]&0x0F) << 8)|((color_t)p[1]);	p += 3;		break;
+			}
+
+			/* Check for line or buffer wrapping */
+			if (++x >= cx) {
+				x = 0;
+				p += lg;
+				pnum += srccx - cx;
+				if (++y >= cy) {
+					y = 0;
+					p = (const uint8_t *)buffer;
+					pnum = pstart;
+				}
+			}
+
+			/* Get the next pixel */
+			switch(pnum++ & 1) {
+			case 0:		c1 = (((color_t)p[0]) << 4)|(((color_t)p[1])>>4);				break;
+			case 1:		c1 = (((color_t)p[1]&0x0F) << 8)|((color_t)p[1]);	p += 3;		break;
+			}
+
+			/* Check for line or buffer wrapping */
+			if (++x >= cx) {
+				x = 0;
+				p += lg;
+				pnum += srccx - cx;
+				if (++y >= cy) {
+					y = 0;
+					p = (const uint8_t *)buffer;
+					pnum = pstart;
+				}
+			}
+
+			/* Write the pair of pixels to the display */
+			write_data3(((c1 >> 4) & 0xFF), (((c1 << 4) & 0xF0)|((c2 >> 8) & 0x0F)), (c2 & 0xFF));
+		}
+	#endif
+
+	/* All done */
+	release_bus();
+}
+
+#if GDISP_USE_DELTA
+	/* The delta encoder does all the drawing and calls these to send just what has changed */
+	void gdisp_lld_delta_fill_span(coord_t x, coord_t y, coord_t cx, color_t color) {
+		panel_fill_area(x, y, cx, 1, color);
+	}
+
+	void gdisp_lld_delta_write_span(coord_t x, coord_t y, coord_t cx, const pixel_t *pixels) {
+		panel_blit_area(x, y, cx, 1, 0, 0, cx, pixels);
+	}
+
+	#include "gdisp/lld/delta.c"
+#endif
+
 /*===========================================================================*/
 /* Driver interrupt handlers.                                                */
 /*===========================================================================*/
@@ -185,6 +345,7 @@ bool_t gdisp_lld_init(void) {
 	return TRUE;
 }
 
+#if !GDISP_USE_DELTA
 /**
  * @brief   Draws a pixel on the display.
  *
@@ -203,10 +364,11 @@ void gdisp_lld_draw_pixel(coord_t x, coord_t y, color_t color) {
 	write_cmd3(RAMWR, 0, (color>>8) & 0x0F, color & 0xFF);
 	release_bus();
 }
+#endif
 
 /* ---- Optional Routines ---- */
 
-#if GDISP_HARDWARE_FILLS || defined(__DOXYGEN__)
+#if (GDISP_HARDWARE_FILLS && !GDISP_USE_DELTA) || defined(__DOXYGEN__)
 	/**
 	 * @brief   Fill an area with a color.
 	 *
@@ -217,8 +379,6 @@ void gdisp_lld_draw_pixel(coord_t x, coord_t y, color_t color) {
 	 * @notapi
 	 */
 	void gdisp_lld_fill_area(coord_t x, coord_t y, coord_t cx, coord_t cy, color_t color) {
-		unsigned tuples;
-
 		#if GDISP_NEED_VALIDATION || GDISP_NEED_CLIP
 			if (x < GDISP.clipx0) { cx -= GDISP.clipx0 - x; x = GDISP.clipx0; }
 			if (y < GDISP.clipy0) { cy -= GDISP.clipy0 - y; y = GDISP.clipy0; }
@@ -227,19 +387,11 @@ void gdisp_lld_draw_pixel(coord_t x, coord_t y, color_t color) {
 			if (y+cy > GDISP.clipy1)	cy = GDISP.clipy1 - y;
 		#endif
 
-		tuples = (cx*cy+1)>>1;				// With an odd sized area we over-print by one pixel.
-											// This extra pixel overwrites the first pixel (harmless as it is the same colour)
-
-		acquire_bus();
-		setviewport(x, y, cx, cy);
-		write_cmd(RAMWR);
-		while(tuples--)
-			write_data3(((color >> 4) & 0xFF), (((color << 4) & 0xF0)|((color >> 8) & 0x0F)), (color & 0xFF));
-		release_bus();
+		panel_fill_area(x, y, cx, cy, color);
 	}
 #endif
 
-#if GDISP_HARDWARE_BITFILLS || defined(__DOXYGEN__)
+#if (GDISP_HARDWARE_BITFILLS && !GDISP_USE_DELTA) || defined(__DOXYGEN__)
 	/**
 	 * @brief   Fill an area with a bitmap.
 	 *
@@ -252,16 +404,6 @@ void gdisp_lld_draw_pixel(coord_t x, coord_t y, color_t color) {
 	 * @notapi
 	 */
 	void gdisp_lld_blit_area_ex(coord_t x, coord_t y, coord_t cx, coord_t cy, coord_t srcx, coord_t srcy, coord_t srccx, const pixel_t *buffer) {
-		coord_t		lg;
-		color_t		c1, c2;
-		unsigned	tuples;
-		#if GDISP_PACKED_PIXELS
-			unsigned		pnum, pstart;
-			const uint8_t	*p;
-		#else
-			const pixel_t	*p;
-		#endif
-
 		#if GDISP_NEED_VALIDATION || GDISP_NEED_CLIP
 			if (x < GDISP.clipx0) { cx -= GDISP.clipx0 - x; srcx += GDISP.clipx0 - x; x = GDISP.clipx0; }
 			if (y < GDISP.clipy0) { cy -= GDISP.clipy0 - y; srcy += GDISP.clipy0 - y; y = GDISP.clipy0; }
@@ -271,128 +413,11 @@ void gdisp_lld_draw_pixel(coord_t x, coord_t y, color_t color) {
 			if (y+cy > GDISP.clipy1)	cy = GDISP.clipy1 - y;
 		#endif
 
-		/* Set up the data window to transfer */
-		tuples = (cx * cy + 1)>>1;
-		acquire_bus();
-		setviewport(x, y, cx, cy);
-		write_cmd(RAMWR);
-
-		/*
-		 * Due to the way the Nokia6610 handles a decrementing column or page,
-		 * we have to make adjustments as to where it is actually drawing from in the bitmap.
-		 * For example, for 90 degree rotation the column is decremented on each
-		 * memory write. The controller always starts with column 0 and then decrements
-		 * to column cx-1, cx-2 etc. We therefore have to write-out the last bitmap line first.
-		 */
-		switch(GDISP.Orientation) {
-		case GDISP_ROTATE_0:		x = 0;		y = 0;		break;
-		case GDISP_ROTATE_90:		x = 0;		y = cy-1;	break;
-		case GDISP_ROTATE_180:		x = cx-1;	y = cy-1;	break;
-		case GDISP_ROTATE_270:		x = cx-1;	y = 0;		break;
-		}
-
-		#if !GDISP_PACKED_PIXELS
-			// Although this controller uses packed pixels we support unpacked pixel
-			//  formats in this blit by packing the data as we feed it to the controller.
-
-			lg = srccx - cx;						// The buffer gap between lines
-			buffer += srcy * srccx + srcx;			// The buffer start position
-			p = buffer + srccx*y + x;				// Adjustment for controller craziness
-
-			while(tuples--) {
-				/* Get a pixel */
-				c1 = *p++;
-
-				/* Check for line or buffer wrapping */
-				if (++x >= cx) {
-					x = 0;
-					p += lg;
-					if (++y >= cy) {
-						y = 0;
-						p = buffer;
-					}
-				}
-
-				/* Get the next pixel */
-				c2 = *p++;
-
-				/* Check for line or buffer wrapping */
-				if (++x >= cx) {
-					x = 0;
-					p += lg;
-					if (++y >= cy) {
-						y = 0;
-						p = buffer;
-					}
-				}
-
-				/* Write the pair of pixels to the display */
-				write_data3(((c1 >> 4) & 0xFF), (((c1 << 4) & 0xF0)|((c2 >> 8) & 0x0F)), (c2 & 0xFF));
-			}
-
-		#else
-
-			// Although this controller uses packed pixels, we may have to feed it into
-			//  the controller with different packing to the source bitmap
-			// There are 2 pixels per 3 bytes
-
-			#if !GDISP_PACKED_LINES
-				srccx = (srccx + 1) & ~1;
-			#endif
-			pstart = srcy * srccx + srcx;												// The starting pixel number
-			buffer = (const pixel_t)(((const uint8_t *)buffer) + ((pstart>>1) * 3));	// The buffer start position
-			lg = ((srccx-cx)>>1)*3;														// The buffer gap between lines
-			pnum = pstart + srccx*y + x;												// Adjustment for controller craziness
-			p = ((const uint8_t *)buffer) + (((srccx*y + x)>>1)*3);						// Adjustment for controller craziness
-
-			while (tuples--) {
-				/* Get a pixel */
-				switch(pnum++ & 1) {
-				case 0:		c1 = (((color_t)p[0]) << 4)|(((color_t)p[1])>>4);				break;
-				case 1:		c1 = (((color_t)p[1]&0x0F) << 8)|((color_t)p[1]);	p += 3;		break;
-				}
-
-				/* Check for line or buffer wrapping */
-				if (++x >= cx) {
-					x = 0;
-					p += lg;
-					pnum += srccx - cx;
-					if (++y >= cy) {
-						y = 0;
-						p = (const uint8_t *)buffer;
-						pnum = pstart;
-					}
-				}
-
-				/* Get the next pixel */
-				switch(pnum++ & 1) {
-				case 0:		c1 = (((color_t)p[0]) << 4)|(((color_t)p[1])>>4);				break;
-				case 1:		c1 = (((color_t)p[1]&0x0F) << 8)|((color_t)p[1]);	p += 3;		break;
-				}
-
-				/* Check for line or buffer wrapping */
-				if (++x >= cx) {
-					x = 0;
-					p += lg;
-					pnum += srccx - cx;
-					if (++y >= cy) {
-						y = 0;
-						p = (const uint8_t *)buffer;
-						pnum = pstart;
-					}
-				}
-
-				/* Write the pair of pixels to the display */
-				write_data3(((c1 >> 4) & 0xFF), (((c1 << 4) & 0xF0)|((c2 >> 8) & 0x0F)), (c2 & 0xFF));
-			}
-		#endif
-
-		/* All done */
-		release_bus();
+		panel_blit_area(x, y, cx, cy, srcx, srcy, srccx, buffer);
 	}
 #endif
 
-#if (GDISP_NEED_PIXELREAD && GDISP_HARDWARE_PIXELREAD)
+#if (GDISP_NEED_PIXELREAD && GDISP_HARDWARE_PIXELREAD && !GDISP_USE_DELTA)
 	/**
 	 * @brief   Get the color of a particular pixel.
 	 * @note    If x,y is off the screen, the result is undefined.
@@ -409,7 +434,7 @@ void gdisp_lld_draw_pixel(coord_t x, coord_t y, color_t color) {
 	}
 #endif
 
-#if (GDISP_NEED_SCROLL && GDISP_HARDWARE_SCROLL)
+#if (GDISP_NEED_SCROLL && GDISP_HARDWARE_SCROLL && !GDISP_USE_DELTA)
 	/**
 	 * @brief   Scroll vertically a section of the screen.
 	 * @note    If x,y + cx,cy is off the screen, the result is undefined.
@@ -546,6 +571,10 @@ void gdisp_lld_draw_pixel(coord_t x, coord_t y, color_t color) {
 				GDISP.clipx1 = GDISP.Width;
 				GDISP.clipy1 = GDISP.Height;
 			#endif
+			#if GDISP_USE_DELTA
+				/* The panel no longer matches the shadow */
+				gdisp_lld_delta_invalidate();
+			#endif
 			GDISP.Orientation = (gdisp_orientation_t)value;
 			return;
 		case GDISP_CONTROL_BACKLIGHT:
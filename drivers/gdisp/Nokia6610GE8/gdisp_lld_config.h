@@ -37,9 +37,20 @@
 
 #define GDISP_DRIVER_NAME				"Nokia6610GE8"
 
+/* Only send the pixels that have changed over the SPI link. This keeps a 130 x 130 pixel
+ *	shadow of the screen in RAM which also allows pixel reads, scrolling and area copies.
+ */
+#ifndef GDISP_USE_DELTA
+	#define GDISP_USE_DELTA				FALSE
+#endif
+
 #define GDISP_HARDWARE_FILLS			TRUE
 #define GDISP_HARDWARE_BITFILLS			TRUE
 #define GDISP_HARDWARE_CONTROL			TRUE
+#define GDISP_HARDWARE_CLEARS			GDISP_USE_DELTA
+#define GDISP_HARDWARE_PIXELREAD		GDISP_USE_DELTA
+#define GDISP_HARDWARE_SCROLL			GDISP_USE_DELTA
+#define GDISP_HARDWARE_COPYAREA			GDISP_USE_DELTA
 
 #define GDISP_SOFTWARE_TEXTFILLDRAW		FALSE
 #define GDISP_SOFTWARE_TEXTBLITCOLUMN	FALSE
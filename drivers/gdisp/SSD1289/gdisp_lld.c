@@ -399,6 +399,43 @@ void gdisp_lld_draw_pixel(coord_t x, coord_t y, color_t color) {
 	}
 #endif
 
+#if (GDISP_NEED_PIXELREAD && GDISP_HARDWARE_READAREA) || defined(__DOXYGEN__)
+	/**
+	 * @brief   Read an area of the screen into a buffer.
+	 * @note    Optional - The high level driver can emulate using pixel reads.
+	 * @note    Any part of the area that is off the screen is left unchanged in the buffer.
+	 *
+	 * @param[in] x, y     The start of the area to read
+	 * @param[in] cx, cy   The size of the area to read
+	 * @param[out] buffer  The buffer to read into (cx pixels per line)
+	 *
+	 * @notapi
+	 */
+	void gdisp_lld_read_area(coord_t x, coord_t y, coord_t cx, coord_t cy, pixel_t *buffer) {
+		coord_t stride, i;
+
+		stride = cx;
+		#if GDISP_NEED_VALIDATION || GDISP_NEED_CLIP
+			if (x < 0) { cx += x; buffer -= x; x = 0; }
+			if (y < 0) { cy += y; buffer -= y*stride; y = 0; }
+			if (cx <= 0 || cy <= 0 || x >= GDISP.Width || y >= GDISP.Height) return;
+			if (x+cx > GDISP.Width)		cx = GDISP.Width - x;
+			if (y+cy > GDISP.Height)	cy = GDISP.Height - y;
+		#endif
+
+		/* The window is set once and then the whole area streamed back */
+		acquire_bus();
+		set_viewport(x, y, cx, cy);
+		stream_start();
+		i = read_data();			// dummy read
+		for(; cy; cy--, buffer += stride)
+			for(i = 0; i < cx; i++)
+				buffer[i] = read_data();
+		stream_stop();
+		release_bus();
+	}
+#endif
+
 #if (GDISP_NEED_SCROLL && GDISP_HARDWARE_SCROLL) || defined(__DOXYGEN__)
 	/**
 	 * @brief   Scroll vertically a section of the screen.
@@ -42,6 +42,7 @@
 #define GDISP_HARDWARE_BITFILLS			TRUE
 #define GDISP_HARDWARE_SCROLL			TRUE
 #define GDISP_HARDWARE_PIXELREAD		TRUE
+#define GDISP_HARDWARE_READAREA			TRUE
 #define GDISP_HARDWARE_CONTROL			TRUE
 
 #define GDISP_PIXELFORMAT				GDISP_PIXELFORMAT_RGB565
@@ -34,11 +34,25 @@
 #define GDISP_NEED_ELLIPSE			TRUE
 #define GDISP_NEED_ARC				FALSE
 #define GDISP_NEED_CONVEX_POLYGON	FALSE
+#define GDISP_NEED_GRADIENT			FALSE
+#define GDISP_NEED_PATTERN			FALSE
+#define GDISP_NEED_SCALE			FALSE
+#define GDISP_NEED_ROTATE			FALSE
+#define GDISP_NEED_BLITMONO_LUT		FALSE
 #define GDISP_NEED_SCROLL			FALSE
 #define GDISP_NEED_PIXELREAD		FALSE
+#define GDISP_NEED_COPYAREA			FALSE
 #define GDISP_NEED_CONTROL			FALSE
 #define GDISP_NEED_QUERY			FALSE
 #define GDISP_NEED_IMAGE			FALSE
+#define GDISP_NEED_TILE				FALSE
+#define GDISP_NEED_SHADOW			FALSE
+#define GDISP_NEED_TEXT_CACHE		FALSE
+#define GDISP_NEED_UTF8				FALSE
+#define GDISP_NEED_TEXT_BLIT		FALSE
+#define GDISP_NEED_TEXTBOX			FALSE
+#define GDISP_NEED_FONT_LOAD		FALSE
+#define GDISP_NEED_FONT_REGISTRY	FALSE
 #define GDISP_NEED_MULTITHREAD		FALSE
 #define GDISP_NEED_ASYNC			FALSE
 #define GDISP_NEED_MSGAPI			FALSE
@@ -67,6 +81,8 @@
 	#define GDISP_NEED_IMAGE_BMP_16		TRUE
 	#define GDISP_NEED_IMAGE_BMP_24		TRUE
 	#define GDISP_NEED_IMAGE_BMP_32		TRUE
+	#define GDISP_NEED_IMAGE_BMP_RLE_INDEX	FALSE
+	#define GDISP_NEED_IMAGE_NATIVE_RLE	TRUE
 */
 
 /* Features for the TDISP subsystem. */
@@ -45,6 +45,42 @@
 	#error "GDISP: GDISP_MAX_FONT_HEIGHT must be either 16 or 32"
 #endif
 
+/**
+ * @brief   The glyph data formats.
+ * @details	FONT_FORMAT_COLUMNS	- dataTable holds fontcolumn_t columns, LSBit at the top.
+ * 									This is the format of the built in fonts.
+ * 			FONT_FORMAT_ROWS	- glyphData holds rows of pixels, MSBit on the left.
+ * 									Each pixel is bpp bits and each row is padded to a whole byte.
+ * 			FONT_FORMAT_RLE		- glyphData holds run lengths (one byte each) across the rows
+ * 									of the glyph alternating between background and foreground,
+ * 									starting with background. Longer runs are split with a zero
+ * 									length run of the other color.
+ * @note	The row based formats are created by the font2c tool and have no height limit.
+ * @note	Anti-aliased fonts (2 or 4 bits per pixel) must use FONT_FORMAT_ROWS. Each pixel
+ * 			is the coverage from 0 (background) to all ones (foreground).
+ */
+#define FONT_FORMAT_COLUMNS		0
+#define FONT_FORMAT_ROWS		1
+#define FONT_FORMAT_RLE			2
+
+/**
+ * @brief   Added to the format of a font loaded by @p gdispLoadFont().
+ * @details	The glyph data of these fonts is not in memory. Each glyph is read from
+ * 			the font file into a small cache when it is drawn.
+ */
+#define FONT_FORMAT_PAGED		0x80
+
+/**
+ * @brief   A range of characters outside a font's minChar to maxChar range.
+ * @details	The ranges of a font are sorted by first character and don't overlap.
+ */
+typedef struct fontrange_t {
+	unicode_t			first;		/* The first character in the range */
+	uint16_t			count;		/* The number of characters in the range */
+	uint16_t			index;		/* The position of the first character in widthTable and offsetTable */
+	uint32_t			base;		/* Added to the offsets in offsetTable for this range */
+} fontrange_t;
+
 /**
  * @brief   Internal font structure.
  * @note	This structure is followed by:
@@ -53,6 +89,10 @@
  *				3. Each characters array of column data (fontcolumn_t)
  *			Each sub-structure must be padded to a multiple of 8 bytes
  *			to allow the tables to work across many different compilers.
+ * @note	For the row based formats the offsets are byte offsets into glyphData.
+ * @note	Characters minChar to maxChar are found directly. Any others are found
+ * 			by a binary search of the ranges. minChar greater than maxChar means
+ * 			the font only has ranges.
  */
 struct font {
 	const char *		name;
@@ -69,11 +109,186 @@ struct font {
 	const uint8_t		*widthTable;
 	const uint16_t      *offsetTable;
 	const fontcolumn_t  *dataTable;
+	uint8_t				format;
+	uint8_t				bpp;
+	const uint8_t		*glyphData;
+	const fontrange_t	*ranges;
+	uint16_t			rangeCount;
 };
 
-#define _getCharWidth(f,c)		(((c) < (f)->minChar || (c) > (f)->maxChar) ? 0 : (f)->widthTable[(c) - (f)->minChar])
-#define _getCharOffset(f,c)		((f)->offsetTable[(c) - (f)->minChar])
-#define _getCharData(f,c)		(&(f)->dataTable[_getCharOffset(f, c)])
+#define _isDenseChar(f,c)		((c) >= (uint8_t)(f)->minChar && (c) <= (uint8_t)(f)->maxChar)
+#define _getCharWidth(f,c)		(_isDenseChar(f, c) ? (f)->widthTable[(c) - (uint8_t)(f)->minChar] : (f)->rangeCount ? fontGetRangeWidth(f, c) : 0)
+#define _getCharOffset(f,c)		(_isDenseChar(f, c) ? (f)->offsetTable[(c) - (uint8_t)(f)->minChar] : fontGetRangeOffset(f, c))
+#define _getFontFormat(f)		((f)->format & ~FONT_FORMAT_PAGED)
+#if GDISP_NEED_FONT_LOAD
+	#define _getCharData(f,c)	(((f)->format & FONT_FORMAT_PAGED) ? (const fontcolumn_t *)fontGetPagedGlyph(f, c) : &(f)->dataTable[_getCharOffset(f, c)])
+	#define _getCharGlyph(f,c)	(((f)->format & FONT_FORMAT_PAGED) ? fontGetPagedGlyph(f, c) : &(f)->glyphData[_getCharOffset(f, c)])
+#else
+	#define _getCharData(f,c)	(&(f)->dataTable[_getCharOffset(f, c)])
+	#define _getCharGlyph(f,c)	(&(f)->glyphData[_getCharOffset(f, c)])
+#endif
+
+/**
+ * @brief   The state of a row based glyph being decoded.
+ * @details	A glyph is decoded a row at a time as runs of pixels with the same coverage.
+ * 			Decoding a row again means taking a copy of the state before it.
+ */
+typedef struct fontdecoder_t {
+	const uint8_t		*ptr;		/* The next glyph data byte */
+	const uint8_t		*end;		/* FONT_FORMAT_RLE: The end of a paged glyph's cache entry (NULL if unknown) */
+	uint8_t				format;		/* The glyph format */
+	uint8_t				width;		/* The glyph width (unscaled) */
+	uint8_t				x;			/* The position in the current row */
+	uint8_t				bpp;		/* FONT_FORMAT_ROWS: The bits per pixel */
+	uint8_t				bit;		/* FONT_FORMAT_ROWS: The position of the next pixel in *ptr */
+	uint8_t				on;			/* FONT_FORMAT_RLE: The current run is foreground */
+	uint8_t				left;		/* FONT_FORMAT_RLE: The pixels left in the current run */
+} fontdecoder_t;
+
+/**
+ * @brief   The colors for each coverage level when drawing a font over a known background.
+ * @details	It is only recalculated when the colors or the bits per pixel change.
+ */
+typedef struct fontramp_t {
+	color_t				color;
+	color_t				bgcolor;
+	uint8_t				bpp;
+	color_t				ramp[16];
+} fontramp_t;
+
+/**
+ * @brief   Get the next character from a string and move past it.
+ * @note	The string is UTF-8 if GDISP_NEED_UTF8 is TRUE.
+ */
+#if GDISP_NEED_UTF8
+	#define _getStringChar(s)			fontGetUTF8Char(&(s))
+	#define _getStringPrevChar(s, ss)	fontGetUTF8PrevChar(&(s), ss)
+#else
+	#define _getStringChar(s)			((unicode_t)(uint8_t)*(s)++)
+	#define _getStringPrevChar(s, ss)	((unicode_t)(uint8_t)*--(s))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+	/**
+	 * @brief   Get the width of a character found in the font's ranges.
+	 * @return	The width (unscaled) or 0 if the font doesn't have the character
+	 * @note	Use _getCharWidth() which handles all characters.
+	 *
+	 * @param[in] font		The font
+	 * @param[in] c			The character
+	 */
+	uint8_t fontGetRangeWidth(const struct font *font, unicode_t c);
+
+	/**
+	 * @brief   Get the data offset of a character found in the font's ranges.
+	 * @note	Only valid if the character has a non-zero width.
+	 *
+	 * @param[in] font		The font
+	 * @param[in] c			The character
+	 */
+	uint32_t fontGetRangeOffset(const struct font *font, unicode_t c);
+
+	#if GDISP_NEED_FONT_LOAD || defined(__DOXYGEN__)
+		/**
+		 * @brief   Get the glyph data of a character of a loaded font.
+		 * @details	The glyph is read from the font file if it isn't already in the font's glyph cache.
+		 * @note	Use _getCharData() or _getCharGlyph() which handle all fonts.
+		 * @note	The data is only valid until GDISP_FONT_LOAD_CACHE other glyphs of the font have been read.
+		 * @note	The glyph cache has no lock of its own. Only call this (and use the data) with the
+		 * 			GDISP lock held or from the GDISP drawing routines.
+		 *
+		 * @param[in] font		The font (FONT_FORMAT_PAGED)
+		 * @param[in] c			The character (it must have a non-zero width)
+		 */
+		const uint8_t *fontGetPagedGlyph(const struct font *font, unicode_t c);
+
+		/**
+		 * @brief   Counts the loaded fonts that have been closed.
+		 * @details	Anything that remembers glyphs by font pointer must forget them when this
+		 * 			changes as a new font may now be at the same address.
+		 */
+		extern unsigned fontUnloadCount;
+	#endif
+
+	#if GDISP_NEED_UTF8 || defined(__DOXYGEN__)
+		/**
+		 * @brief   Decode the next UTF-8 character in a string.
+		 * @return	The character. Invalid sequences return 0xFFFD.
+		 *
+		 * @param[in,out] pstr	The string. It is moved past the character.
+		 */
+		unicode_t fontGetUTF8Char(const char **pstr);
+
+		/**
+		 * @brief   Decode the UTF-8 character before a position in a string.
+		 * @return	The character. Invalid sequences return 0xFFFD.
+		 *
+		 * @param[in,out] pstr	The position. It is moved back to the start of the character.
+		 * @param[in] start		The start of the string
+		 */
+		unicode_t fontGetUTF8PrevChar(const char **pstr, const char *start);
+	#endif
+
+	/**
+	 * @brief   Start decoding a row based glyph.
+	 *
+	 * @param[out] d		The decoder state
+	 * @param[in] font		The font (FONT_FORMAT_ROWS or FONT_FORMAT_RLE)
+	 * @param[in] c			The character (it must have a non-zero width)
+	 */
+	void fontDecodeStart(fontdecoder_t *d, const struct font *font, unicode_t c);
+
+	/**
+	 * @brief   Get the next run of pixels.
+	 * @return	The length of the run (unscaled). A run never continues past the end of a row.
+	 *
+	 * @param[in] d			The decoder state
+	 * @param[out] level	The coverage of the run. 0 is background and (1 << bpp) - 1 is foreground.
+	 */
+	uint8_t fontDecodeRun(fontdecoder_t *d, uint8_t *level);
+
+	/**
+	 * @brief   Blend between two colors.
+	 * @return	The blended color
+	 *
+	 * @param[in] color		The foreground color
+	 * @param[in] bgcolor	The background color
+	 * @param[in] level		The coverage of the foreground from 0 to (1 << bpp) - 1
+	 * @param[in] bpp		The bits per pixel of the font
+	 */
+	color_t fontBlendColor(color_t color, color_t bgcolor, uint8_t level, uint8_t bpp);
+
+	/**
+	 * @brief   Get the color for each coverage level of a font
+	 * @return	The table of (1 << bpp) colors
+	 *
+	 * @param[in] r			The ramp to fill. It is left alone if it already matches.
+	 * @param[in] bpp		The bits per pixel of the font
+	 * @param[in] color		The foreground color
+	 * @param[in] bgcolor	The background color
+	 */
+	const color_t *fontGetRamp(fontramp_t *r, uint8_t bpp, color_t color, color_t bgcolor);
+
+	/**
+	 * @brief   Expand some of the (scaled) columns of a character into a bitmap.
+	 * @details	Every pixel of the columns is written for the full (scaled) height of the font.
+	 *
+	 * @param[in] buf		The bitmap
+	 * @param[in] stride	The width of the bitmap in pixels
+	 * @param[in] bx		The column in the bitmap to put the first pixel
+	 * @param[in] c			The character
+	 * @param[in] font		The font
+	 * @param[in] sx,cx		The first scaled column of the character and the number of columns
+	 * @param[in] ramp		The colors for each level of the font (see @p fontGetRamp())
+	 */
+	void fontExpandChar(pixel_t *buf, coord_t stride, coord_t bx, unicode_t c, const struct font *font, coord_t sx, coord_t cx, const color_t *ramp);
+
+#ifdef __cplusplus
+}
+#endif
 
 #endif /* _GDISP_FONTS_H */
 /** @} */
@@ -81,6 +81,14 @@ typedef struct point_t {
  * @brief   Type for the text justification.
  */
 typedef enum justify {justifyLeft, justifyCenter, justifyRight} justify_t;
+/**
+ * @brief   Type for the direction of a gradient fill.
+ */
+typedef enum gradient {gradientHorizontal, gradientVertical} gradient_t;
+/**
+ * @brief   Type for the filtering used when scaling a bitmap.
+ */
+typedef enum scalemode {scaleNearest, scaleBilinear} scalemode_t;
 /**
  * @brief   Type for the font metric.
  */
@@ -89,6 +97,10 @@ typedef enum fontmetric {fontHeight, fontDescendersHeight, fontLineSpacing, font
  * @brief   The type of a font.
  */
 typedef const struct font *font_t;
+/**
+ * @brief   The type of a character (a unicode code point).
+ */
+typedef uint32_t unicode_t;
 /**
  * @brief   Type for the screen orientation.
  */
@@ -114,6 +126,10 @@ typedef struct GDISPDriver_t {
 			coord_t				clipx0, clipy0;
 			coord_t				clipx1, clipy1;		/* not inclusive */
 		#endif
+		#if GDISP_NEED_TEXT_CACHE
+			uint32_t			textCacheHits;
+			uint32_t			textCacheMisses;
+		#endif
 		} GDISPDriver;
 
 extern GDISPDriver	GDISP;
@@ -306,19 +322,26 @@ extern GDISPDriver	GDISP;
 	#error "GDISP: A packed pixel format has been specified for an unsupported pixel format."
 #endif
 
-#if GDISP_NEED_SCROLL && !GDISP_HARDWARE_SCROLL
+#if GDISP_NEED_SCROLL && !GDISP_HARDWARE_SCROLL && !GDISP_NEED_SHADOW
 	#error "GDISP: Hardware scrolling is wanted but not supported."
 #endif
 
-#if GDISP_NEED_PIXELREAD && !GDISP_HARDWARE_PIXELREAD
+#if GDISP_NEED_PIXELREAD && !GDISP_HARDWARE_PIXELREAD && !GDISP_NEED_SHADOW
 	#error "GDISP: Pixel read-back is wanted but not supported."
 #endif
 
+#if GDISP_NEED_COPYAREA && !GDISP_HARDWARE_COPYAREA && !GDISP_NEED_PIXELREAD && !GDISP_NEED_SHADOW
+	#error "GDISP: Area copying without hardware support requires GDISP_NEED_PIXELREAD."
+#endif
+
 /**
  * @brief   The type of a pixel.
  */
 typedef color_t		pixel_t;
 
+/* Include the low level driver information */
+#include "gdisp/lld/gdisp_lld.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -417,6 +440,46 @@ extern "C" {
 	 */
 	void gdispBlitAreaEx(coord_t x, coord_t y, coord_t cx, coord_t cy, coord_t srcx, coord_t srcy, coord_t srccx, const pixel_t *buffer);
 
+	/**
+	 * @brief   Fill an area using a monochrome (1 bit per pixel) bitmap.
+	 * @details Set bits are drawn in the foreground color. Clear bits are either
+	 * 			drawn in the background color or left untouched if transparent is TRUE.
+	 * @note	The bitmap is stored a line at a time with the most significant bit of
+	 * 			each byte being the left most pixel.
+	 * @note	If GDISP_NEED_ASYNC is defined then the bitmap must be static
+	 * 			or at least retained until this call has finished the blit.
+	 *
+	 * @param[in] x,y			The start position
+	 * @param[in] cx,cy			The size of the filled area
+	 * @param[in] bits			The bitmap
+	 * @param[in] stride		The number of bytes in each line of the bitmap
+	 * @param[in] fg			The color for set bits
+	 * @param[in] bg			The color for clear bits
+	 * @param[in] transparent	If TRUE clear bits are not drawn
+	 *
+	 * @api
+	 */
+	void gdispBlitMono(coord_t x, coord_t y, coord_t cx, coord_t cy, const uint8_t *bits, coord_t stride, color_t fg, color_t bg, bool_t transparent);
+
+	/**
+	 * @brief   Fill an area using the supplied bitmap skipping any transparent pixels.
+	 * @details The same as @p gdispBlitAreaEx() except that pixels matching the key color
+	 * 			are not drawn.
+	 * @note	Packed pixel formats are not supported.
+	 * @note	If GDISP_NEED_ASYNC is defined then the buffer must be static
+	 * 			or at least retained until this call has finished the blit.
+	 *
+	 * @param[in] x,y		The start position
+	 * @param[in] cx,cy		The size of the filled area
+	 * @param[in] srcx,srcy The bitmap position to start the fill form
+	 * @param[in] srccx		The width of a line in the bitmap
+	 * @param[in] buffer	The bitmap in the driver's pixel format
+	 * @param[in] keycolor	The transparent color
+	 *
+	 * @api
+	 */
+	void gdispBlitAreaKeyed(coord_t x, coord_t y, coord_t cx, coord_t cy, coord_t srcx, coord_t srcy, coord_t srccx, const pixel_t *buffer, color_t keycolor);
+
 	/* Clipping Functions */
 
 	#if GDISP_NEED_CLIP || defined(__DOXYGEN__)
@@ -527,7 +590,7 @@ extern "C" {
 		 *
 		 * @api
 		 */
-		void gdispDrawChar(coord_t x, coord_t y, char c, font_t font, color_t color);
+		void gdispDrawChar(coord_t x, coord_t y, unicode_t c, font_t font, color_t color);
 
 		/**
 		 * @brief   Draw a text character with a filled background.
@@ -540,7 +603,7 @@ extern "C" {
 		 *
 		 * @api
 		 */
-		void gdispFillChar(coord_t x, coord_t y, char c, font_t font, color_t color, color_t bgcolor);
+		void gdispFillChar(coord_t x, coord_t y, unicode_t c, font_t font, color_t color, color_t bgcolor);
 	#endif
 	
 	/* Read a pixel Function */
@@ -555,6 +618,21 @@ extern "C" {
 		 * @api
 		 */
 		color_t gdispGetPixelColor(coord_t x, coord_t y);
+
+		/**
+		 * @brief   Read an area of the screen into a buffer.
+		 * @note    The buffer is in the driver's pixel format with cx pixels per line.
+		 * @note    Any part of the area that is off the screen is left unchanged in the buffer.
+		 * @note    This is much faster than calling @p gdispGetPixelColor() for each pixel
+		 * 			if the driver supports reading an area (GDISP_HARDWARE_READAREA).
+		 *
+		 * @param[in] x,y		The start of the area to read
+		 * @param[in] cx,cy		The size of the area to read
+		 * @param[out] buffer	The buffer to read the pixels into (cx * cy pixels)
+		 *
+		 * @api
+		 */
+		void gdispReadArea(coord_t x, coord_t y, coord_t cx, coord_t cy, pixel_t *buffer);
 	#endif
 
 	/* Scrolling Function - clears the area scrolled out */
@@ -576,6 +654,24 @@ extern "C" {
 		void gdispVerticalScroll(coord_t x, coord_t y, coord_t cx, coord_t cy, int lines, color_t bgcolor);
 	#endif
 
+	/* Copy Area Function */
+
+	#if GDISP_NEED_COPYAREA || defined(__DOXYGEN__)
+		/**
+		 * @brief   Copy an area of the screen to somewhere else on the screen.
+		 * @pre		GDISP_NEED_COPYAREA must be set to TRUE in halconf.h
+		 * @note    The source and destination areas may overlap.
+		 * @note    Only the part of the destination within the clipping area is changed.
+		 *
+		 * @param[in] srcx, srcy	The start of the area to be copied
+		 * @param[in] cx, cy		The size of the area to be copied
+		 * @param[in] dstx, dsty	Where to copy it to
+		 *
+		 * @api
+		 */
+		void gdispCopyArea(coord_t srcx, coord_t srcy, coord_t cx, coord_t cy, coord_t dstx, coord_t dsty);
+	#endif
+
 	/* Set driver specific control */
 
 	#if GDISP_NEED_CONTROL || defined(__DOXYGEN__)
@@ -609,10 +705,30 @@ extern "C" {
 		void *gdispQuery(unsigned what);
 	#endif
 
-#else
-	/* Include the low level driver information */
-	#include "gdisp/lld/gdisp_lld.h"
+	/* Locking Functions */
 
+	/**
+	 * @brief   Take exclusive use of the display for a batch of drawing operations.
+	 * @details	Until @p gdispUnlock() is called only the calling thread can draw. Use the
+	 * 			@p _unsafe variants of the drawing functions while the lock is held as they
+	 * 			don't try to take the lock themselves.
+	 * @note    With GDISP_NEED_ASYNC this also waits for any queued drawing to finish
+	 * 			so that operations are not reordered.
+	 * @note    The lock is not recursive. Calling a normal (locking) gdisp drawing function
+	 * 			while the lock is held will deadlock.
+	 *
+	 * @api
+	 */
+	void gdispLock(void);
+
+	/**
+	 * @brief   Release the lock taken by @p gdispLock().
+	 *
+	 * @api
+	 */
+	void gdispUnlock(void);
+
+#else
 	/* The same as above but use the low level driver directly if no multi-thread support is needed */
 	#define gdispInit(gdisp)									gdisp_lld_init()
 	#define gdispIsBusy()										FALSE
@@ -621,6 +737,8 @@ extern "C" {
 	#define gdispDrawLine(x0, y0, x1, y1, color)				gdisp_lld_draw_line(x0, y0, x1, y1, color)
 	#define gdispFillArea(x, y, cx, cy, color)					gdisp_lld_fill_area(x, y, cx, cy, color)
 	#define gdispBlitAreaEx(x, y, cx, cy, sx, sy, scx, buf)		gdisp_lld_blit_area_ex(x, y, cx, cy, sx, sy, scx, buf)
+	#define gdispBlitMono(x, y, cx, cy, bits, stride, fg, bg, t)	gdisp_lld_blit_mono(x, y, cx, cy, bits, stride, fg, bg, t)
+	#define gdispBlitAreaKeyed(x, y, cx, cy, sx, sy, scx, buf, key)	gdisp_lld_blit_area_keyed(x, y, cx, cy, sx, sy, scx, buf, key)
 	#define gdispSetClip(x, y, cx, cy)							gdisp_lld_set_clip(x, y, cx, cy)
 	#define gdispDrawCircle(x, y, radius, color)				gdisp_lld_draw_circle(x, y, radius, color)
 	#define gdispFillCircle(x, y, radius, color)				gdisp_lld_fill_circle(x, y, radius, color)
@@ -631,12 +749,40 @@ extern "C" {
 	#define gdispDrawChar(x, y, c, font, color)					gdisp_lld_draw_char(x, y, c, font, color)
 	#define gdispFillChar(x, y, c, font, color, bgcolor)		gdisp_lld_fill_char(x, y, c, font, color, bgcolor)
 	#define gdispGetPixelColor(x, y)							gdisp_lld_get_pixel_color(x, y)
+	#define gdispReadArea(x, y, cx, cy, buffer)					gdisp_lld_read_area(x, y, cx, cy, buffer)
 	#define gdispVerticalScroll(x, y, cx, cy, lines, bgcolor)	gdisp_lld_vertical_scroll(x, y, cx, cy, lines, bgcolor)
+	#define gdispCopyArea(srcx, srcy, cx, cy, dstx, dsty)		gdisp_lld_copy_area(srcx, srcy, cx, cy, dstx, dsty)
 	#define gdispControl(what, value)							gdisp_lld_control(what, value)
 	#define gdispQuery(what)									gdisp_lld_query(what)
+	#define gdispLock()
+	#define gdispUnlock()
 
 #endif
 
+/* Unlocked variants of the above - only for use between gdispLock() and gdispUnlock() */
+#define gdispClear_unsafe(color)									gdisp_lld_clear(color)
+#define gdispDrawPixel_unsafe(x, y, color)							gdisp_lld_draw_pixel(x, y, color)
+#define gdispDrawLine_unsafe(x0, y0, x1, y1, color)					gdisp_lld_draw_line(x0, y0, x1, y1, color)
+#define gdispFillArea_unsafe(x, y, cx, cy, color)					gdisp_lld_fill_area(x, y, cx, cy, color)
+#define gdispBlitAreaEx_unsafe(x, y, cx, cy, sx, sy, scx, buf)		gdisp_lld_blit_area_ex(x, y, cx, cy, sx, sy, scx, buf)
+#define gdispBlitMono_unsafe(x, y, cx, cy, bits, stride, fg, bg, t)	gdisp_lld_blit_mono(x, y, cx, cy, bits, stride, fg, bg, t)
+#define gdispBlitAreaKeyed_unsafe(x, y, cx, cy, sx, sy, scx, buf, key)	gdisp_lld_blit_area_keyed(x, y, cx, cy, sx, sy, scx, buf, key)
+#define gdispSetClip_unsafe(x, y, cx, cy)							gdisp_lld_set_clip(x, y, cx, cy)
+#define gdispDrawCircle_unsafe(x, y, radius, color)					gdisp_lld_draw_circle(x, y, radius, color)
+#define gdispFillCircle_unsafe(x, y, radius, color)					gdisp_lld_fill_circle(x, y, radius, color)
+#define gdispDrawArc_unsafe(x, y, radius, sangle, eangle, color)	gdisp_lld_draw_arc(x, y, radius, sangle, eangle, color)
+#define gdispFillArc_unsafe(x, y, radius, sangle, eangle, color)	gdisp_lld_fill_arc(x, y, radius, sangle, eangle, color)
+#define gdispDrawEllipse_unsafe(x, y, a, b, color)					gdisp_lld_draw_ellipse(x, y, a, b, color)
+#define gdispFillEllipse_unsafe(x, y, a, b, color)					gdisp_lld_fill_ellipse(x, y, a, b, color)
+#define gdispDrawChar_unsafe(x, y, c, font, color)					gdisp_lld_draw_char(x, y, c, font, color)
+#define gdispFillChar_unsafe(x, y, c, font, color, bgcolor)			gdisp_lld_fill_char(x, y, c, font, color, bgcolor)
+#define gdispGetPixelColor_unsafe(x, y)								gdisp_lld_get_pixel_color(x, y)
+#define gdispReadArea_unsafe(x, y, cx, cy, buffer)					gdisp_lld_read_area(x, y, cx, cy, buffer)
+#define gdispVerticalScroll_unsafe(x, y, cx, cy, lines, bgcolor)	gdisp_lld_vertical_scroll(x, y, cx, cy, lines, bgcolor)
+#define gdispCopyArea_unsafe(srcx, srcy, cx, cy, dstx, dsty)		gdisp_lld_copy_area(srcx, srcy, cx, cy, dstx, dsty)
+#define gdispControl_unsafe(what, value)							gdisp_lld_control(what, value)
+#define gdispQuery_unsafe(what)										gdisp_lld_query(what)
+
 /* These routines are not hardware accelerated
  *	- Do not add a hardware accelerated routines here.
  */
@@ -689,6 +835,130 @@ void gdispDrawBox(coord_t x, coord_t y, coord_t cx, coord_t cy, color_t color);
 	void gdispFillConvexPoly(coord_t tx, coord_t ty, const point *pntarray, unsigned cnt, color_t color);
 #endif
 
+#if GDISP_NEED_GRADIENT || defined(__DOXYGEN__)
+	/**
+	 * @brief   Fill an area with a linear gradient
+	 *
+	 * @param[in] x,y		The start position
+	 * @param[in] cx,cy		The size of the area
+	 * @param[in] direction	Horizontal (c0 at the left) or vertical (c0 at the top)
+	 * @param[in] c0, c1	The colors at the start and the end of the gradient
+	 *
+	 * @note	Vertical gradients are drawn as one fill per color band.
+	 * 			Horizontal gradients are calculated once into a line buffer and blitted.
+	 *
+	 * @api
+	 */
+	void gdispFillAreaGradient(coord_t x, coord_t y, coord_t cx, coord_t cy, gradient_t direction, color_t c0, color_t c1);
+
+	/**
+	 * @brief   Fill an area with a linear gradient between two points
+	 * @details	The gradient runs from c0 at (x0,y0) to c1 at (x1,y1). Beyond those points
+	 * 			the end colors are used.
+	 *
+	 * @param[in] x,y		The start position
+	 * @param[in] cx,cy		The size of the area
+	 * @param[in] x0,y0		The screen position of the start of the gradient
+	 * @param[in] c0		The color at the start of the gradient
+	 * @param[in] x1,y1		The screen position of the end of the gradient
+	 * @param[in] c1		The color at the end of the gradient
+	 *
+	 * @api
+	 */
+	void gdispFillAreaGradientPoints(coord_t x, coord_t y, coord_t cx, coord_t cy, coord_t x0, coord_t y0, color_t c0, coord_t x1, coord_t y1, color_t c1);
+
+	/**
+	 * @brief   Draw a rectangular box with rounded corners filled with a linear gradient
+	 *
+	 * @param[in] x,y		The start position
+	 * @param[in] cx,cy		The size of the box (outside dimensions)
+	 * @param[in] radius	The radius of the rounded corners
+	 * @param[in] direction	Horizontal (c0 at the left) or vertical (c0 at the top)
+	 * @param[in] c0, c1	The colors at the start and the end of the gradient
+	 *
+	 * @note	Unlike @p gdispFillRoundedBox() this doesn't need GDISP_NEED_ARC.
+	 *
+	 * @api
+	 */
+	void gdispFillRoundedBoxGradient(coord_t x, coord_t y, coord_t cx, coord_t cy, coord_t radius, gradient_t direction, color_t c0, color_t c1);
+#endif
+
+#if GDISP_NEED_PATTERN || defined(__DOXYGEN__)
+	/**
+	 * @brief   Fill an area with a repeating 8x8 monochrome pattern
+	 *
+	 * @param[in] x,y		The start position
+	 * @param[in] cx,cy		The size of the area
+	 * @param[in] pattern	8 bytes, one for each line of the pattern. The most significant bit is on the left.
+	 * @param[in] fg		The color to use for set bits
+	 * @param[in] bg		The color to use for clear bits
+	 *
+	 * @note	The pattern is aligned to the screen rather than to the area so that
+	 * 			adjacent areas filled with the same pattern join up seamlessly.
+	 *
+	 * @api
+	 */
+	void gdispFillAreaPattern(coord_t x, coord_t y, coord_t cx, coord_t cy, const uint8_t *pattern, color_t fg, color_t bg);
+
+	/**
+	 * @brief   Fill an area with a repeating 8x8 color pattern
+	 *
+	 * @param[in] x,y		The start position
+	 * @param[in] cx,cy		The size of the area
+	 * @param[in] pattern	64 pixels, 8 lines of 8 pixels
+	 *
+	 * @note	The pattern is aligned to the screen rather than to the area.
+	 *
+	 * @api
+	 */
+	void gdispFillAreaPatternColor(coord_t x, coord_t y, coord_t cx, coord_t cy, const pixel_t *pattern);
+#endif
+
+#if GDISP_NEED_SCALE || defined(__DOXYGEN__)
+	/**
+	 * @brief   Fill an area using a part of a bitmap scaled to fit
+	 * @details	The source area (srcx,srcy,srccx2,srccy2) is stretched or shrunk to
+	 * 			fill the destination area (x,y,cx,cy).
+	 *
+	 * @param[in] x,y		The start position
+	 * @param[in] cx,cy		The size of the filled area
+	 * @param[in] srcx,srcy The bitmap position to start the fill from
+	 * @param[in] srccx2,srccy2	The size of the area of the bitmap to use
+	 * @param[in] srccx		The width of a line in the bitmap
+	 * @param[in] buffer	The bitmap in the driver's pixel format
+	 * @param[in] mode		scaleNearest or scaleBilinear
+	 *
+	 * @note	Each line is calculated into a line buffer and blitted. When a source
+	 * 			line is repeated (eg. when enlarging) the calculated line is reused.
+	 * @note	Packed pixel formats are not supported.
+	 *
+	 * @api
+	 */
+	void gdispBlitAreaScaled(coord_t x, coord_t y, coord_t cx, coord_t cy, coord_t srcx, coord_t srcy, coord_t srccx2, coord_t srccy2, coord_t srccx, const pixel_t *buffer, scalemode_t mode);
+#endif
+
+#if GDISP_NEED_ROTATE || defined(__DOXYGEN__)
+	/**
+	 * @brief   Draw a bitmap rotated by an arbitrary angle
+	 * @details	The bitmap is rotated around the pivot point (px,py) in the bitmap
+	 * 			which is drawn at the screen position (x,y). Only the pixels covered
+	 * 			by the rotated bitmap are drawn.
+	 *
+	 * @param[in] x,y		The screen position of the pivot point
+	 * @param[in] srccx,srccy	The size of the bitmap
+	 * @param[in] buffer	The bitmap in the driver's pixel format
+	 * @param[in] px,py		The pivot point within the bitmap
+	 * @param[in] angle		The angle in degrees (0 to 359) counter-clockwise
+	 *
+	 * @note	Each screen line is inverse mapped back into the bitmap using fixed point
+	 * 			increments and sent as a single span. No floating point is used.
+	 * @note	Packed pixel formats are not supported.
+	 *
+	 * @api
+	 */
+	void gdispBlitAreaRotated(coord_t x, coord_t y, coord_t srccx, coord_t srccy, const pixel_t *buffer, coord_t px, coord_t py, coord_t angle);
+#endif
+
 /* Extra Text Functions */
 
 #if GDISP_NEED_TEXT || defined(__DOXYGEN__)
@@ -767,7 +1037,7 @@ void gdispDrawBox(coord_t x, coord_t y, coord_t cx, coord_t cy, color_t color);
 	 *
 	 * @api
 	 */
-	coord_t gdispGetCharWidth(char c, font_t font);
+	coord_t gdispGetCharWidth(unicode_t c, font_t font);
 
 	/**
 	 * @brief   Get the pixel width of a string.
@@ -785,6 +1055,10 @@ void gdispDrawBox(coord_t x, coord_t y, coord_t cx, coord_t cy, color_t color);
 	 * @details	The supplied name is matched against the font name. A '*' will replace 0 or more characters.
 	 * @return	Returns a font or NULL if no matching font could be found.
 	 *
+	 * @note	With GDISP_NEED_FONT_REGISTRY names without a '*' are found with a hash lookup
+	 * 			rather than by checking every font. Fonts added with @p gdispAddFont() or
+	 * 			loaded with @p gdispLoadFont() are found too.
+	 *
 	 * @param[in] name		The font name to find.
 	 *
 	 * @note				Wildcard matching will match the shortest possible match.
@@ -802,6 +1076,47 @@ void gdispDrawBox(coord_t x, coord_t y, coord_t cx, coord_t cy, color_t color);
 	 */
 	void gdispCloseFont(font_t font);
 
+	#if GDISP_NEED_FONT_REGISTRY || defined(__DOXYGEN__)
+		/**
+		 * @brief	Add a font to those that @p gdispOpenFont() can find.
+		 * @return	FALSE if there is no room (see GDISP_FONT_REGISTRY_EXTRA)
+		 *
+		 * @param[in] font		The font. It must stay valid while it is registered.
+		 *
+		 * @note	Fonts loaded with @p gdispLoadFont() are added automatically
+		 * 			and removed again when they are unloaded.
+		 *
+		 * @api
+		 */
+		bool_t gdispAddFont(font_t font);
+	#endif
+
+	#if GDISP_NEED_FONT_LOAD || defined(__DOXYGEN__)
+		struct gdispImageIO;
+
+		/**
+		 * @brief	Load a font from a font file.
+		 * @details	Only the font header and its character tables are read into RAM. The glyph
+		 * 			of each character is read from the file when it is drawn and kept in a
+		 * 			small cache (GDISP_FONT_LOAD_CACHE glyphs).
+		 * @return	Returns the font or NULL if the file isn't a valid font or there isn't enough memory.
+		 *
+		 * @param[in] pio		The io to read the font file with. Set it up with one of the
+		 * 						gdispImageIOSetXXXReader() routines.
+		 *
+		 * @note	The font keeps the io (and the file) open until @p gdispCloseFont().
+		 * 			If loading fails the io is closed.
+		 * @note	With GDISP_NEED_FONT_REGISTRY the font can also be found by name with
+		 * 			@p gdispOpenFont(). It is only unloaded when it has been closed once
+		 * 			for the load and once for each open. Opening a loaded font fails once it
+		 * 			is open 65535 times.
+		 * @note	Font files are made with the font2c tool (using the -b option).
+		 *
+		 * @api
+		 */
+		font_t gdispLoadFont(struct gdispImageIO *pio);
+	#endif
+
 	/**
 	 * @brief	Get the name of the specified font.
 	 * @returns	The name of the font.
@@ -841,6 +1156,60 @@ void gdispDrawBox(coord_t x, coord_t y, coord_t cx, coord_t cy, color_t color);
 	void gdispFillRoundedBox(coord_t x, coord_t y, coord_t cx, coord_t cy, coord_t radius, color_t color);
 #endif
 
+/* Shadow Framebuffer Functions */
+
+#if GDISP_NEED_SHADOW || defined(__DOXYGEN__)
+	/**
+	 * @brief   Send everything drawn into the shadow framebuffer since the last flush to the panel.
+	 * @details	Rows that changed over the same columns are sent together with a single blit.
+	 * @note	This does nothing if GDISP_SHADOW_AUTOFLUSH is TRUE as the panel
+	 * 			is then always kept up to date.
+	 *
+	 * @api
+	 */
+	void gdispShadowFlush(void);
+#endif
+
+/**
+ * @name    Unlocked variants of the extra drawing functions
+ * @brief   The same as the functions above but they don't take the GDISP lock.
+ * @details	The locking versions take the lock once for the whole shape rather than
+ * 			once for every line or character.
+ * @pre		These may only be called between @p gdispLock() and @p gdispUnlock().
+ * @{
+ */
+void gdispDrawBox_unsafe(coord_t x, coord_t y, coord_t cx, coord_t cy, color_t color);
+#if GDISP_NEED_CONVEX_POLYGON || defined(__DOXYGEN__)
+	void gdispDrawPoly_unsafe(coord_t tx, coord_t ty, const point *pntarray, unsigned cnt, color_t color);
+	void gdispFillConvexPoly_unsafe(coord_t tx, coord_t ty, const point *pntarray, unsigned cnt, color_t color);
+#endif
+#if GDISP_NEED_GRADIENT || defined(__DOXYGEN__)
+	void gdispFillAreaGradient_unsafe(coord_t x, coord_t y, coord_t cx, coord_t cy, gradient_t direction, color_t c0, color_t c1);
+	void gdispFillAreaGradientPoints_unsafe(coord_t x, coord_t y, coord_t cx, coord_t cy, coord_t x0, coord_t y0, color_t c0, coord_t x1, coord_t y1, color_t c1);
+	void gdispFillRoundedBoxGradient_unsafe(coord_t x, coord_t y, coord_t cx, coord_t cy, coord_t radius, gradient_t direction, color_t c0, color_t c1);
+#endif
+#if GDISP_NEED_PATTERN || defined(__DOXYGEN__)
+	void gdispFillAreaPattern_unsafe(coord_t x, coord_t y, coord_t cx, coord_t cy, const uint8_t *pattern, color_t fg, color_t bg);
+	void gdispFillAreaPatternColor_unsafe(coord_t x, coord_t y, coord_t cx, coord_t cy, const pixel_t *pattern);
+#endif
+#if GDISP_NEED_SCALE || defined(__DOXYGEN__)
+	void gdispBlitAreaScaled_unsafe(coord_t x, coord_t y, coord_t cx, coord_t cy, coord_t srcx, coord_t srcy, coord_t srccx2, coord_t srccy2, coord_t srccx, const pixel_t *buffer, scalemode_t mode);
+#endif
+#if GDISP_NEED_ROTATE || defined(__DOXYGEN__)
+	void gdispBlitAreaRotated_unsafe(coord_t x, coord_t y, coord_t srccx, coord_t srccy, const pixel_t *buffer, coord_t px, coord_t py, coord_t angle);
+#endif
+#if GDISP_NEED_TEXT || defined(__DOXYGEN__)
+	void gdispDrawString_unsafe(coord_t x, coord_t y, const char *str, font_t font, color_t color);
+	void gdispFillString_unsafe(coord_t x, coord_t y, const char *str, font_t font, color_t color, color_t bgcolor);
+	void gdispDrawStringBox_unsafe(coord_t x, coord_t y, coord_t cx, coord_t cy, const char* str, font_t font, color_t color, justify_t justify);
+	void gdispFillStringBox_unsafe(coord_t x, coord_t y, coord_t cx, coord_t cy, const char* str, font_t font, color_t color, color_t bgColor, justify_t justify);
+#endif
+#if GDISP_NEED_ARC || defined(__DOXYGEN__)
+	void gdispDrawRoundedBox_unsafe(coord_t x, coord_t y, coord_t cx, coord_t cy, coord_t radius, color_t color);
+	void gdispFillRoundedBox_unsafe(coord_t x, coord_t y, coord_t cx, coord_t cy, coord_t radius, color_t color);
+#endif
+/** @} */
+
 /* Support routine for packed pixel formats */
 #if !defined(gdispPackPixels) || defined(__DOXYGEN__)
 	/**
@@ -912,17 +1281,21 @@ void gdispDrawBox(coord_t x, coord_t y, coord_t cx, coord_t cy, color_t color);
 
 /**
  * @brief   Get the display width in pixels.
+ * @note    This doesn't take the GDISP lock so it can be called at any time,
+ * 			including between @p gdispLock() and @p gdispUnlock().
  *
  * @api
  */
-#define gdispGetWidth()							(GDISP.Width)
+#define gdispGetWidth()							(((volatile GDISPDriver *)&GDISP)->Width)
 
 /**
  * @brief   Get the display height in pixels.
+ * @note    This doesn't take the GDISP lock so it can be called at any time,
+ * 			including between @p gdispLock() and @p gdispUnlock().
  *
  * @api
  */
-#define gdispGetHeight()						(GDISP.Height)
+#define gdispGetHeight()						(((volatile GDISPDriver *)&GDISP)->Height)
 
 /**
  * @brief   Get the current display power mode.
@@ -933,10 +1306,12 @@ void gdispDrawBox(coord_t x, coord_t y, coord_t cx, coord_t cy, color_t color);
 
 /**
  * @brief   Get the current display orientation.
+ * @note    This doesn't take the GDISP lock so it can be called at any time,
+ * 			including between @p gdispLock() and @p gdispUnlock().
  *
  * @api
  */
-#define gdispGetOrientation()					(GDISP.Orientation)
+#define gdispGetOrientation()					(((volatile GDISPDriver *)&GDISP)->Orientation)
 
 /**
  * @brief   Get the current display backlight brightness.
@@ -952,6 +1327,23 @@ void gdispDrawBox(coord_t x, coord_t y, coord_t cx, coord_t cy, color_t color);
  */
 #define gdispGetContrast()						(GDISP.Contrast)
 
+#if GDISP_NEED_TEXT_CACHE || defined(__DOXYGEN__)
+	/**
+	 * @brief   Get the number of filled characters drawn from the glyph cache.
+	 * @note    The hit rate is hits / (hits + misses).
+	 *
+	 * @api
+	 */
+	#define gdispGetTextCacheHits()				(GDISP.textCacheHits)
+
+	/**
+	 * @brief   Get the number of filled characters that had to be expanded into the glyph cache.
+	 *
+	 * @api
+	 */
+	#define gdispGetTextCacheMisses()			(GDISP.textCacheMisses)
+#endif
+
 /* More interesting macro's */
 
 /**
@@ -970,6 +1362,14 @@ void gdispDrawBox(coord_t x, coord_t y, coord_t cx, coord_t cy, color_t color);
 	#include "gdisp/image.h"
 #endif
 
+#if GDISP_NEED_TILE || defined(__DOXYGEN__)
+	#include "gdisp/tile.h"
+#endif
+
+#if GDISP_NEED_TEXTBOX || defined(__DOXYGEN__)
+	#include "gdisp/textbox.h"
+#endif
+
 #endif /* GFX_USE_GDISP */
 
 #endif /* _GDISP_H */
@@ -134,8 +134,11 @@ extern "C" {
 	 * @param[in] memimage	A pointer to the image in RAM or Flash 
 	 *
 	 * @note	Always returns TRUE for a Memory Reader
+	 * @note	@p gdispImageIOSetMemoryReader() does the same for a bare io structure
+	 * 			(eg for @p gdispLoadFont()).
 	 */
 	bool_t gdispImageSetMemoryReader(gdispImage *img, const void *memimage);
+	bool_t gdispImageIOSetMemoryReader(gdispImageIO *pio, const void *memimage);
 
 	/**
 	 * @brief	Sets the io fields in the image structure to routines
@@ -146,23 +149,27 @@ extern "C" {
 	 * @param[in] img   			The image structure
 	 * @param[in] BaseFileStreamPtr	A pointer to the (open) BaseFileStream object.
 	 * 
+	 * @note	@p gdispImageIOSetBaseFileStreamReader() does the same for a bare io structure.
 	 */
 	bool_t gdispImageSetBaseFileStreamReader(gdispImage *img, void *BaseFileStreamPtr);
+	bool_t gdispImageIOSetBaseFileStreamReader(gdispImageIO *pio, void *BaseFileStreamPtr);
 
-	#if defined(WIN32) || defined(__DOXYGEN__)
+	#if defined(WIN32) || defined(__unix__) || defined(__DOXYGEN__)
 		/**
 		 * @brief	Sets the io fields in the image structure to routines
-		 * 			that support reading from an image stored in Win32 simulators native
+		 * 			that support reading from an image stored in the simulators native
 		 * 			file system.
-		 * @pre		Only available on the Win32 simulator
+		 * @pre		Only available on the Win32 and POSIX simulators
 		 *
 		 * @return	TRUE if the IO open function succeeds
 		 *
 		 * @param[in] img   	The image structure
 		 * @param[in] filename	The filename to open
 		 *
+		 * @note	@p gdispImageIOSetSimulFileReader() does the same for a bare io structure.
 		 */
 		bool_t gdispImageSetSimulFileReader(gdispImage *img, const char *filename);
+		bool_t gdispImageIOSetSimulFileReader(gdispImageIO *pio, const char *filename);
 	#endif
 	
 	/**
@@ -271,6 +278,13 @@ extern "C" {
 		 * @note	The 8 byte header:
 		 *  			{ 'N', 'I', width.hi, width.lo, height.hi, height.lo, format.hi, format.lo }
 		 *  			The format word = GDISP_PIXELFORMAT
+		 * @note	A header starting with { 'N', 'R', ... } is a run length compressed native image
+		 * 			(if GDISP_NEED_IMAGE_NATIVE_RLE is TRUE which is the default). The header is followed
+		 * 			by a table of big endian 32 bit file offsets - one for the start of each row and a final
+		 * 			one for the end of the last row. Each row
+		 * 			is then a series of runs - a byte of 0 to 127 is followed by that many plus one
+		 * 			pixels, a byte of 129 to 255 is followed by one pixel repeated 257 minus the byte times.
+		 * 			Repeated pixels are drawn using fills. tools/bmp2native makes these images.
 		 * @{
 		 */
 		gdispImageError gdispImageOpen_NATIVE(gdispImage *img);
@@ -287,6 +301,14 @@ extern "C" {
 		 * @note	Only use these functions if you absolutely know the format
 		 * 			of the image you are decoding. Generally you should use the
 		 * 			generic functions and it will auto-detect the format.
+		 * @note	Frames are decoded straight to the display. The LZW dictionary (about 17K)
+		 * 			is only allocated while a frame is being decoded. Caching keeps one byte
+		 * 			per pixel of the current frame.
+		 * @note	As there is no frame buffer the "restore to previous" disposal method
+		 * 			is treated as "do not dispose".
+		 * @note	If there is no memory for a frame's local palette gdispImageNext_GIF() still
+		 * 			moves to the frame. Drawing it tries to load the palette again and returns
+		 * 			GDISP_IMAGE_ERR_NOMEMORY (without drawing) if it still can't.
 		 * @{
 		 */
 		gdispImageError gdispImageOpen_GIF(gdispImage *img);
@@ -303,6 +325,10 @@ extern "C" {
 		 * @note	Only use these functions if you absolutely know the format
 		 * 			of the image you are decoding. Generally you should use the
 		 * 			generic functions and it will auto-detect the format.
+		 * @note	Only the rows and columns drawn are read from uncompressed images.
+		 * 			RLE images are decoded from the start unless GDISP_NEED_IMAGE_BMP_RLE_INDEX
+		 * 			is TRUE. That remembers where each row starts (8 bytes per row) when
+		 * 			the image is opened.
 		 * @{
 		 */
 		gdispImageError gdispImageOpen_BMP(gdispImage *img);
@@ -319,6 +345,12 @@ extern "C" {
 		 * @note	Only use these functions if you absolutely know the format
 		 * 			of the image you are decoding. Generally you should use the
 		 * 			generic functions and it will auto-detect the format.
+		 * @note	Only baseline (sequential huffman coded) 8 bit greyscale and YCbCr images
+		 * 			are supported. Progressive images return GDISP_IMAGE_ERR_UNSUPPORTED as
+		 * 			they need the coefficients of the whole image to be kept in RAM.
+		 * @note	A row of MCU's (8 or 16 rows of pixels) is decoded at a time. The RAM
+		 * 			used while decoding is about 3.6K plus up to 5 bytes per pixel of image
+		 * 			width for each row of pixels in the MCU.
 		 * @{
 		 */
 		gdispImageError gdispImageOpen_JPG(gdispImage *img);
@@ -327,6 +359,22 @@ extern "C" {
 		gdispImageError gdispImageDraw_JPG(gdispImage *img, coord_t x, coord_t y, coord_t cx, coord_t cy, coord_t sx, coord_t sy);
 		systime_t gdispImageNext_JPG(gdispImage *img);
 		/* @} */
+
+		/**
+		 * @brief	Scale a JPG image down as it is decoded
+		 * @details	The scaling is done on the DCT coefficients so a scaled image is
+		 * 			decoded much faster (and with less RAM) than the full size image.
+		 * @return	GDISP_IMAGE_ERR_OK (0) on success or an error code.
+		 *
+		 * @param[in] img		The image structure (opened as a JPG image)
+		 * @param[in] scale		1, 2, 4 or 8 to divide the width and height by
+		 *
+		 * @note	The image width and height are updated to the scaled size (rounded up).
+		 * 			Any cached image is thrown away.
+		 *
+		 * @api
+		 */
+		gdispImageError gdispImageSetScale_JPG(gdispImage *img, uint8_t scale);
 	#endif
 
 	#if GDISP_NEED_IMAGE_PNG
@@ -335,6 +383,10 @@ extern "C" {
 		 * @note	Only use these functions if you absolutely know the format
 		 * 			of the image you are decoding. Generally you should use the
 		 * 			generic functions and it will auto-detect the format.
+		 * @note	All color types, bit depths and Adam7 interlacing are supported. Alpha
+		 * 			(and tRNS palette alpha) is either on or off - pixels less than half
+		 * 			opaque are not drawn.
+		 * @note	See GDISP_IMAGE_PNG_WINDOW_SIZE for the RAM used while decoding.
 		 * @{
 		 */
 		gdispImageError gdispImageOpen_PNG(gdispImage *img);
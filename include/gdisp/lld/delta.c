@@ -0,0 +1,340 @@
+/*
+    ChibiOS/GFX - Copyright (C) 2012, 2013
+                 Joel Bodenmann aka Tectu <joel@unormal.org>
+
+    This file is part of ChibiOS/GFX.
+
+    ChibiOS/GFX is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    ChibiOS/GFX is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file	include/gdisp/lld/delta.c
+ * @brief	GDISP frame delta encoding for displays on slow links
+ *
+ * @addtogroup GDISP
+ *
+ * @details	This keeps a shadow copy of the screen in RAM and compares everything
+ *			that is drawn against it. Only the pixels that have actually changed
+ *			are sent to the display. Unchanged pixels are left as they were on
+ *			the panel (a copy-from-previous-frame), changed pixels are sent as
+ *			either a run of a single color or a span of literal pixels.
+ *
+ *			It is intended for remote or serial attached panels where the link
+ *			rather than the drawing is the bottleneck. To use it the driver:
+ *				- Sets GDISP_HARDWARE_CLEARS, GDISP_HARDWARE_FILLS and
+ *				  GDISP_HARDWARE_BITFILLS to TRUE in its gdisp_lld_config.h.
+ *				  GDISP_HARDWARE_PIXELREAD, GDISP_HARDWARE_READAREA,
+ *				  GDISP_HARDWARE_SCROLL and GDISP_HARDWARE_COPYAREA can also be
+ *				  set to TRUE as they are served from the shadow copy.
+ *				- Defines the two span routines below.
+ *				- Includes this file after "gdisp/lld/emulation.c".
+ *				- Does not define gdisp_lld_draw_pixel(), gdisp_lld_clear(),
+ *				  gdisp_lld_fill_area() or gdisp_lld_blit_area_ex() itself.
+ *				- Calls gdisp_lld_delta_invalidate() whenever the panel contents
+ *				  no longer match what was drawn (eg. after an orientation change).
+ *
+ *			The Nokia6610GE8 driver uses it when GDISP_USE_DELTA is TRUE.
+ *
+ *			@code
+ *				void gdisp_lld_delta_fill_span(coord_t x, coord_t y, coord_t cx, color_t color);
+ *				void gdisp_lld_delta_write_span(coord_t x, coord_t y, coord_t cx, const pixel_t *pixels);
+ *			@endcode
+ *			Both are always called with a horizontal span (on a single line) that
+ *			has already been clipped to the screen.
+ *
+ * @note	The shadow copy costs GDISP_SCREEN_WIDTH * GDISP_SCREEN_HEIGHT pixels of RAM.
+ * @note	Until the first gdispClear() everything drawn is sent as nothing is
+ *			known about what the panel is currently displaying.
+ *
+ * @{
+ */
+#ifndef GDISP_DELTA_C
+#define GDISP_DELTA_C
+
+#if GFX_USE_GDISP
+
+#if !GDISP_HARDWARE_CLEARS || !GDISP_HARDWARE_FILLS || !GDISP_HARDWARE_BITFILLS
+	#error "GDISP: Delta encoding requires GDISP_HARDWARE_CLEARS, GDISP_HARDWARE_FILLS and GDISP_HARDWARE_BITFILLS"
+#endif
+
+#if GDISP_PACKED_PIXELS
+	#error "GDISP: Delta encoding does not support packed pixel formats"
+#endif
+
+/**
+ * @brief	The number of unchanged pixels that will split a changed span in two.
+ * @details	Shorter gaps are resent as it is cheaper than the overhead of a new span.
+ */
+#ifndef GDISP_DELTA_MIN_SKIP
+	#define GDISP_DELTA_MIN_SKIP		4
+#endif
+
+/**
+ * @brief	The minimum number of identical pixels that are sent as a run rather than as literal pixels.
+ */
+#ifndef GDISP_DELTA_MIN_RUN
+	#define GDISP_DELTA_MIN_RUN			4
+#endif
+
+/* The routines the driver must supply */
+void gdisp_lld_delta_fill_span(coord_t x, coord_t y, coord_t cx, color_t color);
+void gdisp_lld_delta_write_span(coord_t x, coord_t y, coord_t cx, const pixel_t *pixels);
+
+static pixel_t	deltaShadow[GDISP_SCREEN_WIDTH * GDISP_SCREEN_HEIGHT];
+static bool_t	deltaValid;
+
+#define DELTAPIXEL(x, y)	(&deltaShadow[(y) * GDISP.Width + (x)])
+
+void gdisp_lld_delta_invalidate(void) {
+	deltaValid = FALSE;
+}
+
+/* Send a changed span (already in the shadow) as runs and literals */
+static void delta_send(coord_t x, coord_t y, coord_t cx, const pixel_t *p) {
+	coord_t		n, run;
+
+	while(cx) {
+		/* How long is the run starting with the first pixel */
+		for(n = 1; n < cx && p[n] == p[0]; n++);
+
+		if (n >= GDISP_DELTA_MIN_RUN)
+			gdisp_lld_delta_fill_span(x, y, n, p[0]);
+		else {
+			/* Literal pixels - up until the next run that is worth encoding */
+			for(n = 1, run = 1; n < cx; n++) {
+				if (p[n] != p[n-1])
+					run = 1;
+				else if (++run >= GDISP_DELTA_MIN_RUN) {
+					n -= run - 1;
+					break;
+				}
+			}
+			gdisp_lld_delta_write_span(x, y, n, p);
+		}
+		x += n;
+		p += n;
+		cx -= n;
+	}
+}
+
+/* Compare a line against the shadow and send just what has changed.
+ *	srcstep is 1 for a line of pixels or 0 for a single repeated color.
+ */
+static void delta_encode(coord_t x, coord_t y, coord_t cx, const pixel_t *src, unsigned srcstep) {
+	pixel_t		*sh;
+	coord_t		i, j, end, gap;
+
+	sh = DELTAPIXEL(x, y);
+	i = 0;
+	while(i < cx) {
+		/* Skip over anything that hasn't changed */
+		if (deltaValid) {
+			while(i < cx && sh[i] == src[i*srcstep])
+				i++;
+			if (i >= cx)
+				break;
+		}
+
+		/* Find the end of the changed span, absorbing short unchanged gaps */
+		end = i+1;
+		for(j = i+1, gap = 0; j < cx; j++) {
+			if (!deltaValid || sh[j] != src[j*srcstep]) {
+				end = j+1;
+				gap = 0;
+			} else if (++gap >= GDISP_DELTA_MIN_SKIP)
+				break;
+		}
+
+		/* Update the shadow and send it */
+		for(j = i; j < end; j++)
+			sh[j] = src[j*srcstep];
+		delta_send(x+i, y, end-i, sh+i);
+		i = end;
+	}
+}
+
+void gdisp_lld_draw_pixel(coord_t x, coord_t y, color_t color) {
+	pixel_t		*sh;
+
+	#if GDISP_NEED_VALIDATION || GDISP_NEED_CLIP
+		if (x < GDISP.clipx0 || y < GDISP.clipy0 || x >= GDISP.clipx1 || y >= GDISP.clipy1) return;
+	#endif
+
+	sh = DELTAPIXEL(x, y);
+	if (deltaValid && *sh == color)
+		return;
+	*sh = color;
+	gdisp_lld_delta_write_span(x, y, 1, sh);
+}
+
+void gdisp_lld_fill_area(coord_t x, coord_t y, coord_t cx, coord_t cy, color_t color) {
+	pixel_t		c;
+
+	#if GDISP_NEED_VALIDATION || GDISP_NEED_CLIP
+		if (x < GDISP.clipx0) { cx -= GDISP.clipx0 - x; x = GDISP.clipx0; }
+		if (y < GDISP.clipy0) { cy -= GDISP.clipy0 - y; y = GDISP.clipy0; }
+		if (cx <= 0 || cy <= 0 || x >= GDISP.clipx1 || y >= GDISP.clipy1) return;
+		if (x+cx > GDISP.clipx1)	cx = GDISP.clipx1 - x;
+		if (y+cy > GDISP.clipy1)	cy = GDISP.clipy1 - y;
+	#endif
+
+	c = color;
+	for(; cy; cy--, y++)
+		delta_encode(x, y, cx, &c, 0);
+}
+
+void gdisp_lld_clear(color_t color) {
+	pixel_t		*sh, *esh;
+	coord_t		y;
+
+	/* We know nothing about the panel - just send it all */
+	if (!deltaValid) {
+		for(sh = deltaShadow, esh = deltaShadow + GDISP.Width * GDISP.Height; sh < esh; sh++)
+			*sh = color;
+		for(y = 0; y < GDISP.Height; y++)
+			gdisp_lld_delta_fill_span(0, y, GDISP.Width, color);
+		deltaValid = TRUE;
+		return;
+	}
+
+	gdisp_lld_fill_area(0, 0, GDISP.Width, GDISP.Height, color);
+}
+
+void gdisp_lld_blit_area_ex(coord_t x, coord_t y, coord_t cx, coord_t cy, coord_t srcx, coord_t srcy, coord_t srccx, const pixel_t *buffer) {
+	#if GDISP_NEED_VALIDATION || GDISP_NEED_CLIP
+		if (x < GDISP.clipx0) { cx -= GDISP.clipx0 - x; srcx += GDISP.clipx0 - x; x = GDISP.clipx0; }
+		if (y < GDISP.clipy0) { cy -= GDISP.clipy0 - y; srcy += GDISP.clipy0 - y; y = GDISP.clipy0; }
+		if (srcx+cx > srccx)		cx = srccx - srcx;
+		if (cx <= 0 || cy <= 0 || x >= GDISP.clipx1 || y >= GDISP.clipy1) return;
+		if (x+cx > GDISP.clipx1)	cx = GDISP.clipx1 - x;
+		if (y+cy > GDISP.clipy1)	cy = GDISP.clipy1 - y;
+	#endif
+
+	buffer += srcy * srccx + srcx;
+	for(; cy; cy--, y++, buffer += srccx)
+		delta_encode(x, y, cx, buffer, 1);
+}
+
+#if (GDISP_NEED_PIXELREAD && GDISP_HARDWARE_PIXELREAD) || defined(__DOXYGEN__)
+	color_t gdisp_lld_get_pixel_color(coord_t x, coord_t y) {
+		#if GDISP_NEED_VALIDATION || GDISP_NEED_CLIP
+			if (x < 0 || y < 0 || x >= GDISP.Width || y >= GDISP.Height) return 0;
+		#endif
+		return *DELTAPIXEL(x, y);
+	}
+#endif
+
+#if (GDISP_NEED_PIXELREAD && GDISP_HARDWARE_READAREA) || defined(__DOXYGEN__)
+	void gdisp_lld_read_area(coord_t x, coord_t y, coord_t cx, coord_t cy, pixel_t *buffer) {
+		const pixel_t	*sh;
+		coord_t			stride, i;
+
+		stride = cx;
+		#if GDISP_NEED_VALIDATION || GDISP_NEED_CLIP
+			if (x < 0) { cx += x; buffer -= x; x = 0; }
+			if (y < 0) { cy += y; buffer -= y*stride; y = 0; }
+			if (cx <= 0 || cy <= 0 || x >= GDISP.Width || y >= GDISP.Height) return;
+			if (x+cx > GDISP.Width)		cx = GDISP.Width - x;
+			if (y+cy > GDISP.Height)	cy = GDISP.Height - y;
+		#endif
+
+		for(sh = DELTAPIXEL(x, y); cy; cy--, buffer += stride, sh += GDISP.Width)
+			for(i = 0; i < cx; i++)
+				buffer[i] = sh[i];
+	}
+#endif
+
+#if (GDISP_NEED_SCROLL && GDISP_HARDWARE_SCROLL) || defined(__DOXYGEN__)
+	void gdisp_lld_vertical_scroll(coord_t x, coord_t y, coord_t cx, coord_t cy, int lines, color_t bgcolor) {
+		pixel_t		c;
+		coord_t		i, abslines;
+
+		#if GDISP_NEED_VALIDATION || GDISP_NEED_CLIP
+			if (x < GDISP.clipx0) { cx -= GDISP.clipx0 - x; x = GDISP.clipx0; }
+			if (y < GDISP.clipy0) { cy -= GDISP.clipy0 - y; y = GDISP.clipy0; }
+			if (!lines || cx <= 0 || cy <= 0 || x >= GDISP.clipx1 || y >= GDISP.clipy1) return;
+			if (x+cx > GDISP.clipx1)	cx = GDISP.clipx1 - x;
+			if (y+cy > GDISP.clipy1)	cy = GDISP.clipy1 - y;
+		#endif
+
+		/* The scroll is redrawn from the shadow so only the lines that differ get sent.
+		 *	Rows are processed in the order that means a source row is never overwritten before it is used.
+		 */
+		abslines = lines < 0 ? -lines : lines;
+		if (abslines > cy)
+			abslines = cy;
+		c = bgcolor;
+		if (lines > 0) {
+			for(i = 0; i < cy - abslines; i++)
+				delta_encode(x, y+i, cx, DELTAPIXEL(x, y+i+abslines), 1);
+			for(; i < cy; i++)
+				delta_encode(x, y+i, cx, &c, 0);
+		} else {
+			for(i = cy-1; i >= abslines; i--)
+				delta_encode(x, y+i, cx, DELTAPIXEL(x, y+i-abslines), 1);
+			for(; i >= 0; i--)
+				delta_encode(x, y+i, cx, &c, 0);
+		}
+	}
+#endif
+
+#if (GDISP_NEED_COPYAREA && GDISP_HARDWARE_COPYAREA) || defined(__DOXYGEN__)
+	void gdisp_lld_copy_area(coord_t srcx, coord_t srcy, coord_t cx, coord_t cy, coord_t dstx, coord_t dsty) {
+		coord_t		i, j, n, shift;
+
+		#if GDISP_NEED_VALIDATION || GDISP_NEED_CLIP
+			if (srcx < 0) { cx += srcx; dstx -= srcx; srcx = 0; }
+			if (srcy < 0) { cy += srcy; dsty -= srcy; srcy = 0; }
+			if (srcx+cx > GDISP.Width)	cx = GDISP.Width - srcx;
+			if (srcy+cy > GDISP.Height)	cy = GDISP.Height - srcy;
+			if (dstx < GDISP.clipx0) { cx -= GDISP.clipx0 - dstx; srcx += GDISP.clipx0 - dstx; dstx = GDISP.clipx0; }
+			if (dsty < GDISP.clipy0) { cy -= GDISP.clipy0 - dsty; srcy += GDISP.clipy0 - dsty; dsty = GDISP.clipy0; }
+			if (cx <= 0 || cy <= 0 || dstx >= GDISP.clipx1 || dsty >= GDISP.clipy1) return;
+			if (dstx+cx > GDISP.clipx1)	cx = GDISP.clipx1 - dstx;
+			if (dsty+cy > GDISP.clipy1)	cy = GDISP.clipy1 - dsty;
+		#endif
+		if (srcx == dstx && srcy == dsty) return;
+
+		/* Lines are processed in the order that means a source line is never overwritten before it is used */
+		if (dsty != srcy) {
+			if (dsty < srcy) {
+				for(j = 0; j < cy; j++)
+					delta_encode(dstx, dsty+j, cx, DELTAPIXEL(srcx, srcy+j), 1);
+			} else {
+				for(j = cy-1; j >= 0; j--)
+					delta_encode(dstx, dsty+j, cx, DELTAPIXEL(srcx, srcy+j), 1);
+			}
+			return;
+		}
+
+		/* Moving along the same lines. Moving left is safe as the shadow is updated left to right.
+		 *	Moving right is done in pieces no longer than the move starting from the right hand end.
+		 */
+		for(j = 0; j < cy; j++) {
+			if (dstx < srcx) {
+				delta_encode(dstx, dsty+j, cx, DELTAPIXEL(srcx, srcy+j), 1);
+				continue;
+			}
+			shift = dstx - srcx;
+			for(i = cx; i > 0; i -= n) {
+				n = i > shift ? shift : i;
+				delta_encode(dstx+i-n, dsty+j, n, DELTAPIXEL(srcx+i-n, srcy+j), 1);
+			}
+		}
+	}
+#endif
+
+#endif /* GFX_USE_GDISP */
+#endif /* GDISP_DELTA_C */
+/** @} */
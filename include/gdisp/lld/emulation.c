@@ -39,8 +39,15 @@
 /* Include the low level driver information */
 #include "gdisp/lld/gdisp_lld.h"
 
-/* Declare the GDISP structure */
-GDISPDriver	GDISP;
+/* With a shadow framebuffer the driver becomes the panel behind the shadow */
+#if GDISP_NEED_SHADOW && !defined(GDISP_SHADOW_C)
+	#include "gdisp/lld/shadow.h"
+#endif
+
+/* Declare the GDISP structure (the shadow framebuffer shares the driver's one) */
+#ifndef GDISP_SHADOW_C
+	GDISPDriver	GDISP;
+#endif
 
 #if !GDISP_HARDWARE_CLEARS 
 	void gdisp_lld_clear(color_t color) {
@@ -162,6 +169,143 @@ GDISPDriver	GDISP;
 	}
 #endif
 
+#if !GDISP_HARDWARE_MONOFILLS
+	#if GDISP_NEED_BLITMONO_LUT && GDISP_HARDWARE_BITFILLS && !GDISP_PACKED_PIXELS
+		/* Expansion of a nibble into 4 pixels for the current fg/bg color pair.
+		 *	A full byte table would be 256*8 pixels which is too much RAM for most targets.
+		 */
+		static pixel_t	monoLUT[16][4];
+		static color_t	monoLUTfg, monoLUTbg;
+		static bool_t	monoLUTvalid;
+		static pixel_t	monoBuf[GDISP_LINEBUF_SIZE];
+
+		static void mono_expand(pixel_t *buf, const uint8_t *src, coord_t sx, coord_t cx) {
+			const pixel_t	*lut;
+			unsigned		shift;
+			uint8_t			b;
+
+			src += sx >> 3;
+			shift = sx & 7;
+			for(; cx >= 8; cx -= 8, src++, buf += 8) {
+				b = shift ? (uint8_t)((src[0] << shift) | (src[1] >> (8 - shift))) : src[0];
+				lut = monoLUT[b >> 4];
+				buf[0] = lut[0]; buf[1] = lut[1]; buf[2] = lut[2]; buf[3] = lut[3];
+				lut = monoLUT[b & 0x0F];
+				buf[4] = lut[0]; buf[5] = lut[1]; buf[6] = lut[2]; buf[7] = lut[3];
+			}
+			if (cx) {
+				b = (uint8_t)(src[0] << shift);
+				if (shift + cx > 8)
+					b |= src[1] >> (8 - shift);
+				for(; cx; cx--, b <<= 1)
+					*buf++ = (b & 0x80) ? monoLUTfg : monoLUTbg;
+			}
+		}
+	#endif
+
+	void gdisp_lld_blit_mono(coord_t x, coord_t y, coord_t cx, coord_t cy, const uint8_t *bits, coord_t stride, color_t fg, color_t bg, bool_t transparent) {
+		coord_t		sx, i, j;
+
+		/* Clip here as we would otherwise expand lots of pixels that then get thrown away */
+		sx = 0;
+		#if GDISP_NEED_VALIDATION || GDISP_NEED_CLIP
+			if (x < GDISP.clipx0) { cx -= GDISP.clipx0 - x; sx = GDISP.clipx0 - x; x = GDISP.clipx0; }
+			if (y < GDISP.clipy0) { cy -= GDISP.clipy0 - y; bits += (GDISP.clipy0 - y) * stride; y = GDISP.clipy0; }
+			if (cx <= 0 || cy <= 0 || x >= GDISP.clipx1 || y >= GDISP.clipy1) return;
+			if (x+cx > GDISP.clipx1)	cx = GDISP.clipx1 - x;
+			if (y+cy > GDISP.clipy1)	cy = GDISP.clipy1 - y;
+		#endif
+
+		#if GDISP_NEED_BLITMONO_LUT && GDISP_HARDWARE_BITFILLS && !GDISP_PACKED_PIXELS
+			if (!transparent) {
+				coord_t		lines, n;
+
+				if (!monoLUTvalid || fg != monoLUTfg || bg != monoLUTbg) {
+					for(i = 0; i < 16; i++)
+						for(j = 0; j < 4; j++)
+							monoLUT[i][j] = (i & (0x08 >> j)) ? fg : bg;
+					monoLUTfg = fg;
+					monoLUTbg = bg;
+					monoLUTvalid = TRUE;
+				}
+
+				/* Small bitmaps - expand as many whole lines as fit and blit them together */
+				if (cx <= GDISP_LINEBUF_SIZE) {
+					lines = GDISP_LINEBUF_SIZE / cx;
+					while(cy) {
+						if (lines > cy) lines = cy;
+						for(j = 0; j < lines; j++, bits += stride)
+							mono_expand(monoBuf + j*cx, bits, sx, cx);
+						gdisp_lld_blit_area_ex(x, y, cx, lines, 0, 0, cx, monoBuf);
+						y += lines;
+						cy -= lines;
+					}
+					return;
+				}
+
+				/* Wide bitmaps - a piece of a line at a time */
+				for(; cy; cy--, y++, bits += stride) {
+					for(i = 0; i < cx; i += n) {
+						n = cx - i > GDISP_LINEBUF_SIZE ? GDISP_LINEBUF_SIZE : cx - i;
+						mono_expand(monoBuf, bits, sx+i, n);
+						gdisp_lld_blit_area_ex(x+i, y, n, 1, 0, 0, n, monoBuf);
+					}
+				}
+				return;
+			}
+		#endif
+
+		/* Fill each run of set (and if not transparent, clear) bits */
+		for(; cy; cy--, y++, bits += stride) {
+			for(i = 0; i < cx; i = j) {
+				if (bits[(sx+i) >> 3] & (0x80 >> ((sx+i) & 7))) {
+					for(j = i+1; j < cx && (bits[(sx+j) >> 3] & (0x80 >> ((sx+j) & 7))); j++);
+					gdisp_lld_fill_area(x+i, y, j-i, 1, fg);
+				} else {
+					for(j = i+1; j < cx && !(bits[(sx+j) >> 3] & (0x80 >> ((sx+j) & 7))); j++);
+					if (!transparent)
+						gdisp_lld_fill_area(x+i, y, j-i, 1, bg);
+				}
+			}
+		}
+	}
+#endif
+
+#if !GDISP_HARDWARE_KEYEDFILLS
+	void gdisp_lld_blit_area_keyed(coord_t x, coord_t y, coord_t cx, coord_t cy, coord_t srcx, coord_t srcy, coord_t srccx, const pixel_t *buffer, color_t keycolor) {
+		const pixel_t	*p;
+		coord_t			i, j;
+
+		#if GDISP_NEED_VALIDATION || GDISP_NEED_CLIP
+			if (x < GDISP.clipx0) { cx -= GDISP.clipx0 - x; srcx += GDISP.clipx0 - x; x = GDISP.clipx0; }
+			if (y < GDISP.clipy0) { cy -= GDISP.clipy0 - y; srcy += GDISP.clipy0 - y; y = GDISP.clipy0; }
+			if (srcx+cx > srccx)		cx = srccx - srcx;
+			if (cx <= 0 || cy <= 0 || x >= GDISP.clipx1 || y >= GDISP.clipy1) return;
+			if (x+cx > GDISP.clipx1)	cx = GDISP.clipx1 - x;
+			if (y+cy > GDISP.clipy1)	cy = GDISP.clipy1 - y;
+		#endif
+
+		/* Blit each run of opaque pixels on a line so the driver can still stream them */
+		for(; cy; cy--, y++, srcy++) {
+			p = buffer + srcy*srccx + srcx;
+			for(i = 0; i < cx; i = j) {
+				while(i < cx && p[i] == keycolor)
+					i++;
+				if (i >= cx)
+					break;
+				for(j = i+1; j < cx && p[j] != keycolor; j++)
+					;
+				#if GDISP_HARDWARE_BITFILLS
+					gdisp_lld_blit_area_ex(x+i, y, j-i, 1, srcx+i, srcy, srccx, buffer);
+				#else
+					for(; i < j; i++)
+						gdisp_lld_draw_pixel(x+i, y, p[i]);
+				#endif
+			}
+		}
+	}
+#endif
+
 #if GDISP_NEED_CLIP && !GDISP_HARDWARE_CLIP
 	void gdisp_lld_set_clip(coord_t x, coord_t y, coord_t cx, coord_t cy) {
 		#if GDISP_NEED_VALIDATION
@@ -474,12 +618,261 @@ GDISPDriver	GDISP;
 	}
 #endif
 
-#if GDISP_NEED_TEXT && !GDISP_HARDWARE_TEXT
+#if GDISP_NEED_PIXELREAD && GDISP_HARDWARE_PIXELREAD && !GDISP_HARDWARE_READAREA
+	void gdisp_lld_read_area(coord_t x, coord_t y, coord_t cx, coord_t cy, pixel_t *buffer) {
+		coord_t		stride, i, j;
+
+		stride = cx;
+		#if GDISP_NEED_VALIDATION || GDISP_NEED_CLIP
+			if (x < 0) { cx += x; buffer -= x; x = 0; }
+			if (y < 0) { cy += y; buffer -= y*stride; y = 0; }
+			if (cx <= 0 || cy <= 0 || x >= GDISP.Width || y >= GDISP.Height) return;
+			if (x+cx > GDISP.Width)		cx = GDISP.Width - x;
+			if (y+cy > GDISP.Height)	cy = GDISP.Height - y;
+		#endif
+
+		for(j = 0; j < cy; j++, buffer += stride)
+			for(i = 0; i < cx; i++)
+				buffer[i] = gdisp_lld_get_pixel_color(x+i, y+j);
+	}
+#endif
+
+#if GDISP_NEED_COPYAREA && !GDISP_HARDWARE_COPYAREA && !defined(GDISP_SHADOW_PANEL)
+	void gdisp_lld_copy_area(coord_t srcx, coord_t srcy, coord_t cx, coord_t cy, coord_t dstx, coord_t dsty) {
+		static pixel_t	copyBuf[GDISP_LINEBUF_SIZE];
+		coord_t			i, j, n, lines, row, col;
+
+		#if GDISP_NEED_VALIDATION || GDISP_NEED_CLIP
+			/* The source must be on the screen and the destination within the clipping area */
+			if (srcx < 0) { cx += srcx; dstx -= srcx; srcx = 0; }
+			if (srcy < 0) { cy += srcy; dsty -= srcy; srcy = 0; }
+			if (srcx+cx > GDISP.Width)	cx = GDISP.Width - srcx;
+			if (srcy+cy > GDISP.Height)	cy = GDISP.Height - srcy;
+			if (dstx < GDISP.clipx0) { cx -= GDISP.clipx0 - dstx; srcx += GDISP.clipx0 - dstx; dstx = GDISP.clipx0; }
+			if (dsty < GDISP.clipy0) { cy -= GDISP.clipy0 - dsty; srcy += GDISP.clipy0 - dsty; dsty = GDISP.clipy0; }
+			if (cx <= 0 || cy <= 0 || dstx >= GDISP.clipx1 || dsty >= GDISP.clipy1) return;
+			if (dstx+cx > GDISP.clipx1)	cx = GDISP.clipx1 - dstx;
+			if (dsty+cy > GDISP.clipy1)	cy = GDISP.clipy1 - dsty;
+		#endif
+		if (srcx == dstx && srcy == dsty) return;
+
+		/* Whole lines that fit in the buffer are read and written a block at a time.
+		 *	Blocks are processed in the order that means a source line is never overwritten before it is read.
+		 */
+		if (cx <= GDISP_LINEBUF_SIZE) {
+			lines = GDISP_LINEBUF_SIZE / cx;
+			for(j = 0; j < cy; j += n) {
+				n = cy - j > lines ? lines : cy - j;
+				row = dsty > srcy ? cy - j - n : j;
+				gdisp_lld_read_area(srcx, srcy+row, cx, n, copyBuf);
+				gdisp_lld_blit_area_ex(dstx, dsty+row, cx, n, 0, 0, cx, copyBuf);
+			}
+			return;
+		}
+
+		/* Otherwise each line is copied in pieces. When moving right along the same
+		 *	line the pieces are copied starting from the right hand end.
+		 */
+		for(j = 0; j < cy; j++) {
+			row = dsty > srcy ? cy - 1 - j : j;
+			for(i = 0; i < cx; i += n) {
+				n = cx - i > GDISP_LINEBUF_SIZE ? GDISP_LINEBUF_SIZE : cx - i;
+				col = dsty == srcy && dstx > srcx ? cx - i - n : i;
+				gdisp_lld_read_area(srcx + col, srcy + row, n, 1, copyBuf);
+				gdisp_lld_blit_area_ex(dstx + col, dsty + row, n, 1, 0, 0, n, copyBuf);
+			}
+		}
+	}
+#endif
+
+#if GDISP_NEED_TEXT && (!GDISP_HARDWARE_TEXT || !GDISP_HARDWARE_TEXTFILLS)
 	#include "gdisp/fonts.h"
+
+	/* Draw a row based glyph a run at a time.
+	 *	With a color ramp the background is known so every run is filled with the color for its level.
+	 *	Without one only the foreground is drawn. Anti-aliased edges are blended with what is already
+	 *	on the display if it can be read back, otherwise they are drawn if they are more than half covered.
+	 */
+	static void draw_char_rows(coord_t x, coord_t y, unicode_t c, font_t font, color_t color, const color_t *ramp) {
+		fontdecoder_t	d;
+		coord_t			width, height, xscale, yscale;
+		coord_t			i, j, n;
+		uint8_t			level, max;
+		#if GDISP_NEED_PIXELREAD && GDISP_HARDWARE_PIXELREAD
+			coord_t		xs, ys;
+		#endif
+
+		xscale = font->xscale;
+		yscale = font->yscale;
+		width = _getCharWidth(font, c) * xscale;
+		height = font->height * yscale;
+		max = (1 << (font->bpp ? font->bpp : 1)) - 1;
+
+		fontDecodeStart(&d, font, c);
+		for(j = 0; j < height; j += yscale) {
+			for(i = 0; i < width; i += n) {
+				n = fontDecodeRun(&d, &level) * xscale;
+				if (ramp)
+					gdisp_lld_fill_area(x+i, y+j, n, yscale, ramp[level]);
+				else if (level == max)
+					gdisp_lld_fill_area(x+i, y+j, n, yscale, color);
+				else if (level) {
+					#if GDISP_NEED_PIXELREAD && GDISP_HARDWARE_PIXELREAD
+						for(ys = y+j; ys < y+j+yscale; ys++) {
+							for(xs = x+i; xs < x+i+n; xs++) {
+								#if GDISP_NEED_VALIDATION || GDISP_NEED_CLIP
+									if (xs < GDISP.clipx0 || xs >= GDISP.clipx1 || ys < GDISP.clipy0 || ys >= GDISP.clipy1)
+										continue;
+								#endif
+								gdisp_lld_draw_pixel(xs, ys, fontBlendColor(color, gdisp_lld_get_pixel_color(xs, ys), level, font->bpp));
+							}
+						}
+					#else
+						if (level > max/2)
+							gdisp_lld_fill_area(x+i, y+j, n, yscale, color);
+					#endif
+				}
+			}
+		}
+	}
+
+	#if !GDISP_HARDWARE_TEXT
+		/* Draw an unscaled column based glyph as strips of 8 columns turned into rows of bits.
+		 *	Each strip is then a single mono blit rather than a pixel at a time.
+		 */
+		static void draw_char_columns(coord_t x, coord_t y, unicode_t c, font_t font, color_t color, color_t bgcolor, bool_t transparent) {
+			const fontcolumn_t	*ptr;
+			fontcolumn_t		column;
+			uint8_t				strip[sizeof(fontcolumn_t)*8];
+			coord_t				width, height;
+			coord_t				i, j, k, n;
+
+			width = _getCharWidth(font, c);
+			height = font->height;
+			if (height > (coord_t)sizeof(strip))
+				height = sizeof(strip);
+			ptr = _getCharData(font, c);
+
+			for(i = 0; i < width; i += n, ptr += n) {
+				n = width - i > 8 ? 8 : width - i;
+				for(j = 0; j < height; j++)
+					strip[j] = 0;
+
+				/* The font data is LSBit first, down the column */
+				for(k = 0; k < n; k++) {
+					for(column = ptr[k], j = 0; j < height; j++, column >>= 1) {
+						if (column & 0x01)
+							strip[j] |= 0x80 >> k;
+					}
+				}
+				gdisp_lld_blit_mono(x+i, y, n, height, strip, 1, color, bgcolor, transparent);
+			}
+		}
+	#endif
+#endif
+
+#if GDISP_NEED_TEXT && !GDISP_HARDWARE_TEXTFILLS
+	/* Filled characters can be served from a cache of already expanded glyphs */
+	#if GDISP_NEED_TEXT_CACHE && GDISP_HARDWARE_BITFILLS && !defined(GDISP_SHADOW_PANEL)
+		#define GDISP_GLYPH_CACHE		TRUE
+	#else
+		#define GDISP_GLYPH_CACHE		FALSE
+	#endif
+
+	/* The colors for each level of a row based font over the background */
+	static fontramp_t	textRamp;
+
+	#if GDISP_HARDWARE_BITFILLS
+		/* Decode the next row of a row based glyph into line "row" of a bitmap "width" pixels wide */
+		static void fill_char_row(pixel_t *buf, coord_t width, coord_t row, fontdecoder_t *d, coord_t xscale, const color_t *ramp) {
+			coord_t		i, n;
+			uint8_t		level;
+
+			for(i = 0; i < width; ) {
+				for(n = fontDecodeRun(d, &level) * xscale; n; n--, i++)
+					gdispPackPixels(buf, width, i, row, ramp[level]);
+			}
+		}
+	#endif
+
+	#if GDISP_HARDWARE_BITFILLS && (GDISP_GLYPH_CACHE || !(GDISP_HARDWARE_TEXT || GDISP_SOFTWARE_TEXTFILLDRAW || GDISP_SOFTWARE_TEXTBLITCOLUMN))
+		/* Expand a character into a bitmap width pixels wide */
+		static void fill_char_expand(pixel_t *buf, unicode_t c, font_t font, color_t color, color_t bgcolor, coord_t width) {
+			fontExpandChar(buf, width, 0, c, font, 0, width, fontGetRamp(&textRamp, font->bpp, color, bgcolor));
+		}
+	#endif
+
+	#if GDISP_GLYPH_CACHE
+		#if GDISP_TEXT_CACHE_ENTRIES > 255
+			#error "GDISP: GDISP_TEXT_CACHE_ENTRIES must be no more than 255"
+		#endif
+
+		/* A cached glyph */
+		typedef struct glyphcache {
+			font_t		font;
+			color_t		color;
+			color_t		bgcolor;
+			unicode_t	c;
+			pixel_t		buf[GDISP_TEXT_CACHE_GLYPHSIZE];
+		} glyphcache;
+
+		static glyphcache	glyphCache[GDISP_TEXT_CACHE_ENTRIES];
+		static uint8_t		glyphOrder[GDISP_TEXT_CACHE_ENTRIES];		/* Cache entries - most recently used first */
+		static unsigned		glyphUsed;									/* The number of cache entries in use */
+		#if GDISP_NEED_FONT_LOAD
+			static unsigned	glyphUnloads;								/* fontUnloadCount when the cache was last used */
+		#endif
+
+		/* Find a glyph in the cache, expanding it into the least recently used entry if it isn't there */
+		static const pixel_t *glyph_cache_get(unicode_t c, font_t font, color_t color, color_t bgcolor, coord_t width) {
+			glyphcache	*pg;
+			unsigned	i;
+			uint8_t		e;
+
+			#if GDISP_NEED_FONT_LOAD
+				/* A loaded font has been closed - another font could now have its address */
+				if (glyphUnloads != fontUnloadCount) {
+					glyphUnloads = fontUnloadCount;
+					glyphUsed = 0;
+				}
+			#endif
+
+			for(i = 0; i < glyphUsed; i++) {
+				pg = &glyphCache[glyphOrder[i]];
+				if (pg->c == c && pg->font == font && pg->color == color && pg->bgcolor == bgcolor)
+					break;
+			}
+
+			if (i < glyphUsed) {
+				GDISP.textCacheHits++;
+				e = glyphOrder[i];
+			} else {
+				GDISP.textCacheMisses++;
+				if (glyphUsed < GDISP_TEXT_CACHE_ENTRIES) {
+					i = glyphUsed++;
+					glyphOrder[i] = (uint8_t)i;
+				} else
+					i = GDISP_TEXT_CACHE_ENTRIES-1;
+				e = glyphOrder[i];
+				pg = &glyphCache[e];
+				pg->c = c;
+				pg->font = font;
+				pg->color = color;
+				pg->bgcolor = bgcolor;
+				fill_char_expand(pg->buf, c, font, color, bgcolor, width);
+			}
+
+			/* Move it to the front */
+			for(; i; i--)
+				glyphOrder[i] = glyphOrder[i-1];
+			glyphOrder[0] = e;
+			return glyphCache[e].buf;
+		}
+	#endif
 #endif
 
 #if GDISP_NEED_TEXT && !GDISP_HARDWARE_TEXT
-	void gdisp_lld_draw_char(coord_t x, coord_t y, char c, font_t font, color_t color) {
+	void gdisp_lld_draw_char(coord_t x, coord_t y, unicode_t c, font_t font, color_t color) {
 		const fontcolumn_t	*ptr;
 		fontcolumn_t		column;
 		coord_t				width, height, xscale, yscale;
@@ -494,6 +887,18 @@ GDISPDriver	GDISP;
 		height = font->height * yscale;
 		width *= xscale;
 
+		/* Row based fonts - each run of foreground pixels is a single fill */
+		if (_getFontFormat(font) != FONT_FORMAT_COLUMNS) {
+			draw_char_rows(x, y, c, font, color, 0);
+			return;
+		}
+
+		/* Unscaled column based fonts are drawn as strips of mono bitmap */
+		if (xscale == 1 && yscale == 1) {
+			draw_char_columns(x, y, c, font, color, color, TRUE);
+			return;
+		}
+
 		ptr = _getCharData(font, c);
 
 		/* Loop through the data and display. The font data is LSBit first, down the column */
@@ -514,7 +919,7 @@ GDISPDriver	GDISP;
 #endif
 
 #if GDISP_NEED_TEXT && !GDISP_HARDWARE_TEXTFILLS
-	void gdisp_lld_fill_char(coord_t x, coord_t y, char c, font_t font, color_t color, color_t bgcolor) {
+	void gdisp_lld_fill_char(coord_t x, coord_t y, unicode_t c, font_t font, color_t color, color_t bgcolor) {
 		coord_t			width, height;
 		coord_t			xscale, yscale;
 		
@@ -527,6 +932,48 @@ GDISPDriver	GDISP;
 		height = font->height * yscale;
 		width *= xscale;
 
+		/* Blit an already expanded copy of the character if it fits in the cache */
+		#if GDISP_GLYPH_CACHE
+			if ((unsigned)(width * height) <= GDISP_TEXT_CACHE_GLYPHSIZE) {
+				gdisp_lld_blit_area_ex(x, y, width, height, 0, 0, width, glyph_cache_get(c, font, color, bgcolor, width));
+				return;
+			}
+		#endif
+
+		/* Row based fonts are decoded a band of lines at a time straight into a bitmap and blitted */
+		if (_getFontFormat(font) != FONT_FORMAT_COLUMNS) {
+			const color_t	*ramp;
+
+			ramp = fontGetRamp(&textRamp, font->bpp, color, bgcolor);
+
+			#if GDISP_HARDWARE_BITFILLS
+				static pixel_t	rowBuf[GDISP_LINEBUF_SIZE];
+				fontdecoder_t	d, rowstart;
+				coord_t			j, k, n, lines;
+
+				lines = GDISP_LINEBUF_SIZE / width;
+				if (lines) {
+					fontDecodeStart(&d, font, c);
+					for(j = 0; j < height; j += n) {
+						n = height - j > lines ? lines : height - j;
+						for(k = 0; k < n; k++) {
+							if ((j + k) % yscale)
+								d = rowstart;
+							else
+								rowstart = d;
+							fill_char_row(rowBuf, width, k, &d, xscale, ramp);
+						}
+						gdisp_lld_blit_area_ex(x, y+j, width, n, 0, 0, width, rowBuf);
+					}
+					return;
+				}
+			#endif
+
+			/* Otherwise fill each run with its color */
+			draw_char_rows(x, y, c, font, color, ramp);
+			return;
+		}
+
 		/* Method 1: Use background fill and then draw the text */
 		#if GDISP_HARDWARE_TEXT || GDISP_SOFTWARE_TEXTFILLDRAW
 			
@@ -580,10 +1027,6 @@ GDISPDriver	GDISP;
 		/* Method 3: Create a character bitmap and then blit it */
 		#elif GDISP_HARDWARE_BITFILLS
 		{
-			const fontcolumn_t	*ptr;
-			fontcolumn_t		column;
-			coord_t				i, j, xs, ys;
-			
 			/* Working buffer for fast non-transparent text rendering [patch by Badger]
 				This needs to be larger than the largest character we can print.
 				Assume the max is double sized.
@@ -595,26 +1038,7 @@ GDISPDriver	GDISP;
 				if ((unsigned)(width * height) > sizeof(buf)/sizeof(buf[0]))	return;
 			#endif
 
-			ptr = _getCharData(font, c);
-
-			/* Loop through the data and display. The font data is LSBit first, down the column */
-			for(i = 0; i < width; i+=xscale) {
-				/* Get the font bitmap data for the column */
-				column = *ptr++;
-				
-				/* Draw each pixel */
-				for(j = 0; j < height; j+=yscale, column >>= 1) {
-					if (column & 0x01) {
-						for(xs=0; xs < xscale; xs++)
-							for(ys=0; ys < yscale; ys++)
-								gdispPackPixels(buf, width, i+xs, j+ys, color);
-					} else {
-						for(xs=0; xs < xscale; xs++)
-							for(ys=0; ys < yscale; ys++)
-								gdispPackPixels(buf, width, i+xs, j+ys, bgcolor);
-					}
-				}
-			}
+			fill_char_expand(buf, c, font, color, bgcolor, width);
 
 			/* [Patch by Badger] Write all in one stroke */
 			gdisp_lld_blit_area_ex(x, y, width, height, 0, 0, width, buf);
@@ -627,6 +1051,12 @@ GDISPDriver	GDISP;
 			fontcolumn_t		column;
 			coord_t				i, j, xs, ys;
 
+			/* Unscaled characters can be filled a run at a time */
+			if (xscale == 1 && yscale == 1) {
+				draw_char_columns(x, y, c, font, color, bgcolor, FALSE);
+				return;
+			}
+
 			ptr = _getCharData(font, c);
 
 			/* Loop through the data and display. The font data is LSBit first, down the column */
@@ -668,7 +1098,7 @@ void *gdisp_lld_query(unsigned what) {
 }
 #endif
 
-#if GDISP_NEED_MSGAPI
+#if GDISP_NEED_MSGAPI && !defined(GDISP_SHADOW_PANEL)
 	void gdisp_lld_msg_dispatch(gdisp_lld_msg_t *msg) {
 		switch(msg->action) {
 		case GDISP_LLD_MSG_NOP:
@@ -688,6 +1118,12 @@ void *gdisp_lld_query(unsigned what) {
 		case GDISP_LLD_MSG_BLITAREA:
 			gdisp_lld_blit_area_ex(msg->blitarea.x, msg->blitarea.y, msg->blitarea.cx, msg->blitarea.cy, msg->blitarea.srcx, msg->blitarea.srcy, msg->blitarea.srccx, msg->blitarea.buffer);
 			break;
+		case GDISP_LLD_MSG_BLITMONO:
+			gdisp_lld_blit_mono(msg->blitmono.x, msg->blitmono.y, msg->blitmono.cx, msg->blitmono.cy, msg->blitmono.bits, msg->blitmono.stride, msg->blitmono.fg, msg->blitmono.bg, msg->blitmono.transparent);
+			break;
+		case GDISP_LLD_MSG_BLITAREAKEYED:
+			gdisp_lld_blit_area_keyed(msg->blitareakeyed.x, msg->blitareakeyed.y, msg->blitareakeyed.cx, msg->blitareakeyed.cy, msg->blitareakeyed.srcx, msg->blitareakeyed.srcy, msg->blitareakeyed.srccx, msg->blitareakeyed.buffer, msg->blitareakeyed.keycolor);
+			break;
 		case GDISP_LLD_MSG_DRAWLINE:
 			gdisp_lld_draw_line(msg->drawline.x0, msg->drawline.y0, msg->drawline.x1, msg->drawline.y1, msg->drawline.color);
 			break;
@@ -738,6 +1174,11 @@ void *gdisp_lld_query(unsigned what) {
 				gdisp_lld_vertical_scroll(msg->verticalscroll.x, msg->verticalscroll.y, msg->verticalscroll.cx, msg->verticalscroll.cy, msg->verticalscroll.lines, msg->verticalscroll.bgcolor);
 				break;
 		#endif
+		#if GDISP_NEED_COPYAREA
+			case GDISP_LLD_MSG_COPYAREA:
+				gdisp_lld_copy_area(msg->copyarea.srcx, msg->copyarea.srcy, msg->copyarea.cx, msg->copyarea.cy, msg->copyarea.dstx, msg->copyarea.dsty);
+				break;
+		#endif
 		#if GDISP_NEED_CONTROL
 			case GDISP_LLD_MSG_CONTROL:
 				gdisp_lld_control(msg->control.what, msg->control.value);
@@ -71,6 +71,22 @@
 		#define GDISP_HARDWARE_BITFILLS			FALSE
 	#endif
 
+	/**
+	 * @brief   Hardware accelerated fills from a monochrome bitmap.
+	 * @details If set to @p FALSE software emulation is used.
+	 */
+	#ifndef GDISP_HARDWARE_MONOFILLS
+		#define GDISP_HARDWARE_MONOFILLS		FALSE
+	#endif
+
+	/**
+	 * @brief   Hardware accelerated fills from an image with a transparent (key) color.
+	 * @details If set to @p FALSE software emulation is used.
+	 */
+	#ifndef GDISP_HARDWARE_KEYEDFILLS
+		#define GDISP_HARDWARE_KEYEDFILLS		FALSE
+	#endif
+
 	/**
 	 * @brief   Hardware accelerated circles.
 	 * @details If set to @p FALSE software emulation is used.
@@ -151,6 +167,22 @@
 		#define GDISP_HARDWARE_PIXELREAD		FALSE
 	#endif
 
+	/**
+	 * @brief   Reading back an area of pixels in a single operation.
+	 * @details If set to @p FALSE software emulation using pixel read-back is used.
+	 */
+	#ifndef GDISP_HARDWARE_READAREA
+		#define GDISP_HARDWARE_READAREA			FALSE
+	#endif
+
+	/**
+	 * @brief   Hardware accelerated copying of an area of the screen.
+	 * @details If set to @p FALSE software emulation using pixel read-back is used.
+	 */
+	#ifndef GDISP_HARDWARE_COPYAREA
+		#define GDISP_HARDWARE_COPYAREA			FALSE
+	#endif
+
 	/**
 	 * @brief   The driver supports one or more control commands.
 	 * @details If set to @p FALSE there is no support for control commands.
@@ -273,6 +305,8 @@ extern "C" {
 	extern void gdisp_lld_draw_pixel(coord_t x, coord_t y, color_t color);
 	extern void gdisp_lld_fill_area(coord_t x, coord_t y, coord_t cx, coord_t cy, color_t color);
 	extern void gdisp_lld_blit_area_ex(coord_t x, coord_t y, coord_t cx, coord_t cy, coord_t srcx, coord_t srcy, coord_t srccx, const pixel_t *buffer);
+	extern void gdisp_lld_blit_mono(coord_t x, coord_t y, coord_t cx, coord_t cy, const uint8_t *bits, coord_t stride, color_t fg, color_t bg, bool_t transparent);
+	extern void gdisp_lld_blit_area_keyed(coord_t x, coord_t y, coord_t cx, coord_t cy, coord_t srcx, coord_t srcy, coord_t srccx, const pixel_t *buffer, color_t keycolor);
 	extern void gdisp_lld_draw_line(coord_t x0, coord_t y0, coord_t x1, coord_t y1, color_t color);
 
 	/* Circular Drawing Functions */
@@ -294,13 +328,14 @@ extern "C" {
 
 	/* Text Rendering Functions */
 	#if GDISP_NEED_TEXT
-	extern void gdisp_lld_draw_char(coord_t x, coord_t y, char c, font_t font, color_t color);
-	extern void gdisp_lld_fill_char(coord_t x, coord_t y, char c, font_t font, color_t color, color_t bgcolor);
+	extern void gdisp_lld_draw_char(coord_t x, coord_t y, unicode_t c, font_t font, color_t color);
+	extern void gdisp_lld_fill_char(coord_t x, coord_t y, unicode_t c, font_t font, color_t color, color_t bgcolor);
 	#endif
 
 	/* Pixel readback */
 	#if GDISP_NEED_PIXELREAD
 	extern color_t gdisp_lld_get_pixel_color(coord_t x, coord_t y);
+	extern void gdisp_lld_read_area(coord_t x, coord_t y, coord_t cx, coord_t cy, pixel_t *buffer);
 	#endif
 
 	/* Scrolling Function - clears the area scrolled out */
@@ -308,6 +343,11 @@ extern "C" {
 	extern void gdisp_lld_vertical_scroll(coord_t x, coord_t y, coord_t cx, coord_t cy, int lines, color_t bgcolor);
 	#endif
 
+	/* Copy an area of the screen */
+	#if GDISP_NEED_COPYAREA
+	extern void gdisp_lld_copy_area(coord_t srcx, coord_t srcy, coord_t cx, coord_t cy, coord_t dstx, coord_t dsty);
+	#endif
+
 	/* Set driver specific control */
 	#if GDISP_NEED_CONTROL
 	extern void gdisp_lld_control(unsigned what, void *value);
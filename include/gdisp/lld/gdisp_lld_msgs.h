@@ -39,6 +39,8 @@ typedef enum gdisp_msgaction {
 	GDISP_LLD_MSG_DRAWPIXEL,
 	GDISP_LLD_MSG_FILLAREA,
 	GDISP_LLD_MSG_BLITAREA,
+	GDISP_LLD_MSG_BLITMONO,
+	GDISP_LLD_MSG_BLITAREAKEYED,
 	GDISP_LLD_MSG_DRAWLINE,
 	#if GDISP_NEED_CLIP
 		GDISP_LLD_MSG_SETCLIP,
@@ -65,6 +67,9 @@ typedef enum gdisp_msgaction {
 	#if GDISP_NEED_SCROLL
 		GDISP_LLD_MSG_VERTICALSCROLL,
 	#endif
+	#if GDISP_NEED_COPYAREA
+		GDISP_LLD_MSG_COPYAREA,
+	#endif
 	#if GDISP_NEED_CONTROL
 		GDISP_LLD_MSG_CONTROL,
 	#endif
@@ -99,6 +104,24 @@ typedef union gdisp_lld_msg {
 		coord_t				srccx;
 		const pixel_t		*buffer;
 	} blitarea;
+	struct gdisp_lld_msg_blitmono {
+		gdisp_msgaction_t	action;			// GDISP_LLD_MSG_BLITMONO
+		coord_t				x, y;
+		coord_t				cx, cy;
+		const uint8_t		*bits;
+		coord_t				stride;
+		color_t				fg, bg;
+		bool_t				transparent;
+	} blitmono;
+	struct gdisp_lld_msg_blitareakeyed {
+		gdisp_msgaction_t	action;			// GDISP_LLD_MSG_BLITAREAKEYED
+		coord_t				x, y;
+		coord_t				cx, cy;
+		coord_t				srcx, srcy;
+		coord_t				srccx;
+		const pixel_t		*buffer;
+		color_t				keycolor;
+	} blitareakeyed;
 	struct gdisp_lld_msg_setclip {
 		gdisp_msgaction_t	action;			// GDISP_LLD_MSG_SETCLIP
 		coord_t				x, y;
@@ -151,14 +174,14 @@ typedef union gdisp_lld_msg {
 	struct gdisp_lld_msg_drawchar {
 		gdisp_msgaction_t	action;			// GDISP_LLD_MSG_DRAWCHAR
 		coord_t				x, y;
-		char				c;
+		unicode_t			c;
 		font_t				font;
 		color_t				color;
 	} drawchar;
 	struct gdisp_lld_msg_fillchar {
 		gdisp_msgaction_t	action;			// GDISP_LLD_MSG_FILLCHAR
 		coord_t				x, y;
-		char				c;
+		unicode_t			c;
 		font_t				font;
 		color_t				color;
 		color_t				bgcolor;
@@ -175,6 +198,12 @@ typedef union gdisp_lld_msg {
 		int					lines;
 		color_t				bgcolor;
 	} verticalscroll;
+	struct gdisp_lld_msg_copyarea {
+		gdisp_msgaction_t	action;			// GDISP_LLD_MSG_COPYAREA
+		coord_t				srcx, srcy;
+		coord_t				cx, cy;
+		coord_t				dstx, dsty;
+	} copyarea;
 	struct gdisp_lld_msg_control {
 		gdisp_msgaction_t	action;			// GDISP_LLD_MSG_CONTROL
 		int					what;
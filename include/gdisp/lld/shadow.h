@@ -0,0 +1,73 @@
+/*
+    ChibiOS/GFX - Copyright (C) 2012, 2013
+                 Joel Bodenmann aka Tectu <joel@unormal.org>
+
+    This file is part of ChibiOS/GFX.
+
+    ChibiOS/GFX is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    ChibiOS/GFX is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file	include/gdisp/lld/shadow.h
+ * @brief	GDISP shadow framebuffer - turn the low level driver into the panel behind the shadow.
+ *
+ * @addtogroup GDISP
+ *
+ * @details	When GDISP_NEED_SHADOW is TRUE this file is included by the emulation layer
+ *			while compiling the low level driver. It renames every low level driver entry
+ *			point to gdisp_lld_panel_xxx() so that the shadow framebuffer (src/gdisp/shadow.c)
+ *			can provide the real gdisp_lld_xxx() routines and call the driver itself.
+ *			Nothing needs to change in the driver.
+ *
+ * @{
+ */
+#ifndef _GDISP_LLD_SHADOW_H
+#define _GDISP_LLD_SHADOW_H
+
+#if GFX_USE_GDISP && GDISP_NEED_SHADOW
+
+#define GDISP_SHADOW_PANEL
+
+#define gdisp_lld_init				gdisp_lld_panel_init
+#define gdisp_lld_clear				gdisp_lld_panel_clear
+#define gdisp_lld_draw_pixel		gdisp_lld_panel_draw_pixel
+#define gdisp_lld_fill_area			gdisp_lld_panel_fill_area
+#define gdisp_lld_blit_area_ex		gdisp_lld_panel_blit_area_ex
+#define gdisp_lld_blit_mono			gdisp_lld_panel_blit_mono
+#define gdisp_lld_blit_area_keyed	gdisp_lld_panel_blit_area_keyed
+#define gdisp_lld_draw_line			gdisp_lld_panel_draw_line
+#define gdisp_lld_set_clip			gdisp_lld_panel_set_clip
+#define gdisp_lld_draw_circle		gdisp_lld_panel_draw_circle
+#define gdisp_lld_fill_circle		gdisp_lld_panel_fill_circle
+#define gdisp_lld_draw_ellipse		gdisp_lld_panel_draw_ellipse
+#define gdisp_lld_fill_ellipse		gdisp_lld_panel_fill_ellipse
+#define gdisp_lld_draw_arc			gdisp_lld_panel_draw_arc
+#define gdisp_lld_fill_arc			gdisp_lld_panel_fill_arc
+#define gdisp_lld_draw_char			gdisp_lld_panel_draw_char
+#define gdisp_lld_fill_char			gdisp_lld_panel_fill_char
+#define gdisp_lld_get_pixel_color	gdisp_lld_panel_get_pixel_color
+#define gdisp_lld_read_area			gdisp_lld_panel_read_area
+#define gdisp_lld_vertical_scroll	gdisp_lld_panel_vertical_scroll
+#define gdisp_lld_copy_area			gdisp_lld_panel_copy_area
+#define gdisp_lld_control			gdisp_lld_panel_control
+#define gdisp_lld_query				gdisp_lld_panel_query
+#define gdisp_lld_msg_dispatch		gdisp_lld_panel_msg_dispatch
+
+/* Declare the renamed routines */
+#undef _GDISP_LLD_H
+#include "gdisp/lld/gdisp_lld.h"
+
+#endif	/* GFX_USE_GDISP && GDISP_NEED_SHADOW */
+#endif	/* _GDISP_LLD_SHADOW_H */
+/** @} */
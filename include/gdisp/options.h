@@ -93,12 +93,51 @@
 	#ifndef GDISP_NEED_CONVEX_POLYGON
 		#define GDISP_NEED_CONVEX_POLYGON		FALSE
 	#endif
+	/**
+	 * @brief   Are gradient fill functions needed.
+	 * @details	Defaults to FALSE
+	 */
+	#ifndef GDISP_NEED_GRADIENT
+		#define GDISP_NEED_GRADIENT		FALSE
+	#endif
+	/**
+	 * @brief   Are pattern fill functions needed.
+	 * @details	Defaults to FALSE
+	 */
+	#ifndef GDISP_NEED_PATTERN
+		#define GDISP_NEED_PATTERN		FALSE
+	#endif
+	/**
+	 * @brief   Are scaled bitmap blits needed.
+	 * @details	Defaults to FALSE
+	 */
+	#ifndef GDISP_NEED_SCALE
+		#define GDISP_NEED_SCALE		FALSE
+	#endif
+	/**
+	 * @brief   Are rotated bitmap blits needed.
+	 * @details	Defaults to FALSE
+	 */
+	#ifndef GDISP_NEED_ROTATE
+		#define GDISP_NEED_ROTATE		FALSE
+	#endif
+	/**
+	 * @brief   Should opaque monochrome blits be expanded using a lookup table.
+	 * @details	Defaults to FALSE
+	 * @note	If TRUE each line of a gdispBlitMono() is expanded through a 16 entry table
+	 * 			for the current color pair and blitted. This costs 64 + GDISP_LINEBUF_SIZE
+	 * 			pixels of RAM. If FALSE each run of pixels is filled instead.
+	 * @note	Only used if the driver supports bitmap blits but not monochrome fills.
+	 */
+	#ifndef GDISP_NEED_BLITMONO_LUT
+		#define GDISP_NEED_BLITMONO_LUT	FALSE
+	#endif
 	/**
 	 * @brief   Are scrolling functions needed.
 	 * @details	Defaults to FALSE
 	 * @note	This function must be supported by the low level GDISP driver
-	 * 			you have included in your project. If it isn't, defining this
-	 * 			option will cause a compile error.
+	 * 			you have included in your project (or GDISP_NEED_SHADOW must be set).
+	 * 			If it isn't, defining this option will cause a compile error.
 	 */
 	#ifndef GDISP_NEED_SCROLL
 		#define GDISP_NEED_SCROLL		FALSE
@@ -107,12 +146,22 @@
 	 * @brief   Is the capability to read pixels back needed.
 	 * @details	Defaults to FALSE
 	 * @note	This function must be supported by the low level GDISP driver
-	 * 			you have included in your project. If it isn't, defining this
-	 * 			option will cause a compile error.
+	 * 			you have included in your project (or GDISP_NEED_SHADOW must be set).
+	 * 			If it isn't, defining this option will cause a compile error.
 	 */
 	#ifndef GDISP_NEED_PIXELREAD
 		#define GDISP_NEED_PIXELREAD	FALSE
 	#endif
+	/**
+	 * @brief   Is the capability to copy an area of the screen needed.
+	 * @details	Defaults to FALSE
+	 * @note	If the low level GDISP driver can't copy areas itself then
+	 * 			GDISP_NEED_PIXELREAD must also be set and be supported by the
+	 * 			driver. If it isn't, defining this option will cause a compile error.
+	 */
+	#ifndef GDISP_NEED_COPYAREA
+		#define GDISP_NEED_COPYAREA		FALSE
+	#endif
 	/**
 	 * @brief   Control some aspect of the hardware operation.
 	 * @details	Defaults to FALSE
@@ -137,6 +186,86 @@
 	#ifndef GDISP_NEED_IMAGE
 		#define GDISP_NEED_IMAGE		FALSE
 	#endif
+	/**
+	 * @brief   Is the tile renderer required.
+	 * @details	Defaults to FALSE
+	 * @note	This allows a frame to be composed in a small RAM buffer a band of
+	 * 			lines at a time rather than needing a full screen frame buffer.
+	 */
+	#ifndef GDISP_NEED_TILE
+		#define GDISP_NEED_TILE			FALSE
+	#endif
+	/**
+	 * @brief   Should the display be fronted by a RAM shadow framebuffer.
+	 * @details	Defaults to FALSE
+	 * @note	Pixel reads and scrolling are then served from RAM so they work even
+	 * 			on panels that can't read back. Writes are mirrored to the panel.
+	 * @note	The shadow needs GDISP_SHADOW_CX * GDISP_SHADOW_CY pixels of heap.
+	 */
+	#ifndef GDISP_NEED_SHADOW
+		#define GDISP_NEED_SHADOW		FALSE
+	#endif
+	/**
+	 * @brief   Should filled characters be cached after they have been expanded to pixels.
+	 * @details	Defaults to FALSE
+	 * @note	Redrawing a character with the same font and colors is then a single blit
+	 * 			from the cache. It is only used if the driver supports bitmap blits
+	 * 			in hardware and doesn't draw filled text in hardware.
+	 * @note	The cache uses GDISP_TEXT_CACHE_ENTRIES * GDISP_TEXT_CACHE_GLYPHSIZE pixels of RAM.
+	 */
+	#ifndef GDISP_NEED_TEXT_CACHE
+		#define GDISP_NEED_TEXT_CACHE	FALSE
+	#endif
+	/**
+	 * @brief   Are strings UTF-8 encoded.
+	 * @details	Defaults to FALSE
+	 * @note	When FALSE each byte of a string is one character.
+	 * @note	Characters outside a font's minChar to maxChar range are looked up in
+	 * 			the font's sparse ranges (if it has any) whatever this is set to.
+	 */
+	#ifndef GDISP_NEED_UTF8
+		#define GDISP_NEED_UTF8			FALSE
+	#endif
+	/**
+	 * @brief   Should filled strings be drawn with a single blit.
+	 * @details	Defaults to FALSE
+	 * @note	@p gdispFillString() and @p gdispFillStringBox() then expand the whole
+	 * 			string (with its padding and background) into a buffer and send it to the
+	 * 			driver in one blit rather than one operation per character. Wide strings
+	 * 			are sent in pieces. This is only worthwhile if the driver supports bitmap
+	 * 			blits in hardware.
+	 * @note	The buffer uses GDISP_TEXT_BLIT_SIZE pixels of RAM.
+	 */
+	#ifndef GDISP_NEED_TEXT_BLIT
+		#define GDISP_NEED_TEXT_BLIT	FALSE
+	#endif
+	/**
+	 * @brief   Are multi-line text boxes required.
+	 * @details	Defaults to FALSE
+	 * @note	This adds @p gdispDrawTextBox() and @p gdispFillTextBox() which wrap
+	 * 			text over several lines and remember where the lines break.
+	 */
+	#ifndef GDISP_NEED_TEXTBOX
+		#define GDISP_NEED_TEXTBOX		FALSE
+	#endif
+	/**
+	 * @brief   Can fonts be loaded from font files.
+	 * @details	Defaults to FALSE
+	 * @note	This adds @p gdispLoadFont(). Font files are read using the image
+	 * 			io routines so GDISP_NEED_IMAGE must also be TRUE.
+	 */
+	#ifndef GDISP_NEED_FONT_LOAD
+		#define GDISP_NEED_FONT_LOAD	FALSE
+	#endif
+	/**
+	 * @brief   Should fonts be found by name using a registry.
+	 * @details	Defaults to FALSE
+	 * @note	@p gdispOpenFont() then finds exact names with a hash lookup and
+	 * 			also finds fonts added with @p gdispAddFont() or @p gdispLoadFont().
+	 */
+	#ifndef GDISP_NEED_FONT_REGISTRY
+		#define GDISP_NEED_FONT_REGISTRY	FALSE
+	#endif
 	/**
 	 * @brief   Is the messaging api interface required.
 	 * @details	Defaults to FALSE
@@ -212,6 +341,9 @@
 	 * @note	Turning this on adds two context switches per transaction
 	 *			so it can significantly slow graphics drawing but it allows
 	 *			drawing operations to continue in the background.
+	 * @note	Composite operations (boxes, polygons, strings etc) are
+	 *			drawn synchronously under @p gdispLock() once any queued
+	 *			operations have completed.
 	 */
 	#ifndef GDISP_NEED_ASYNC
 		#define GDISP_NEED_ASYNC		FALSE
@@ -258,6 +390,150 @@
 	#ifndef GDISP_MAX_FONT_HEIGHT
 		#define GDISP_MAX_FONT_HEIGHT	16
 	#endif
+	/**
+	 * @brief   The size (in pixels) of the line buffer used by span based drawing.
+	 * @details	Defaults to 64
+	 * @note	Gradient and pattern fills build each line in this buffer and send it
+	 *			with a single blit. Lines longer than this are sent in pieces.
+	 */
+	#ifndef GDISP_LINEBUF_SIZE
+		#define GDISP_LINEBUF_SIZE		64
+	#endif
+	/**
+	 * @brief   The area of the screen covered by the shadow framebuffer.
+	 * @details	Defaults to 0, 0, 0, 0 (the whole screen)
+	 * @note	A width or height of 0 means up to the right or bottom edge of the screen.
+	 * @note	Drawing outside this area goes straight to the panel. Reading outside it
+	 *			is only possible if the panel itself can read back.
+	 * @note	Only used if GDISP_NEED_SHADOW is TRUE.
+	 */
+	#ifndef GDISP_SHADOW_X
+		#define GDISP_SHADOW_X			0
+	#endif
+	#ifndef GDISP_SHADOW_Y
+		#define GDISP_SHADOW_Y			0
+	#endif
+	#ifndef GDISP_SHADOW_CX
+		#define GDISP_SHADOW_CX			0
+	#endif
+	#ifndef GDISP_SHADOW_CY
+		#define GDISP_SHADOW_CY			0
+	#endif
+	/**
+	 * @brief   Should writes to the shadow framebuffer be sent to the panel immediately.
+	 * @details	Defaults to TRUE
+	 * @note	If FALSE the changed area is remembered and only sent to the panel
+	 *			by @p gdispShadowFlush(). Rows that changed over the same columns are
+	 *			sent together with a single blit.
+	 * @note	Only used if GDISP_NEED_SHADOW is TRUE.
+	 */
+	#ifndef GDISP_SHADOW_AUTOFLUSH
+		#define GDISP_SHADOW_AUTOFLUSH	TRUE
+	#endif
+	/**
+	 * @brief   The number of characters the glyph cache can hold.
+	 * @details	Defaults to 16. Must be no more than 255.
+	 * @note	Only used if GDISP_NEED_TEXT_CACHE is TRUE.
+	 */
+	#ifndef GDISP_TEXT_CACHE_ENTRIES
+		#define GDISP_TEXT_CACHE_ENTRIES	16
+	#endif
+	/**
+	 * @brief   The largest character (in pixels, width * height) the glyph cache can hold.
+	 * @details	Defaults to 256 (eg. 16 x 16)
+	 * @note	Larger characters are drawn without the cache.
+	 * @note	Only used if GDISP_NEED_TEXT_CACHE is TRUE.
+	 */
+	#ifndef GDISP_TEXT_CACHE_GLYPHSIZE
+		#define GDISP_TEXT_CACHE_GLYPHSIZE	256
+	#endif
+	/**
+	 * @brief   The size (in pixels) of the buffer used to blit filled strings.
+	 * @details	Defaults to 2048
+	 * @note	The buffer holds a piece of the string the full height of the font.
+	 * 			Fonts taller than this many pixels for a single column are drawn a character at a time.
+	 * @note	Only used if GDISP_NEED_TEXT_BLIT is TRUE.
+	 */
+	#ifndef GDISP_TEXT_BLIT_SIZE
+		#define GDISP_TEXT_BLIT_SIZE	2048
+	#endif
+	/**
+	 * @brief   The number of glyphs each loaded font keeps in RAM.
+	 * @details	Defaults to 4. Must be between 1 and 255.
+	 * @note	Each entry is the size of the largest glyph in the font.
+	 * @note	Only used if GDISP_NEED_FONT_LOAD is TRUE.
+	 */
+	#ifndef GDISP_FONT_LOAD_CACHE
+		#define GDISP_FONT_LOAD_CACHE	4
+	#endif
+	/**
+	 * @brief   The number of fonts that can be added to the font registry.
+	 * @details	Defaults to 8. The built in fonts are always registered as well.
+	 * @note	Only used if GDISP_NEED_FONT_REGISTRY is TRUE.
+	 */
+	#ifndef GDISP_FONT_REGISTRY_EXTRA
+		#define GDISP_FONT_REGISTRY_EXTRA	8
+	#endif
+	/**
+	 * @brief   The largest inflate window (in bytes) used to decode a PNG image.
+	 * @details	Defaults to 32768 which can decode any PNG image.
+	 * @note	The window is allocated while the image is decoded. It is never bigger than
+	 * 			the window the image was compressed with or the size of the uncompressed
+	 * 			image data, so small images use less RAM.
+	 * @note	Images that need a bigger window fail to open with GDISP_IMAGE_ERR_UNSUPPORTED.
+	 * 			Most PNG optimisers can compress with a smaller window (eg. optipng -zw).
+	 * @note	Only used if GDISP_NEED_IMAGE_PNG is TRUE.
+	 */
+	#ifndef GDISP_IMAGE_PNG_WINDOW_SIZE
+		#define GDISP_IMAGE_PNG_WINDOW_SIZE		32768
+	#endif
+	/**
+	 * @brief   The size (in bytes) of the buffer used to read the compressed PNG data.
+	 * @details	Defaults to 64
+	 * @note	Only used if GDISP_NEED_IMAGE_PNG is TRUE.
+	 */
+	#ifndef GDISP_IMAGE_PNG_FILE_BUFFER_SIZE
+		#define GDISP_IMAGE_PNG_FILE_BUFFER_SIZE	64
+	#endif
+	/**
+	 * @brief   The size (in pixels) of the buffer used to blit decoded PNG rows.
+	 * @details	Defaults to 32
+	 * @note	Only used if GDISP_NEED_IMAGE_PNG is TRUE.
+	 */
+	#ifndef GDISP_IMAGE_PNG_BLIT_BUFFER_SIZE
+		#define GDISP_IMAGE_PNG_BLIT_BUFFER_SIZE	32
+	#endif
+	/**
+	 * @brief   The size (in pixels) of the buffer used to blit decoded BMP rows.
+	 * @details	Defaults to 32
+	 * @note	Making this the width of your images means each row is blitted at once.
+	 * 			It must be at least 32 pixels (and 40 bytes as the headers are read into it).
+	 * @note	Only used if GDISP_NEED_IMAGE_BMP is TRUE.
+	 */
+	#ifndef GDISP_IMAGE_BMP_BLIT_BUFFER_SIZE
+		#define GDISP_IMAGE_BMP_BLIT_BUFFER_SIZE	32
+	#endif
+	/**
+	 * @brief   The size (in bytes) of the buffer used to read uncompressed BMP data.
+	 * @details	Defaults to 64
+	 * @note	As many pixels as fit in both this and the blit buffer are read at once.
+	 * 			16 bit images that match a RGB565 display don't use this buffer.
+	 * @note	Only used if GDISP_NEED_IMAGE_BMP is TRUE.
+	 */
+	#ifndef GDISP_IMAGE_BMP_FILE_BUFFER_SIZE
+		#define GDISP_IMAGE_BMP_FILE_BUFFER_SIZE	64
+	#endif
+	/**
+	 * @brief   The size (in bytes) of the buffer used to read the compressed JPG data.
+	 * @details	Defaults to 64
+	 * @note	The end of the compressed data is only found as it is decoded so up to
+	 * 			this many bytes past the end of the image may be read. An image in
+	 * 			memory should have that much readable memory after it.
+	 * @note	Only used if GDISP_NEED_IMAGE_JPG is TRUE.
+	 */
+	#ifndef GDISP_IMAGE_JPG_FILE_BUFFER_SIZE
+		#define GDISP_IMAGE_JPG_FILE_BUFFER_SIZE	64
+	#endif
 /**
  * @}
  *
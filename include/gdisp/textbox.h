@@ -0,0 +1,163 @@
+/*
+    ChibiOS/GFX - Copyright (C) 2012, 2013
+                 Joel Bodenmann aka Tectu <joel@unormal.org>
+
+    This file is part of ChibiOS/GFX.
+
+    ChibiOS/GFX is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    ChibiOS/GFX is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file    include/gdisp/textbox.h
+ * @brief   GDISP multi-line text box header file.
+ * @details	A text box draws a string over several lines, breaking it at newlines
+ * 			and (optionally) between words. The line breaks and the width of each
+ * 			line are kept in a layout object so that redrawing the text, or drawing
+ * 			it with a different justification, doesn't need to measure it again.
+ *
+ * @addtogroup GDISP
+ * @{
+ */
+
+#ifndef _GDISP_TEXTBOX_H
+#define _GDISP_TEXTBOX_H
+#if (GFX_USE_GDISP && GDISP_NEED_TEXT && GDISP_NEED_TEXTBOX) || defined(__DOXYGEN__)
+
+/**
+ * @brief	Text box layout flags
+ * @{
+ */
+#define GDISP_TEXT_WRAP			0x01		/* Break lines between words so they fit the width of the box */
+#define GDISP_TEXT_ELLIPSIS		0x02		/* End lines that are cut off with "..." */
+/** @} */
+
+/**
+ * @brief	A line of a text box
+ * @note	Offsets are in bytes from the start of the string so strings are limited to 64K.
+ */
+typedef struct gdispTextLine {
+	uint16_t		start;			/* The offset of the first character of the line */
+	uint16_t		len;			/* The length of the line (not including trailing spaces or the newline) */
+	coord_t			width;			/* The width of the line in pixels */
+	} gdispTextLine;
+
+/**
+ * @brief	The layout of a text box
+ * @details	Initialise it with @p gdispTextLayoutInit() and then pass it to each
+ * 			draw of the text box. Lines are only laid out when they are first drawn.
+ * 			The layout is thrown away if the string, font or width change.
+ * @note	If the contents of the string change (but not its address) call
+ * 			@p gdispTextLayoutChanged().
+ */
+typedef struct gdispTextLayout {
+	const char *	str;			/* The string laid out */
+	font_t			font;			/* The font it was laid out for */
+	coord_t			cx;				/* The width it was laid out for */
+	uint8_t			flags;			/* GDISP_TEXT_XXX */
+	bool_t			complete;		/* TRUE if the lines cover the whole string */
+	uint16_t		next;			/* The offset of the next line to lay out */
+	uint16_t		count;			/* The number of valid lines */
+	uint16_t		maxlines;		/* The size of the lines array */
+	gdispTextLine *	lines;			/* The lines */
+	} gdispTextLayout;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+	/**
+	 * @brief	Initialise a text box layout
+	 *
+	 * @param[in] pl		The layout
+	 * @param[in] lines		The array to hold the lines
+	 * @param[in] maxlines	The number of entries in the lines array. Text after this many lines is not shown.
+	 * @param[in] flags		GDISP_TEXT_WRAP and/or GDISP_TEXT_ELLIPSIS
+	 *
+	 * @api
+	 */
+	void gdispTextLayoutInit(gdispTextLayout *pl, gdispTextLine *lines, unsigned maxlines, uint8_t flags);
+
+	/**
+	 * @brief	Tell the layout that the string has been changed
+	 * @details	Lines before the change are kept. Only the lines from the change on
+	 * 			are laid out again.
+	 *
+	 * @param[in] pl		The layout
+	 * @param[in] pos		The offset in the string of the first changed byte
+	 *
+	 * @api
+	 */
+	void gdispTextLayoutChanged(gdispTextLayout *pl, size_t pos);
+
+	/**
+	 * @brief	Lay out the whole of a string
+	 * @return	The number of lines
+	 *
+	 * @param[in] pl		The layout
+	 * @param[in] str		The string
+	 * @param[in] font		The font
+	 * @param[in] cx		The width of the text box
+	 *
+	 * @note	Drawing only lays out the lines that are seen. This is useful to find
+	 * 			out how tall the text box needs to be or to use the line positions
+	 * 			for things like a cursor.
+	 *
+	 * @api
+	 */
+	unsigned gdispTextLayoutUpdate(gdispTextLayout *pl, const char *str, font_t font, coord_t cx);
+
+	/**
+	 * @brief	Draw a multi-line text box
+	 * @details	Lines are drawn from the top of the box, each justified across the box.
+	 *
+	 * @param[in] x,y		The top left corner of the text box
+	 * @param[in] cx,cy		The size of the text box
+	 * @param[in] str		The string
+	 * @param[in] font		The font
+	 * @param[in] color		The color of the text
+	 * @param[in] justify	Justify the lines left, center or right within the box
+	 * @param[in] pl		The layout
+	 *
+	 * @note	Only whole lines are drawn. With GDISP_TEXT_ELLIPSIS the last line
+	 * 			drawn ends with "..." if there is more text than fits in the box.
+	 *
+	 * @api
+	 */
+	void gdispDrawTextBox(coord_t x, coord_t y, coord_t cx, coord_t cy, const char *str, font_t font, color_t color, justify_t justify, gdispTextLayout *pl);
+
+	/**
+	 * @brief	Draw a multi-line text box with a filled background
+	 * @details	As @p gdispDrawTextBox() but the whole box is filled. The background
+	 * 			behind each line is filled as the line is drawn to avoid flicker.
+	 *
+	 * @param[in] x,y		The top left corner of the text box
+	 * @param[in] cx,cy		The size of the text box
+	 * @param[in] str		The string
+	 * @param[in] font		The font
+	 * @param[in] color		The color of the text
+	 * @param[in] bgcolor	The background color
+	 * @param[in] justify	Justify the lines left, center or right within the box
+	 * @param[in] pl		The layout
+	 *
+	 * @api
+	 */
+	void gdispFillTextBox(coord_t x, coord_t y, coord_t cx, coord_t cy, const char *str, font_t font, color_t color, color_t bgcolor, justify_t justify, gdispTextLayout *pl);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* GFX_USE_GDISP && GDISP_NEED_TEXT && GDISP_NEED_TEXTBOX */
+#endif /* _GDISP_TEXTBOX_H */
+/** @} */
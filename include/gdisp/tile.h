@@ -0,0 +1,179 @@
+/*
+    ChibiOS/GFX - Copyright (C) 2012, 2013
+                 Joel Bodenmann aka Tectu <joel@unormal.org>
+
+    This file is part of ChibiOS/GFX.
+
+    ChibiOS/GFX is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    ChibiOS/GFX is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file    include/gdisp/tile.h
+ * @brief   GDISP tile renderer header file.
+ * @details	The tile renderer composes an area of the screen in a small RAM buffer
+ * 			one horizontal band (tile) at a time. Each tile is sent to the display
+ * 			with a single blit so the display sees exactly one window setup per tile
+ * 			and never shows partially drawn (flickering) content.
+ *
+ * @addtogroup GDISP
+ * @{
+ */
+
+#ifndef _GDISP_TILE_H
+#define _GDISP_TILE_H
+#if (GFX_USE_GDISP && GDISP_NEED_TILE) || defined(__DOXYGEN__)
+
+#if GDISP_PACKED_PIXELS
+	#error "GDISP: The tile renderer does not support packed pixel formats."
+#endif
+
+/**
+ * @brief	A tile currently being rendered
+ * @note	All coordinates passed to the tile drawing routines are screen coordinates.
+ * 			Anything outside the tile is silently clipped.
+ */
+typedef struct gdispTile {
+	coord_t		x0, y0;			/* The screen position of the top left of the tile */
+	coord_t		x1, y1;			/* The screen position of the bottom right of the tile (not inclusive) */
+	coord_t		cx;				/* The width of the tile (and the stride of buf) */
+	pixel_t		*buf;			/* The tile pixels */
+	} gdispTile;
+
+/**
+ * @brief	A tile render callback
+ * @details	Called once for each tile. It should draw the whole frame using the
+ * 			gdispTileXXX() routines. Culling anything that doesn't intersect the
+ * 			tile (see @p gdispTileIntersects()) will speed up the rendering.
+ *
+ * @param[in] pt		The tile being rendered
+ * @param[in] param		The parameter passed to @p gdispTileRender()
+ */
+typedef void (*gdispTileRenderFn)(gdispTile *pt, void *param);
+
+/**
+ * @brief	The operations that can be placed in a tile display list
+ */
+typedef enum gdispTileOpCode {
+	GDISP_TILEOP_FILL,			/* x, y, cx, cy, color */
+	GDISP_TILEOP_PIXEL,			/* x, y, color */
+	GDISP_TILEOP_LINE,			/* x, y, cx = x1, cy = y1, color */
+	GDISP_TILEOP_BOX,			/* x, y, cx, cy, color */
+	GDISP_TILEOP_BLIT,			/* x, y, cx, cy, ptr = const pixel_t * (cx pixels per line) */
+	GDISP_TILEOP_CIRCLE,		/* x, y, cx = radius, color */
+	GDISP_TILEOP_FILLCIRCLE,	/* x, y, cx = radius, color */
+	GDISP_TILEOP_STRING,		/* x, y, ptr = const char *, font, color */
+	GDISP_TILEOP_FILLSTRING,	/* x, y, ptr = const char *, font, color, bgcolor */
+	} gdispTileOpCode;
+
+/**
+ * @brief	A tile display list entry
+ * @details	A frame can be described as an array of these rather than with a callback.
+ * 			The usage of each field depends on the operation (see @p gdispTileOpCode).
+ */
+typedef struct gdispTileOp {
+	gdispTileOpCode		op;
+	coord_t				x, y;
+	coord_t				cx, cy;
+	color_t				color;
+	color_t				bgcolor;
+	const void *		ptr;
+	#if GDISP_NEED_TEXT || defined(__DOXYGEN__)
+		font_t			font;
+	#endif
+	} gdispTileOp;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+	/**
+	 * @brief	Render an area of the screen a tile at a time
+	 * @details	For each tile the callback is called to draw into the tile buffer
+	 * 			and then the tile is sent to the display with a single blit.
+	 *
+	 * @param[in] x,y		The top left corner of the area to render
+	 * @param[in] cx,cy		The size of the area to render
+	 * @param[in] buf		The tile buffer
+	 * @param[in] bufsize	The size of the tile buffer in pixels. The tile height is bufsize/cx lines.
+	 * @param[in] fn		The render callback
+	 * @param[in] param		A parameter passed to the render callback
+	 *
+	 * @note	The tile buffer should be at least one line long (cx pixels). A buffer of
+	 * 			32 lines is a good trade off between RAM and speed. eg. 320x32x16bit = 20K
+	 * @note	The tile buffer must not be touched by anything else while rendering.
+	 *
+	 * @api
+	 */
+	void gdispTileRender(coord_t x, coord_t y, coord_t cx, coord_t cy, pixel_t *buf, size_t bufsize, gdispTileRenderFn fn, void *param);
+
+	/**
+	 * @brief	Render a display list a tile at a time
+	 * @details	Each operation is culled against each tile so that only the operations that
+	 * 			affect a tile are drawn into it. Operations are drawn in array order.
+	 *
+	 * @param[in] x,y		The top left corner of the area to render
+	 * @param[in] cx,cy		The size of the area to render
+	 * @param[in] buf		The tile buffer
+	 * @param[in] bufsize	The size of the tile buffer in pixels
+	 * @param[in] ops		The display list
+	 * @param[in] cnt		The number of entries in the display list
+	 *
+	 * @api
+	 */
+	void gdispTileRenderList(coord_t x, coord_t y, coord_t cx, coord_t cy, pixel_t *buf, size_t bufsize, const gdispTileOp *ops, unsigned cnt);
+
+	/**
+	 * @brief	Does an area intersect the tile
+	 * @return	TRUE if any part of the area is within the tile
+	 *
+	 * @param[in] pt		The tile
+	 * @param[in] x,y		The top left corner of the area
+	 * @param[in] cx,cy		The size of the area
+	 */
+	bool_t gdispTileIntersects(const gdispTile *pt, coord_t x, coord_t y, coord_t cx, coord_t cy);
+
+	/**
+	 * @brief	Drawing routines for use within a tile render callback
+	 * @note	These only touch the tile buffer - nothing is sent to the display
+	 * 			until the whole tile has been rendered.
+	 * @note	Text in a loaded font briefly takes the GDISP lock for each character
+	 * 			as the font's glyph cache is shared with the display drawing. So these
+	 * 			must not be called between @p gdispLock() and @p gdispUnlock().
+	 * @{
+	 */
+	void gdispTileClear(gdispTile *pt, color_t color);
+	void gdispTileDrawPixel(gdispTile *pt, coord_t x, coord_t y, color_t color);
+	void gdispTileDrawLine(gdispTile *pt, coord_t x0, coord_t y0, coord_t x1, coord_t y1, color_t color);
+	void gdispTileFillArea(gdispTile *pt, coord_t x, coord_t y, coord_t cx, coord_t cy, color_t color);
+	void gdispTileDrawBox(gdispTile *pt, coord_t x, coord_t y, coord_t cx, coord_t cy, color_t color);
+	void gdispTileBlitArea(gdispTile *pt, coord_t x, coord_t y, coord_t cx, coord_t cy, coord_t srcx, coord_t srcy, coord_t srccx, const pixel_t *buffer);
+	#if GDISP_NEED_CIRCLE || defined(__DOXYGEN__)
+		void gdispTileDrawCircle(gdispTile *pt, coord_t x, coord_t y, coord_t radius, color_t color);
+		void gdispTileFillCircle(gdispTile *pt, coord_t x, coord_t y, coord_t radius, color_t color);
+	#endif
+	#if GDISP_NEED_TEXT || defined(__DOXYGEN__)
+		void gdispTileDrawChar(gdispTile *pt, coord_t x, coord_t y, unicode_t c, font_t font, color_t color);
+		void gdispTileFillChar(gdispTile *pt, coord_t x, coord_t y, unicode_t c, font_t font, color_t color, color_t bgcolor);
+		void gdispTileDrawString(gdispTile *pt, coord_t x, coord_t y, const char *str, font_t font, color_t color);
+		void gdispTileFillString(gdispTile *pt, coord_t x, coord_t y, const char *str, font_t font, color_t color, color_t bgcolor);
+	#endif
+	/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* GFX_USE_GDISP && GDISP_NEED_TILE */
+#endif /* _GDISP_TILE_H */
+/** @} */
@@ -34,6 +34,8 @@
 
 #include "gdisp/fonts.h"
 
+#include <string.h>
+
 /* fontSmall - for side buttons */
 #if GDISP_INCLUDE_FONT_SMALL
     /* Forward Declarations of internal arrays */
@@ -46,19 +48,22 @@
 									11, 0, 14, 2, 2, 12, ' ', '~', 1, 1,
 									fontSmall_Widths,
 									fontSmall_Offsets,
-									fontSmall_Data};
+									fontSmall_Data,
+									FONT_FORMAT_COLUMNS, 1, 0, 0, 0};
     static const struct font fontSmallDouble = {
 									"Small Double",
 									11, 0, 14, 2, 2, 12, ' ', '~', 2, 2,
 									fontSmall_Widths,
 									fontSmall_Offsets,
-									fontSmall_Data};
+									fontSmall_Data,
+									FONT_FORMAT_COLUMNS, 1, 0, 0, 0};
     static const struct font fontSmallNarrow = {
 									"Small Narrow",
 									11, 0, 14, 2, 2, 12, ' ', '~', 1, 2,
 									fontSmall_Widths,
 									fontSmall_Offsets,
-									fontSmall_Data};
+									fontSmall_Data,
+									FONT_FORMAT_COLUMNS, 1, 0, 0, 0};
 
 	static const uint8_t fontSmall_Widths[] = {
 		2, 3, 6, 8, 7, 9, 7, 3, 4, 4, 5, 7, 4, 4, 3, 6,
@@ -193,19 +198,22 @@
 									12, 1, 13, 2, 2, 13, ' ', '~', 1, 1,
 									fontLarger_Widths,
 									fontLarger_Offsets,
-									fontLarger_Data};
+									fontLarger_Data,
+									FONT_FORMAT_COLUMNS, 1, 0, 0, 0};
     static const struct font fontLargerDouble = {
 									"Larger Double",
 									12, 1, 13, 2, 2, 13, ' ', '~', 2, 2,
 									fontLarger_Widths,
 									fontLarger_Offsets,
-									fontLarger_Data};
+									fontLarger_Data,
+									FONT_FORMAT_COLUMNS, 1, 0, 0, 0};
     static const struct font fontLargerNarrow = {
 									"Larger Narrow",
 									12, 1, 13, 2, 2, 13, ' ', '~', 1, 2,
 									fontLarger_Widths,
 									fontLarger_Offsets,
-									fontLarger_Data};
+									fontLarger_Data,
+									FONT_FORMAT_COLUMNS, 1, 0, 0, 0};
 	static const uint8_t fontLarger_Widths[] = {
 		2, 3, 5, 8, 7, 13, 8, 2, 4, 4, 7, 8, 3, 4, 3, 5,
 		7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 3, 3, 9, 8, 9, 6,
@@ -340,19 +348,22 @@
 									13, 0, 15, 2, 3, 13, ' ', '~', 1, 1,
 									fontUI1_Widths,
 									fontUI1_Offsets,
-									fontUI1_Data};
+									fontUI1_Data,
+									FONT_FORMAT_COLUMNS, 1, 0, 0, 0};
     static const struct font fontUI1Double = {
 									"UI1 Double",
 									13, 0, 15, 2, 3, 13, ' ', '~', 2, 2,
 									fontUI1_Widths,
 									fontUI1_Offsets,
-									fontUI1_Data};
+									fontUI1_Data,
+									FONT_FORMAT_COLUMNS, 1, 0, 0, 0};
     static const struct font fontUI1Narrow = {
 									"UI1 Narrow",
 									13, 0, 15, 2, 3, 13, ' ', '~', 1, 2,
 									fontUI1_Widths,
 									fontUI1_Offsets,
-									fontUI1_Data};
+									fontUI1_Data,
+									FONT_FORMAT_COLUMNS, 1, 0, 0, 0};
 
 	static const uint8_t fontUI1_Widths[] = {
 		3, 3, 6, 8, 7, 13, 9, 3, 5, 5, 6, 8, 3, 5, 3, 7,
@@ -488,19 +499,22 @@
 									11, 1, 13, 2, 2, 12, ' ', '~', 1, 1,
 									fontUI2_Widths,
 									fontUI2_Offsets,
-									fontUI2_Data};
+									fontUI2_Data,
+									FONT_FORMAT_COLUMNS, 1, 0, 0, 0};
 	static const struct font fontUI2Double = {
 									"UI2 Double",
 									11, 1, 13, 2, 2, 12, ' ', '~', 2, 2,
 									fontUI2_Widths,
 									fontUI2_Offsets,
-									fontUI2_Data};
+									fontUI2_Data,
+									FONT_FORMAT_COLUMNS, 1, 0, 0, 0};
 	static const struct font fontUI2Narrow = {
 									"UI2 Narrow",
 									11, 1, 13, 2, 2, 12, ' ', '~', 1, 2,
 									fontUI2_Widths,
 									fontUI2_Offsets,
-									fontUI2_Data};
+									fontUI2_Data,
+									FONT_FORMAT_COLUMNS, 1, 0, 0, 0};
 
 	static const uint8_t fontUI2_Widths[] = {
 		2, 2, 5, 8, 6, 12, 8, 2, 4, 4, 6, 8, 2, 4, 2, 5,
@@ -639,18 +653,21 @@
 									16, 2, 21, 1, 3, 15, '%', ':', 1, 1,
 									fontLargeNumbers_Widths,
 									fontLargeNumbers_Offsets,
-									fontLargeNumbers_Data};
+									fontLargeNumbers_Data,
+									FONT_FORMAT_COLUMNS, 1, 0, 0, 0};
     static const struct font fontLargeNumbersDouble = {
 									"LargeNumbers Double",
 									16, 2, 21, 1, 3, 15, '%', ':', 2, 2,
 									fontLargeNumbers_Widths,
 									fontLargeNumbers_Offsets,
-									fontLargeNumbers_Data};
+									fontLargeNumbers_Data,
+									FONT_FORMAT_COLUMNS, 1, 0, 0, 0};
     static const struct font fontLargeNumbersNarrow = {
 									"LargeNumbers Narrow", 16, 2, 21, 1, 3, 15, '%', ':', 1, 2,
 									fontLargeNumbers_Widths,
 									fontLargeNumbers_Offsets,
-									fontLargeNumbers_Data};
+									fontLargeNumbers_Data,
+									FONT_FORMAT_COLUMNS, 1, 0, 0, 0};
 
 	static const uint8_t fontLargeNumbers_Widths[] = {
 		15, 0, 0, 0, 0, 0, 11, 3, 6, 3, 0, 10, 10, 10, 10, 10,
@@ -726,22 +743,639 @@ static bool_t matchfont(const char *pattern, const char *name) {
 	}
 }
 
-font_t gdispOpenFont(const char *name) {
-	const struct font **p;
+#if !GDISP_NEED_FONT_REGISTRY
+	font_t gdispOpenFont(const char *name) {
+		const struct font **p;
 
-	for(p = BuiltinFontTable; p < BuiltinFontTable+sizeof(BuiltinFontTable)/sizeof(BuiltinFontTable[0]); p++) {
-		if (matchfont(name, p[0]->name))
-			return p[0];
+		for(p = BuiltinFontTable; p < BuiltinFontTable+sizeof(BuiltinFontTable)/sizeof(BuiltinFontTable[0]); p++) {
+			if (matchfont(name, p[0]->name))
+				return p[0];
+		}
+		return 0;
 	}
-	return 0;
+#endif
+
+const char *gdispGetFontName(font_t font) {
+	return font->name;
 }
 
+#if GDISP_NEED_FONT_LOAD || GDISP_NEED_FONT_REGISTRY
+	/* Protects the font registry and the open counts of loaded fonts. It is separate from the
+	 *	display lock so fonts can be opened before gdispInit() and without waiting for drawing.
+	 */
+	static MUTEX_DECL(fontMutex);
+#endif
+
+#if GDISP_NEED_FONT_LOAD
+	#if !GDISP_NEED_IMAGE
+		#error "GDISP: GDISP_NEED_FONT_LOAD needs GDISP_NEED_IMAGE for the io routines"
+	#endif
+	#if GDISP_FONT_LOAD_CACHE < 1 || GDISP_FONT_LOAD_CACHE > 255
+		#error "GDISP: GDISP_FONT_LOAD_CACHE must be between 1 and 255"
+	#endif
+
+	/* The size of the font file header */
+	#define FONTFILE_HEADER		28
+	#define FONTFILE_RANGE		12
+
+	/* Read little endian values from a buffer */
+	#define get16(p)	((uint16_t)((p)[0] | ((p)[1] << 8)))
+	#define get32(p)	((uint32_t)get16(p) | ((uint32_t)get16((p)+2) << 16))
+
+	/*
+	 * A loaded font. Everything but the glyph data is read when the font is loaded.
+	 * In memory this is followed by the ranges, the glyph cache, the offsets, the widths and the name.
+	 */
+	typedef struct fontloaded_t {
+		struct font		f;								/* Must be first */
+		gdispImageIO	io;
+		uint32_t		glyphPos;						/* Where the glyph data starts in the file */
+		uint32_t		glyphSize;						/* The size of the glyph data */
+		uint16_t		slotSize;						/* The space for each glyph in the cache */
+		uint16_t		refs;							/* The number of opens (including the load) */
+		uint8_t			slotsUsed;						/* The number of glyph cache entries in use */
+		uint8_t			slotOrder[GDISP_FONT_LOAD_CACHE];	/* Cache entries - most recently used first */
+		unicode_t		slotChar[GDISP_FONT_LOAD_CACHE];	/* The character in each cache entry */
+		uint8_t			*slots;
+	} fontloaded_t;
+
+	unsigned fontUnloadCount;
+
+	font_t gdispLoadFont(struct gdispImageIO *pio) {
+		uint8_t			hdr[FONTFILE_HEADER];
+		fontloaded_t	*pf;
+		fontrange_t		*pr;
+		uint16_t		*po;
+		uint8_t			*p;
+		size_t			sz;
+		unsigned		entries, ranges, namelen, i;
+
+		/* Read and check the header */
+		pio->fns->seek(pio, 0);
+		if (pio->fns->read(pio, hdr, FONTFILE_HEADER) != FONTFILE_HEADER
+				|| hdr[0] != 'G' || hdr[1] != 'F' || hdr[2] != 'N' || hdr[3] != 'T' || hdr[4] != 1
+				|| hdr[5] > FONT_FORMAT_RLE
+				|| (hdr[5] == FONT_FORMAT_COLUMNS && hdr[15] != sizeof(fontcolumn_t))
+				|| (hdr[6] != 1 && hdr[6] != 2 && hdr[6] != 4))
+			goto badfont;
+		entries = get16(hdr+16);
+		ranges = get16(hdr+18);
+		namelen = hdr[22];
+
+		/* The characters from minChar to maxChar are looked up directly in the tables */
+		if (hdr[13] <= hdr[14] && entries < (unsigned)(hdr[14] - hdr[13] + 1))
+			goto badfont;
+
+		/* A glyph of the maximum width must fit in the glyph cache */
+		if (hdr[5] == FONT_FORMAT_COLUMNS
+				? hdr[7] > 8 * sizeof(fontcolumn_t) || get16(hdr+20) < hdr[12] * sizeof(fontcolumn_t)
+				: hdr[5] == FONT_FORMAT_ROWS && get16(hdr+20) < hdr[7] * ((hdr[12] * hdr[6] + 7) / 8))
+			goto badfont;
+
+		/* Everything but the glyph data in one block */
+		sz = sizeof(fontloaded_t) + ranges * sizeof(fontrange_t)
+				+ GDISP_FONT_LOAD_CACHE * ((get16(hdr+20) + 3) & ~3)
+				+ entries * sizeof(uint16_t) + entries + namelen + 1;
+		if (!(pf = (fontloaded_t *)chHeapAlloc(NULL, sz)))
+			goto badfont;
+
+		pr = (fontrange_t *)(pf+1);
+		pf->slotSize = (get16(hdr+20) + 3) & ~3;
+		pf->refs = 1;
+		pf->slotsUsed = 0;
+		pf->slots = (uint8_t *)(pr + ranges);
+		po = (uint16_t *)(pf->slots + GDISP_FONT_LOAD_CACHE * pf->slotSize);
+		p = (uint8_t *)(po + entries);
+
+		pf->f.name = (const char *)(p + entries);
+		pf->f.height = hdr[7];
+		pf->f.charPadding = hdr[8];
+		pf->f.lineSpacing = hdr[9];
+		pf->f.descenderHeight = hdr[10];
+		pf->f.minWidth = hdr[11];
+		pf->f.maxWidth = hdr[12];
+		pf->f.minChar = (char)hdr[13];
+		pf->f.maxChar = (char)hdr[14];
+		pf->f.xscale = 1;
+		pf->f.yscale = 1;
+		pf->f.widthTable = p;
+		pf->f.offsetTable = po;
+		pf->f.dataTable = 0;
+		pf->f.format = hdr[5] | FONT_FORMAT_PAGED;
+		pf->f.bpp = hdr[6];
+		pf->f.glyphData = 0;
+		pf->f.ranges = pr;
+		pf->f.rangeCount = ranges;
+		pf->glyphSize = get32(hdr+24);
+
+		/* The name, the widths, the offsets and the ranges. The tables are converted in place. */
+		if (pio->fns->read(pio, (void *)pf->f.name, namelen) != namelen
+				|| pio->fns->read(pio, p, entries) != entries
+				|| pio->fns->read(pio, po, entries * 2) != entries * 2
+				|| pio->fns->read(pio, pr, ranges * FONTFILE_RANGE) != ranges * FONTFILE_RANGE)
+			goto badload;
+		((char *)pf->f.name)[namelen] = 0;
+		for(i = 0; i < entries; i++) {
+			if (p[i] > pf->f.maxWidth)
+				goto badload;
+			po[i] = get16((uint8_t *)&po[i]);
+		}
+		for(i = ranges; i--; ) {
+			/* Backwards in case fontrange_t is bigger than the file entry */
+			p = (uint8_t *)pr + i * FONTFILE_RANGE;
+			pr[i].base = get32(p+8);
+			pr[i].index = get16(p+6);
+			pr[i].count = get16(p+4);
+			pr[i].first = get32(p);
+			if ((unsigned)pr[i].index + pr[i].count > entries)
+				goto badload;
+		}
+
+		pf->glyphPos = pio->pos;
+		pf->io = *pio;
+
+		#if GDISP_NEED_FONT_REGISTRY
+			/* If the registry is full it just can't be found by name */
+			gdispAddFont(&pf->f);
+		#endif
+		return &pf->f;
+
+	badload:
+		chHeapFree(pf);
+	badfont:
+		pio->fns->close(pio);
+		return 0;
+	}
+
+	const uint8_t *fontGetPagedGlyph(const struct font *font, unicode_t c) {
+		fontloaded_t	*pf;
+		uint32_t		offset;
+		size_t			len;
+		unsigned		i;
+		uint8_t			e;
+
+		pf = (fontloaded_t *)font;
+
+		/* Is it in the cache */
+		for(i = 0; i < pf->slotsUsed; i++) {
+			if (pf->slotChar[pf->slotOrder[i]] == c)
+				break;
+		}
+
+		if (i < pf->slotsUsed)
+			e = pf->slotOrder[i];
+		else {
+			/* Read it into the least recently used entry */
+			if (pf->slotsUsed < GDISP_FONT_LOAD_CACHE) {
+				i = pf->slotsUsed++;
+				pf->slotOrder[i] = (uint8_t)i;
+			} else
+				i = GDISP_FONT_LOAD_CACHE-1;
+			e = pf->slotOrder[i];
+			pf->slotChar[e] = c;
+
+			/* Read the largest glyph size - the glyph is somewhere in the start of it */
+			offset = _getCharOffset(font, c);
+			len = offset < pf->glyphSize ? pf->glyphSize - offset : 0;
+			if (len > pf->slotSize)
+				len = pf->slotSize;
+			pf->io.fns->seek(&pf->io, pf->glyphPos + offset);
+			if (pf->io.fns->read(&pf->io, pf->slots + e * pf->slotSize, len) != len)
+				memset(pf->slots + e * pf->slotSize, 0, pf->slotSize);
+			else if (_getFontFormat(font) == FONT_FORMAT_COLUMNS) {
+				fontcolumn_t	*pc;
+
+				/* Column data is little endian in the file */
+
+				for(pc = (fontcolumn_t *)(pf->slots + e * pf->slotSize); len >= sizeof(fontcolumn_t); pc++, len -= sizeof(fontcolumn_t)) {
+					#if GDISP_MAX_FONT_HEIGHT == 16
+						*pc = get16((uint8_t *)pc);
+					#else
+						*pc = get32((uint8_t *)pc);
+					#endif
+				}
+			}
+		}
+
+		/* Move it to the front */
+		for(; i; i--)
+			pf->slotOrder[i] = pf->slotOrder[i-1];
+		pf->slotOrder[0] = e;
+		return pf->slots + e * pf->slotSize;
+	}
+#endif
+
+#if GDISP_NEED_FONT_REGISTRY
+	#define FONT_HASH_SIZE		32					/* Must be a power of 2 */
+	#define FONT_BUILTIN_COUNT	(sizeof(BuiltinFontTable)/sizeof(BuiltinFontTable[0]))
+	#define FONT_ENTRIES		(FONT_BUILTIN_COUNT + GDISP_FONT_REGISTRY_EXTRA)
+	#define FONT_NONE			0xFF
+
+	#if GDISP_FONT_REGISTRY_EXTRA < 0 || GDISP_FONT_REGISTRY_EXTRA > 200
+		#error "GDISP: GDISP_FONT_REGISTRY_EXTRA must be between 0 and 200"
+	#endif
+
+	/* A registered font. Entries are never moved so searching them in order finds the built in fonts first. */
+	typedef struct fontentry {
+		font_t			font;					/* NULL if the entry is free */
+		uint16_t		hash;					/* The hash of the font name */
+		uint8_t			next;					/* The next entry with the same hash bucket */
+	} fontentry;
+
+	static fontentry	fontEntries[FONT_ENTRIES];
+	static uint8_t		fontBuckets[FONT_HASH_SIZE];
+	static bool_t		fontRegistryReady;
+
+	static uint16_t hashname(const char *name) {
+		uint16_t	h;
+
+		for(h = 0; *name; name++)
+			h = (h << 5) - h + (uint8_t)*name;
+		return h;
+	}
+
+	/* Put a font in an entry and link it into its hash bucket. Buckets are kept in entry order. */
+	static void linkfont(unsigned i, font_t font) {
+		uint8_t		*pi;
+
+		fontEntries[i].font = font;
+		fontEntries[i].hash = hashname(font->name);
+		for(pi = &fontBuckets[fontEntries[i].hash & (FONT_HASH_SIZE-1)]; *pi != FONT_NONE && *pi < i; pi = &fontEntries[*pi].next);
+		fontEntries[i].next = *pi;
+		*pi = (uint8_t)i;
+	}
+
+	/* Register the built in fonts. Must be called with fontMutex held. */
+	static void initregistry(void) {
+		unsigned	i;
+
+		for(i = 0; i < FONT_HASH_SIZE; i++)
+			fontBuckets[i] = FONT_NONE;
+		for(i = 0; i < FONT_BUILTIN_COUNT; i++)
+			linkfont(i, BuiltinFontTable[i]);
+		fontRegistryReady = TRUE;
+	}
+
+	bool_t gdispAddFont(font_t font) {
+		unsigned	i;
+
+		chMtxLock(&fontMutex);
+		if (!fontRegistryReady)
+			initregistry();
+		for(i = FONT_BUILTIN_COUNT; i < FONT_ENTRIES; i++) {
+			if (!fontEntries[i].font) {
+				linkfont(i, font);
+				break;
+			}
+		}
+		chMtxUnlock();
+		return i < FONT_ENTRIES;
+	}
+
+	font_t gdispOpenFont(const char *name) {
+		const char	*s;
+		font_t		font;
+		uint16_t	h;
+		unsigned	i;
+
+		chMtxLock(&fontMutex);
+		if (!fontRegistryReady)
+			initregistry();
+
+		/* Look up exact names by their hash */
+		for(s = name; *s && *s != '*'; s++);
+		if (!*s) {
+			h = hashname(name);
+			for(i = fontBuckets[h & (FONT_HASH_SIZE-1)]; i != FONT_NONE; i = fontEntries[i].next) {
+				if (fontEntries[i].hash == h && !strcmp(fontEntries[i].font->name, name))
+					break;
+			}
+
+		/* Anything with a wildcard needs every font name checked */
+		} else {
+			for(i = 0; i < FONT_ENTRIES; i++) {
+				if (fontEntries[i].font && matchfont(name, fontEntries[i].font->name))
+					break;
+			}
+			if (i == FONT_ENTRIES)
+				i = FONT_NONE;
+		}
+
+		font = 0;
+		if (i != FONT_NONE) {
+			font = fontEntries[i].font;
+
+			#if GDISP_NEED_FONT_LOAD
+				/* A loaded font stays loaded until everything that opened it has closed it.
+				 *	If it has been opened too many times to count the open fails.
+				 */
+				if ((font->format & FONT_FORMAT_PAGED)) {
+					if (((fontloaded_t *)font)->refs < 0xFFFF)
+						((fontloaded_t *)font)->refs++;
+					else
+						font = 0;
+				}
+			#endif
+		}
+		chMtxUnlock();
+		return font;
+	}
+
+	#if GDISP_NEED_FONT_LOAD
+		/* Take a font out of the registry. Must be called with fontMutex held. */
+		static void removefont(font_t font) {
+			uint8_t		*pi;
+			unsigned	i;
+
+			if (!fontRegistryReady)
+				return;
+			for(i = FONT_BUILTIN_COUNT; i < FONT_ENTRIES && fontEntries[i].font != font; i++);
+			if (i < FONT_ENTRIES) {
+				for(pi = &fontBuckets[fontEntries[i].hash & (FONT_HASH_SIZE-1)]; *pi != i; pi = &fontEntries[*pi].next);
+				*pi = fontEntries[i].next;
+				fontEntries[i].font = 0;
+			}
+		}
+	#endif
+#endif
+
 void gdispCloseFont(font_t font) {
+	#if GDISP_NEED_FONT_LOAD
+		if (font && (font->format & FONT_FORMAT_PAGED)) {
+			fontloaded_t	*pf;
+			uint16_t		refs;
+
+			/* Only the last close unloads it */
+			pf = (fontloaded_t *)font;
+			chMtxLock(&fontMutex);
+			refs = --pf->refs;
+			if (!refs) {
+				#if GDISP_NEED_FONT_REGISTRY
+					removefont(font);
+				#endif
+				/* Before the memory can be reused by another font */
+				fontUnloadCount++;
+			}
+			chMtxUnlock();
+			if (refs)
+				return;
+			pf->io.fns->close(&pf->io);
+			chHeapFree(pf);
+			return;
+		}
+	#endif
 	(void) font;
 }
 
-const char *gdispGetFontName(font_t font) {
-	return font->name;
+/* Find the range holding a character - NULL if there isn't one */
+static const fontrange_t *findrange(const struct font *font, unicode_t c) {
+	const fontrange_t	*r;
+	unsigned			lo, hi, mid;
+
+	lo = 0;
+	hi = font->rangeCount;
+	while(lo < hi) {
+		mid = (lo + hi) / 2;
+		r = &font->ranges[mid];
+		if (c < r->first)
+			hi = mid;
+		else if (c >= r->first + r->count)
+			lo = mid + 1;
+		else
+			return r;
+	}
+	return 0;
+}
+
+uint8_t fontGetRangeWidth(const struct font *font, unicode_t c) {
+	const fontrange_t	*r;
+
+	if (!(r = findrange(font, c)))
+		return 0;
+	return font->widthTable[r->index + (c - r->first)];
+}
+
+uint32_t fontGetRangeOffset(const struct font *font, unicode_t c) {
+	const fontrange_t	*r;
+
+	if (!(r = findrange(font, c)))
+		return 0;
+	return r->base + font->offsetTable[r->index + (c - r->first)];
+}
+
+#if GDISP_NEED_UTF8
+	unicode_t fontGetUTF8Char(const char **pstr) {
+		const uint8_t	*s;
+		unicode_t		c;
+		uint8_t			n;
+
+		s = (const uint8_t *)*pstr;
+		c = *s++;
+		if (c < 0x80)
+			n = 0;
+		else if ((c & 0xE0) == 0xC0) {
+			c &= 0x1F;
+			n = 1;
+		} else if ((c & 0xF0) == 0xE0) {
+			c &= 0x0F;
+			n = 2;
+		} else if ((c & 0xF8) == 0xF0) {
+			c &= 0x07;
+			n = 3;
+		} else {
+			*pstr = (const char *)s;
+			return 0xFFFD;
+		}
+
+		/* Stop at anything that isn't a continuation byte - including the end of the string */
+		for(; n; n--, s++) {
+			if ((*s & 0xC0) != 0x80) {
+				c = 0xFFFD;
+				break;
+			}
+			c = (c << 6) | (*s & 0x3F);
+		}
+		*pstr = (const char *)s;
+		return c;
+	}
+
+	unicode_t fontGetUTF8PrevChar(const char **pstr, const char *start) {
+		const char	*s;
+		uint8_t		c, k, n;
+
+		/* Back up over up to 3 continuation bytes */
+		s = *pstr - 1;
+		for(k = 0; k < 3 && s > start && (*s & 0xC0) == 0x80; k++)
+			s--;
+
+		/* How many continuation bytes that lead byte takes */
+		c = *s;
+		if ((c & 0xE0) == 0xC0)
+			n = 1;
+		else if ((c & 0xF0) == 0xE0)
+			n = 2;
+		else if ((c & 0xF8) == 0xF0)
+			n = 3;
+		else
+			n = 0;
+
+		/* More continuation bytes than that - the last one is an orphan just as it is going forward */
+		if (k > n) {
+			*pstr -= 1;
+			return 0xFFFD;
+		}
+		*pstr = s;
+		return fontGetUTF8Char(&s);
+	}
+#endif
+
+void fontDecodeStart(fontdecoder_t *d, const struct font *font, unicode_t c) {
+	d->ptr = _getCharGlyph(font, c);
+	d->end = 0;
+	#if GDISP_NEED_FONT_LOAD
+		/* A bad font file must not run the decoder off the end of the glyph cache entry */
+		if ((font->format & FONT_FORMAT_PAGED))
+			d->end = d->ptr + ((fontloaded_t *)font)->slotSize;
+	#endif
+	d->format = _getFontFormat(font);
+	d->width = _getCharWidth(font, c);
+	d->x = 0;
+	d->bpp = font->bpp ? font->bpp : 1;
+	d->bit = 0;
+	d->on = TRUE;			/* The first run is background */
+	d->left = 0;
+}
+
+/* The coverage of the next pixel in a FONT_FORMAT_ROWS glyph */
+#define rowpixel(d)		((*(d)->ptr >> (8 - (d)->bpp - (d)->bit)) & ((1 << (d)->bpp) - 1))
+
+uint8_t fontDecodeRun(fontdecoder_t *d, uint8_t *level) {
+	uint8_t		n;
+
+	if (d->format == FONT_FORMAT_RLE) {
+		/* Move to the next non-empty run */
+		while(!d->left) {
+			/* Past the end of the glyph data everything is background */
+			if (d->ptr == d->end) {
+				d->on = FALSE;
+				d->left = 255;
+				break;
+			}
+			d->on = !d->on;
+			d->left = *d->ptr++;
+		}
+		n = d->width - d->x;
+		if (n > d->left)
+			n = d->left;
+		d->left -= n;
+		*level = d->on ? 1 : 0;
+
+	} else {
+		/* Count the pixels until the coverage changes or the row ends */
+		*level = rowpixel(d);
+		n = 0;
+		do {
+			n++;
+			if ((d->bit += d->bpp) >= 8) {
+				d->bit = 0;
+				d->ptr++;
+			}
+		} while(d->x + n < d->width && rowpixel(d) == *level);
+
+		/* Rows start on a byte boundary */
+		if (d->x + n >= d->width && d->bit) {
+			d->bit = 0;
+			d->ptr++;
+		}
+	}
+
+	d->x += n;
+	if (d->x >= d->width)
+		d->x = 0;
+	return n;
+}
+
+color_t fontBlendColor(color_t color, color_t bgcolor, uint8_t level, uint8_t bpp) {
+	unsigned	max, a, b;
+
+	max = (1 << bpp) - 1;
+	if (level >= max) return color;
+	if (!level) return bgcolor;
+	a = level;
+	b = max - level;
+	return RGB2COLOR(
+		(RED_OF(color)*a + RED_OF(bgcolor)*b + max/2) / max,
+		(GREEN_OF(color)*a + GREEN_OF(bgcolor)*b + max/2) / max,
+		(BLUE_OF(color)*a + BLUE_OF(bgcolor)*b + max/2) / max);
+}
+
+const color_t *fontGetRamp(fontramp_t *r, uint8_t bpp, color_t color, color_t bgcolor) {
+	uint8_t		i;
+
+	if (!bpp) bpp = 1;
+	if (r->bpp != bpp || r->color != color || r->bgcolor != bgcolor) {
+		r->bpp = bpp;
+		r->color = color;
+		r->bgcolor = bgcolor;
+		for(i = 0; i < (1 << bpp); i++)
+			r->ramp[i] = fontBlendColor(color, bgcolor, i, bpp);
+	}
+	return r->ramp;
+}
+
+void fontExpandChar(pixel_t *buf, coord_t stride, coord_t bx, unicode_t c, const struct font *font, coord_t sx, coord_t cx, const color_t *ramp) {
+	coord_t		i, j, k, n, ys, ex;
+	coord_t		width, height, xscale, yscale;
+
+	xscale = font->xscale;
+	yscale = font->yscale;
+	width = _getCharWidth(font, c) * xscale;
+	height = font->height * yscale;
+	ex = sx + cx;
+	bx -= sx;
+
+	/* Row based fonts - whole rows are decoded but only the wanted columns are written */
+	if (_getFontFormat(font) != FONT_FORMAT_COLUMNS) {
+		fontdecoder_t	d, rowstart;
+		uint8_t			level;
+
+		fontDecodeStart(&d, font, c);
+		for(j = 0; j < height; j++) {
+			if (j % yscale)
+				d = rowstart;
+			else
+				rowstart = d;
+			for(i = 0; i < width; i += n) {
+				n = fontDecodeRun(&d, &level) * xscale;
+				for(k = i < sx ? sx : i; k < i + n && k < ex; k++)
+					gdispPackPixels(buf, stride, bx + k, j, ramp[level]);
+			}
+		}
+		return;
+	}
+
+	/* Column based fonts - the font data is LSBit first, down the column */
+	{
+		const fontcolumn_t	*ptr;
+		fontcolumn_t		column;
+		color_t				color;
+
+		ptr = _getCharData(font, c) + sx / xscale;
+		for(i = sx; i < ex; i += n, ptr++) {
+			/* How many of the scaled columns for this column we want */
+			n = xscale - i % xscale;
+			if (n > ex - i)
+				n = ex - i;
+
+			column = *ptr;
+			for(j = 0; j < height; j += yscale, column >>= 1) {
+				color = ramp[column & 0x01];
+				for(k = i; k < i + n; k++)
+					for(ys = 0; ys < yscale; ys++)
+						gdispPackPixels(buf, stride, bx + k, j + ys, color);
+			}
+		}
+	}
 }
 
 #endif /* GFX_USE_GDISP && GDISP_NEED_TEXT */
@@ -31,6 +31,8 @@
 
 #if GFX_USE_GDISP
 
+#include <string.h>
+
 #ifdef GDISP_NEED_TEXT
 	#include "gdisp/fonts.h"
 #endif
@@ -66,6 +68,18 @@
 	static Mutex			gdispMutex;
 #endif
 
+/* A line buffer shared by the span based drawing routines. It is only used with the GDISP lock held. */
+#if GDISP_NEED_GRADIENT || GDISP_NEED_PATTERN || GDISP_NEED_SCALE || GDISP_NEED_ROTATE || (GDISP_NEED_TEXT && GDISP_NEED_TEXT_BLIT)
+	#if GDISP_LINEBUF_SIZE < 8
+		#error "GDISP: GDISP_LINEBUF_SIZE must be at least 8"
+	#endif
+	#if GDISP_NEED_TEXT && GDISP_NEED_TEXT_BLIT && GDISP_TEXT_BLIT_SIZE > GDISP_LINEBUF_SIZE
+		static pixel_t			gdispLineBuf[GDISP_TEXT_BLIT_SIZE];
+	#else
+		static pixel_t			gdispLineBuf[GDISP_LINEBUF_SIZE];
+	#endif
+#endif
+
 #if GDISP_NEED_ASYNC
 	#define GDISP_THREAD_STACK_SIZE	512		/* Just a number - not yet a reflection of actual use */
 	#define GDISP_QUEUE_SIZE		8		/* We only allow a short queue */
@@ -74,6 +88,7 @@
 	static Mailbox			gdispMailbox;
 	static msg_t 			gdispMailboxQueue[GDISP_QUEUE_SIZE];
 	static Semaphore		gdispMsgsSem;
+	static Semaphore		gdispDrainSem;
 	static Mutex			gdispMsgsMutex;
 	static gdisp_lld_msg_t	gdispMsgs[GDISP_QUEUE_SIZE];
 	static WORKING_AREA(waGDISPThread, GDISP_THREAD_STACK_SIZE);
@@ -103,7 +118,14 @@
 
 			/* Mark the message as free */
 			pmsg->action = GDISP_LLD_MSG_NOP;
-			chSemSignal(&gdispMsgsSem);
+			chSysLock();
+			chSemSignalI(&gdispMsgsSem);
+
+			/* Wake anyone in gdispLock() waiting for everything queued to be drawn */
+			if (chSemGetCounterI(&gdispMsgsSem) >= GDISP_QUEUE_SIZE)
+				chSemResetI(&gdispDrainSem, 0);
+			chSchRescheduleS();
+			chSysUnlock();
 		}
 		return 0;
 	}
@@ -169,6 +191,7 @@
 		chMtxInit(&gdispMutex);
 		chMtxInit(&gdispMsgsMutex);
 		chSemInit(&gdispMsgsSem, GDISP_QUEUE_SIZE);
+		chSemInit(&gdispDrainSem, 0);
 
 		lldThread = chThdCreateStatic(waGDISPThread, sizeof(waGDISPThread), NORMALPRIO, GDISPThreadHandler, NULL);
 
@@ -277,6 +300,50 @@
 		chMBPost(&gdispMailbox, (msg_t)p, TIME_INFINITE);
 	}
 #endif
+
+#if GDISP_NEED_MULTITHREAD
+	void gdispBlitMono(coord_t x, coord_t y, coord_t cx, coord_t cy, const uint8_t *bits, coord_t stride, color_t fg, color_t bg, bool_t transparent) {
+		chMtxLock(&gdispMutex);
+		gdisp_lld_blit_mono(x, y, cx, cy, bits, stride, fg, bg, transparent);
+		chMtxUnlock();
+	}
+#elif GDISP_NEED_ASYNC
+	void gdispBlitMono(coord_t x, coord_t y, coord_t cx, coord_t cy, const uint8_t *bits, coord_t stride, color_t fg, color_t bg, bool_t transparent) {
+		gdisp_lld_msg_t *p = gdispAllocMsg(GDISP_LLD_MSG_BLITMONO);
+		p->blitmono.x = x;
+		p->blitmono.y = y;
+		p->blitmono.cx = cx;
+		p->blitmono.cy = cy;
+		p->blitmono.bits = bits;
+		p->blitmono.stride = stride;
+		p->blitmono.fg = fg;
+		p->blitmono.bg = bg;
+		p->blitmono.transparent = transparent;
+		chMBPost(&gdispMailbox, (msg_t)p, TIME_INFINITE);
+	}
+#endif
+
+#if GDISP_NEED_MULTITHREAD
+	void gdispBlitAreaKeyed(coord_t x, coord_t y, coord_t cx, coord_t cy, coord_t srcx, coord_t srcy, coord_t srccx, const pixel_t *buffer, color_t keycolor) {
+		chMtxLock(&gdispMutex);
+		gdisp_lld_blit_area_keyed(x, y, cx, cy, srcx, srcy, srccx, buffer, keycolor);
+		chMtxUnlock();
+	}
+#elif GDISP_NEED_ASYNC
+	void gdispBlitAreaKeyed(coord_t x, coord_t y, coord_t cx, coord_t cy, coord_t srcx, coord_t srcy, coord_t srccx, const pixel_t *buffer, color_t keycolor) {
+		gdisp_lld_msg_t *p = gdispAllocMsg(GDISP_LLD_MSG_BLITAREAKEYED);
+		p->blitareakeyed.x = x;
+		p->blitareakeyed.y = y;
+		p->blitareakeyed.cx = cx;
+		p->blitareakeyed.cy = cy;
+		p->blitareakeyed.srcx = srcx;
+		p->blitareakeyed.srcy = srcy;
+		p->blitareakeyed.srccx = srccx;
+		p->blitareakeyed.buffer = buffer;
+		p->blitareakeyed.keycolor = keycolor;
+		chMBPost(&gdispMailbox, (msg_t)p, TIME_INFINITE);
+	}
+#endif
 	
 #if (GDISP_NEED_CLIP && GDISP_NEED_MULTITHREAD)
 	void gdispSetClip(coord_t x, coord_t y, coord_t cx, coord_t cy) {
@@ -404,49 +471,61 @@
 #endif
 
 #if GDISP_NEED_ARC
-void gdispDrawRoundedBox(coord_t x, coord_t y, coord_t cx, coord_t cy, coord_t radius, color_t color) {
+void gdispDrawRoundedBox_unsafe(coord_t x, coord_t y, coord_t cx, coord_t cy, coord_t radius, color_t color) {
 	if (2*radius > cx || 2*radius > cy) {
-		gdispDrawBox(x, y, cx, cy, color);
+		gdispDrawBox_unsafe(x, y, cx, cy, color);
 		return;
 	}
-	gdispDrawArc(x+radius, y+radius, radius, 90, 180, color);
-	gdispDrawLine(x+radius+1, y, x+cx-2-radius, y, color);
-	gdispDrawArc(x+cx-1-radius, y+radius, radius, 0, 90, color);
-	gdispDrawLine(x+cx-1, y+radius+1, x+cx-1, y+cy-2-radius, color);
-	gdispDrawArc(x+cx-1-radius, y+cy-1-radius, radius, 270, 360, color);
-	gdispDrawLine(x+radius+1, y+cy-1, x+cx-2-radius, y+cy-1, color);
-	gdispDrawArc(x+radius, y+cy-1-radius, radius, 180, 270, color);
-	gdispDrawLine(x, y+radius+1, x, y+cy-2-radius, color);
+	gdispDrawArc_unsafe(x+radius, y+radius, radius, 90, 180, color);
+	gdispDrawLine_unsafe(x+radius+1, y, x+cx-2-radius, y, color);
+	gdispDrawArc_unsafe(x+cx-1-radius, y+radius, radius, 0, 90, color);
+	gdispDrawLine_unsafe(x+cx-1, y+radius+1, x+cx-1, y+cy-2-radius, color);
+	gdispDrawArc_unsafe(x+cx-1-radius, y+cy-1-radius, radius, 270, 360, color);
+	gdispDrawLine_unsafe(x+radius+1, y+cy-1, x+cx-2-radius, y+cy-1, color);
+	gdispDrawArc_unsafe(x+radius, y+cy-1-radius, radius, 180, 270, color);
+	gdispDrawLine_unsafe(x, y+radius+1, x, y+cy-2-radius, color);
+}
+
+void gdispDrawRoundedBox(coord_t x, coord_t y, coord_t cx, coord_t cy, coord_t radius, color_t color) {
+	gdispLock();
+	gdispDrawRoundedBox_unsafe(x, y, cx, cy, radius, color);
+	gdispUnlock();
 }
 #endif
 
 #if GDISP_NEED_ARC
-void gdispFillRoundedBox(coord_t x, coord_t y, coord_t cx, coord_t cy, coord_t radius, color_t color) {
+void gdispFillRoundedBox_unsafe(coord_t x, coord_t y, coord_t cx, coord_t cy, coord_t radius, color_t color) {
 	coord_t radius2;
 
 	radius2 = radius*2;
 	if (radius2 > cx || radius2 > cy) {
-		gdispFillArea(x, y, cx, cy, color);
+		gdispFillArea_unsafe(x, y, cx, cy, color);
 		return;
 	}
-	gdispFillArc(x+radius, y+radius, radius, 90, 180, color);
-	gdispFillArea(x+radius+1, y, cx-radius2, radius, color);
-	gdispFillArc(x+cx-1-radius, y+radius, radius, 0, 90, color);
-	gdispFillArc(x+cx-1-radius, y+cy-1-radius, radius, 270, 360, color);
-	gdispFillArea(x+radius+1, y+cy-radius, cx-radius2, radius, color);
-	gdispFillArc(x+radius, y+cy-1-radius, radius, 180, 270, color);
-	gdispFillArea(x, y+radius, cx, cy-radius2, color);
+	gdispFillArc_unsafe(x+radius, y+radius, radius, 90, 180, color);
+	gdispFillArea_unsafe(x+radius+1, y, cx-radius2, radius, color);
+	gdispFillArc_unsafe(x+cx-1-radius, y+radius, radius, 0, 90, color);
+	gdispFillArc_unsafe(x+cx-1-radius, y+cy-1-radius, radius, 270, 360, color);
+	gdispFillArea_unsafe(x+radius+1, y+cy-radius, cx-radius2, radius, color);
+	gdispFillArc_unsafe(x+radius, y+cy-1-radius, radius, 180, 270, color);
+	gdispFillArea_unsafe(x, y+radius, cx, cy-radius2, color);
+}
+
+void gdispFillRoundedBox(coord_t x, coord_t y, coord_t cx, coord_t cy, coord_t radius, color_t color) {
+	gdispLock();
+	gdispFillRoundedBox_unsafe(x, y, cx, cy, radius, color);
+	gdispUnlock();
 }
 #endif
 
 #if (GDISP_NEED_TEXT && GDISP_NEED_MULTITHREAD)
-	void gdispDrawChar(coord_t x, coord_t y, char c, font_t font, color_t color) {
+	void gdispDrawChar(coord_t x, coord_t y, unicode_t c, font_t font, color_t color) {
 		chMtxLock(&gdispMutex);
 		gdisp_lld_draw_char(x, y, c, font, color);
 		chMtxUnlock();
 	}
 #elif GDISP_NEED_TEXT && GDISP_NEED_ASYNC
-	void gdispDrawChar(coord_t x, coord_t y, char c, font_t font, color_t color) {
+	void gdispDrawChar(coord_t x, coord_t y, unicode_t c, font_t font, color_t color) {
 		gdisp_lld_msg_t *p = gdispAllocMsg(GDISP_LLD_MSG_DRAWCHAR);
 		p->drawchar.x = x;
 		p->drawchar.y = y;
@@ -458,13 +537,13 @@ void gdispFillRoundedBox(coord_t x, coord_t y, coord_t cx, coord_t cy, coord_t r
 #endif
 
 #if (GDISP_NEED_TEXT && GDISP_NEED_MULTITHREAD)
-	void gdispFillChar(coord_t x, coord_t y, char c, font_t font, color_t color, color_t bgcolor) {
+	void gdispFillChar(coord_t x, coord_t y, unicode_t c, font_t font, color_t color, color_t bgcolor) {
 		chMtxLock(&gdispMutex);
 		gdisp_lld_fill_char(x, y, c, font, color, bgcolor);
 		chMtxUnlock();
 	}
 #elif GDISP_NEED_TEXT && GDISP_NEED_ASYNC
-	void gdispFillChar(coord_t x, coord_t y, char c, font_t font, color_t color, color_t bgcolor) {
+	void gdispFillChar(coord_t x, coord_t y, unicode_t c, font_t font, color_t color, color_t bgcolor) {
 		gdisp_lld_msg_t *p = gdispAllocMsg(GDISP_LLD_MSG_FILLCHAR);
 		p->fillchar.x = x;
 		p->fillchar.y = y;
@@ -487,6 +566,13 @@ void gdispFillRoundedBox(coord_t x, coord_t y, coord_t cx, coord_t cy, coord_t r
 
 		return c;
 	}
+
+	void gdispReadArea(coord_t x, coord_t y, coord_t cx, coord_t cy, pixel_t *buffer) {
+		/* Always synchronous and anything already queued must be drawn first */
+		gdispLock();
+		gdisp_lld_read_area(x, y, cx, cy, buffer);
+		gdispUnlock();
+	}
 #endif
 
 #if (GDISP_NEED_SCROLL && GDISP_NEED_MULTITHREAD)
@@ -508,6 +594,25 @@ void gdispFillRoundedBox(coord_t x, coord_t y, coord_t cx, coord_t cy, coord_t r
 	}
 #endif
 
+#if (GDISP_NEED_COPYAREA && GDISP_NEED_MULTITHREAD)
+	void gdispCopyArea(coord_t srcx, coord_t srcy, coord_t cx, coord_t cy, coord_t dstx, coord_t dsty) {
+		chMtxLock(&gdispMutex);
+		gdisp_lld_copy_area(srcx, srcy, cx, cy, dstx, dsty);
+		chMtxUnlock();
+	}
+#elif GDISP_NEED_COPYAREA && GDISP_NEED_ASYNC
+	void gdispCopyArea(coord_t srcx, coord_t srcy, coord_t cx, coord_t cy, coord_t dstx, coord_t dsty) {
+		gdisp_lld_msg_t *p = gdispAllocMsg(GDISP_LLD_MSG_COPYAREA);
+		p->copyarea.srcx = srcx;
+		p->copyarea.srcy = srcy;
+		p->copyarea.cx = cx;
+		p->copyarea.cy = cy;
+		p->copyarea.dstx = dstx;
+		p->copyarea.dsty = dsty;
+		chMBPost(&gdispMailbox, (msg_t)p, TIME_INFINITE);
+	}
+#endif
+
 #if (GDISP_NEED_CONTROL && GDISP_NEED_MULTITHREAD)
 	void gdispControl(unsigned what, void *value) {
 		chMtxLock(&gdispMutex);
@@ -535,12 +640,42 @@ void gdispFillRoundedBox(coord_t x, coord_t y, coord_t cx, coord_t cy, coord_t r
 	}
 #endif
 
+#if GDISP_NEED_MULTITHREAD
+	void gdispLock(void) {
+		chMtxLock(&gdispMutex);
+	}
+
+	void gdispUnlock(void) {
+		chMtxUnlock();
+	}
+#elif GDISP_NEED_ASYNC
+	void gdispLock(void) {
+		chMtxLock(&gdispMutex);
+
+		/* We can only draw directly once everything already queued has been drawn.
+		 *	The check and the wait are done together so the worker thread's wake up can't be missed.
+		 */
+		chSysLock();
+		while(chSemGetCounterI(&gdispMsgsSem) < GDISP_QUEUE_SIZE) {
+			chMtxUnlockS();
+			chSemWaitS(&gdispDrainSem);
+			chSysUnlock();
+			chMtxLock(&gdispMutex);
+			chSysLock();
+		}
+		chSysUnlock();
+	}
+
+	void gdispUnlock(void) {
+		chMtxUnlock();
+	}
+#endif
+
 /*===========================================================================*/
 /* High Level Driver Routines.                                               */
 /*===========================================================================*/
 
-void gdispDrawBox(coord_t x, coord_t y, coord_t cx, coord_t cy, color_t color) {
-	/* No mutex required as we only call high level functions which have their own mutex */
+void gdispDrawBox_unsafe(coord_t x, coord_t y, coord_t cx, coord_t cy, color_t color) {
 	coord_t	x1, y1;
 
 	x1 = x+cx-1;
@@ -548,34 +683,46 @@ void gdispDrawBox(coord_t x, coord_t y, coord_t cx, coord_t cy, color_t color) {
 
 	if (cx > 2) {
 		if (cy >= 1) {
-			gdispDrawLine(x, y, x1, y, color);
+			gdispDrawLine_unsafe(x, y, x1, y, color);
 			if (cy >= 2) {
-				gdispDrawLine(x, y1, x1, y1, color);
+				gdispDrawLine_unsafe(x, y1, x1, y1, color);
 				if (cy > 2) {
-					gdispDrawLine(x, y+1, x, y1-1, color);
-					gdispDrawLine(x1, y+1, x1, y1-1, color);
+					gdispDrawLine_unsafe(x, y+1, x, y1-1, color);
+					gdispDrawLine_unsafe(x1, y+1, x1, y1-1, color);
 				}
 			}
 		}
 	} else if (cx == 2) {
-		gdispDrawLine(x, y, x, y1, color);
-		gdispDrawLine(x1, y, x1, y1, color);
+		gdispDrawLine_unsafe(x, y, x, y1, color);
+		gdispDrawLine_unsafe(x1, y, x1, y1, color);
 	} else if (cx == 1) {
-		gdispDrawLine(x, y, x, y1, color);
+		gdispDrawLine_unsafe(x, y, x, y1, color);
 	}
 }
 
+void gdispDrawBox(coord_t x, coord_t y, coord_t cx, coord_t cy, color_t color) {
+	gdispLock();
+	gdispDrawBox_unsafe(x, y, cx, cy, color);
+	gdispUnlock();
+}
+
 #if GDISP_NEED_CONVEX_POLYGON
-	void gdispDrawPoly(coord_t tx, coord_t ty, const point *pntarray, unsigned cnt, color_t color) {
+	void gdispDrawPoly_unsafe(coord_t tx, coord_t ty, const point *pntarray, unsigned cnt, color_t color) {
 		const point	*epnt, *p;
 
 		epnt = &pntarray[cnt-1];
 		for(p = pntarray; p < epnt; p++)
-			gdispDrawLine(tx+p->x, ty+p->y, tx+p[1].x, ty+p[1].y, color);
-		gdispDrawLine(tx+p->x, ty+p->y, tx+pntarray->x, ty+pntarray->y, color);
+			gdispDrawLine_unsafe(tx+p->x, ty+p->y, tx+p[1].x, ty+p[1].y, color);
+		gdispDrawLine_unsafe(tx+p->x, ty+p->y, tx+pntarray->x, ty+pntarray->y, color);
 	}
 
-	void gdispFillConvexPoly(coord_t tx, coord_t ty, const point *pntarray, unsigned cnt, color_t color) {
+	void gdispDrawPoly(coord_t tx, coord_t ty, const point *pntarray, unsigned cnt, color_t color) {
+		gdispLock();
+		gdispDrawPoly_unsafe(tx, ty, pntarray, cnt, color);
+		gdispUnlock();
+	}
+
+	void gdispFillConvexPoly_unsafe(coord_t tx, coord_t ty, const point *pntarray, unsigned cnt, color_t color) {
 		const point	*lpnt, *rpnt, *epnts;
 		fpcoord_t	lx, rx, lk, rk;
 		coord_t		y, ymax, lxc, rxc;
@@ -622,14 +769,14 @@ void gdispDrawBox(coord_t x, coord_t y, coord_t cx, coord_t cy, color_t color) {
 				 */
 				if (lxc < rxc) {
 					if (rxc - lxc == 1)
-						gdispDrawPixel(tx+lxc, ty+y, color);
+						gdispDrawPixel_unsafe(tx+lxc, ty+y, color);
 					else
-						gdispDrawLine(tx+lxc, ty+y, tx+rxc-1, ty+y, color);
+						gdispDrawLine_unsafe(tx+lxc, ty+y, tx+rxc-1, ty+y, color);
 				} else if (lxc > rxc) {
 					if (lxc - rxc == 1)
-						gdispDrawPixel(tx+rxc, ty+y, color);
+						gdispDrawPixel_unsafe(tx+rxc, ty+y, color);
 					else
-						gdispDrawLine(tx+rxc, ty+y, tx+lxc-1, ty+y, color);
+						gdispDrawLine_unsafe(tx+rxc, ty+y, tx+lxc-1, ty+y, color);
 				}
 
 				lx += lk;
@@ -658,13 +805,581 @@ void gdispDrawBox(coord_t x, coord_t y, coord_t cx, coord_t cy, color_t color) {
 			}
 		}
 	}
+
+	void gdispFillConvexPoly(coord_t tx, coord_t ty, const point *pntarray, unsigned cnt, color_t color) {
+		gdispLock();
+		gdispFillConvexPoly_unsafe(tx, ty, pntarray, cnt, color);
+		gdispUnlock();
+	}
+#endif
+
+#if GDISP_NEED_GRADIENT
+	/* Fill a buffer with cnt colors from position pos along a ramp of len pixels from c0 to c1 */
+	static void gradient_span(pixel_t *buf, coord_t cnt, coord_t pos, coord_t len, color_t c0, color_t c1) {
+		fpcoord_t	r, g, b, dr, dg, db;
+		coord_t		i;
+
+		if (len > 1) {
+			dr = COORD2FP(RED_OF(c1) - RED_OF(c0)) / (len-1);
+			dg = COORD2FP(GREEN_OF(c1) - GREEN_OF(c0)) / (len-1);
+			db = COORD2FP(BLUE_OF(c1) - BLUE_OF(c0)) / (len-1);
+		} else
+			dr = dg = db = 0;
+		r = COORD2FP(RED_OF(c0)) + 0x8000 + dr * pos;
+		g = COORD2FP(GREEN_OF(c0)) + 0x8000 + dg * pos;
+		b = COORD2FP(BLUE_OF(c0)) + 0x8000 + db * pos;
+
+		for(i = 0; i < cnt; i++, r += dr, g += dg, b += db)
+			gdispPackPixels(buf, cnt, i, 0, RGB2COLOR(FP2COORD(r), FP2COORD(g), FP2COORD(b)));
+	}
+
+	/* The color at position pos along a ramp of len pixels from c0 to c1 */
+	static color_t gradient_color(coord_t pos, coord_t len, color_t c0, color_t c1) {
+		if (len <= 1)
+			return c0;
+		return RGB2COLOR(
+			RED_OF(c0) + ((int)RED_OF(c1) - (int)RED_OF(c0)) * pos / (len-1),
+			GREEN_OF(c0) + ((int)GREEN_OF(c1) - (int)GREEN_OF(c0)) * pos / (len-1),
+			BLUE_OF(c0) + ((int)BLUE_OF(c1) - (int)BLUE_OF(c0)) * pos / (len-1));
+	}
+
+	/* Draw part of a line of a horizontal gradient using the line buffer */
+	static void gradient_hline(coord_t x, coord_t y, coord_t cx, coord_t pos, coord_t len, color_t c0, color_t c1) {
+		coord_t		n;
+
+		while(cx > 0) {
+			n = cx > GDISP_LINEBUF_SIZE ? GDISP_LINEBUF_SIZE : cx;
+			gradient_span(gdispLineBuf, n, pos, len, c0, c1);
+			gdisp_lld_blit_area_ex(x, y, n, 1, 0, 0, n, gdispLineBuf);
+			x += n;
+			pos += n;
+			cx -= n;
+		}
+	}
+
+	void gdispFillAreaGradient_unsafe(coord_t x, coord_t y, coord_t cx, coord_t cy, gradient_t direction, color_t c0, color_t c1) {
+		color_t		c, lastc;
+		coord_t		j, lasty;
+
+		if (cx <= 0 || cy <= 0) return;
+
+		if (direction == gradientVertical) {
+			/* Each line is a single color - rows that end up the same color are filled together */
+			lastc = c0;
+			lasty = 0;
+			for(j = 1; j < cy; j++) {
+				c = gradient_color(j, cy, c0, c1);
+				if (c != lastc) {
+					gdisp_lld_fill_area(x, y+lasty, cx, j-lasty, lastc);
+					lastc = c;
+					lasty = j;
+				}
+			}
+			gdisp_lld_fill_area(x, y+lasty, cx, cy-lasty, lastc);
+			return;
+		}
+
+		/* Every line is the same so if it fits in the line buffer it only needs to be calculated once */
+		if (cx <= GDISP_LINEBUF_SIZE) {
+			gradient_span(gdispLineBuf, cx, 0, cx, c0, c1);
+			for(j = 0; j < cy; j++)
+				gdisp_lld_blit_area_ex(x, y+j, cx, 1, 0, 0, cx, gdispLineBuf);
+			return;
+		}
+		for(j = 0; j < cy; j++)
+			gradient_hline(x, y+j, cx, 0, cx, c0, c1);
+	}
+
+	void gdispFillAreaGradient(coord_t x, coord_t y, coord_t cx, coord_t cy, gradient_t direction, color_t c0, color_t c1) {
+		gdispLock();
+		gdispFillAreaGradient_unsafe(x, y, cx, cy, direction, c0, c1);
+		gdispUnlock();
+	}
+
+	void gdispFillAreaGradientPoints_unsafe(coord_t x, coord_t y, coord_t cx, coord_t cy, coord_t x0, coord_t y0, color_t c0, coord_t x1, coord_t y1, color_t c1) {
+		int32_t		dx, dy, len2;
+		int64_t		t, tstep;
+		int32_t		r0, g0, b0, dr, dg, db, f;
+		coord_t		i, j, n, s;
+		color_t		c;
+
+		if (cx <= 0 || cy <= 0) return;
+
+		/* Degenerate - just a fill */
+		dx = x1 - x0;
+		dy = y1 - y0;
+		len2 = dx*dx + dy*dy;
+		if (!len2) {
+			gdisp_lld_fill_area(x, y, cx, cy, c0);
+			return;
+		}
+
+		r0 = RED_OF(c0); dr = (int)RED_OF(c1) - r0;
+		g0 = GREEN_OF(c0); dg = (int)GREEN_OF(c1) - g0;
+		b0 = BLUE_OF(c0); db = (int)BLUE_OF(c1) - b0;
+
+		/* The position along the gradient (0 to 1 in 32.32) changes by a constant amount for each pixel across */
+		tstep = ((int64_t)dx << 32) / len2;
+		for(j = 0; j < cy; j++) {
+			for(s = 0; s < cx; s += n) {
+				n = cx - s > GDISP_LINEBUF_SIZE ? GDISP_LINEBUF_SIZE : cx - s;
+				t = ((int64_t)((x+s-x0)*dx + (y+j-y0)*dy) << 32) / len2;
+				for(i = 0; i < n; i++, t += tstep) {
+					if (t <= 0)
+						c = c0;
+					else if (t >= ((int64_t)1 << 32))
+						c = c1;
+					else {
+						f = (int32_t)(t >> 16);
+						c = RGB2COLOR(r0 + ((dr * f + 0x8000) >> 16), g0 + ((dg * f + 0x8000) >> 16), b0 + ((db * f + 0x8000) >> 16));
+					}
+					gdispPackPixels(gdispLineBuf, n, i, 0, c);
+				}
+				gdisp_lld_blit_area_ex(x+s, y+j, n, 1, 0, 0, n, gdispLineBuf);
+			}
+		}
+	}
+
+	void gdispFillAreaGradientPoints(coord_t x, coord_t y, coord_t cx, coord_t cy, coord_t x0, coord_t y0, color_t c0, coord_t x1, coord_t y1, color_t c1) {
+		gdispLock();
+		gdispFillAreaGradientPoints_unsafe(x, y, cx, cy, x0, y0, c0, x1, y1, c1);
+		gdispUnlock();
+	}
+
+	/* Integer square root */
+	static coord_t isqrt(uint32_t n) {
+		uint32_t	res, bit;
+
+		res = 0;
+		for(bit = 1UL << 30; bit > n; bit >>= 2);
+		for(; bit; bit >>= 2) {
+			if (n >= res + bit) {
+				n -= res + bit;
+				res = (res >> 1) + bit;
+			} else
+				res >>= 1;
+		}
+		return (coord_t)res;
+	}
+
+	void gdispFillRoundedBoxGradient_unsafe(coord_t x, coord_t y, coord_t cx, coord_t cy, coord_t radius, gradient_t direction, color_t c0, color_t c1) {
+		coord_t		j, dy, inset;
+		uint32_t	r2;
+
+		if (cx <= 0 || cy <= 0) return;
+		if (2*radius > cx) radius = cx/2;
+		if (2*radius > cy) radius = cy/2;
+		r2 = (uint32_t)radius * radius;
+
+		for(j = 0; j < cy; j++) {
+			/* How far is this line into a rounded corner */
+			if (j < radius)
+				dy = radius - j;
+			else if (j > cy-1-radius)
+				dy = j - (cy-1-radius);
+			else
+				dy = 0;
+			inset = dy ? radius - isqrt(r2 - (uint32_t)dy * dy) : 0;
+
+			if (direction == gradientVertical)
+				gdisp_lld_fill_area(x+inset, y+j, cx-2*inset, 1, gradient_color(j, cy, c0, c1));
+			else
+				gradient_hline(x+inset, y+j, cx-2*inset, inset, cx, c0, c1);
+		}
+	}
+
+	void gdispFillRoundedBoxGradient(coord_t x, coord_t y, coord_t cx, coord_t cy, coord_t radius, gradient_t direction, color_t c0, color_t c1) {
+		gdispLock();
+		gdispFillRoundedBoxGradient_unsafe(x, y, cx, cy, radius, direction, c0, c1);
+		gdispUnlock();
+	}
+#endif
+
+#if GDISP_NEED_PATTERN
+	/* Draw an area a line at a time from a line of pattern in the line buffer.
+	 *	The line buffer is a whole number of pattern repeats so it can be re-used across the line.
+	 */
+	static void pattern_lines(coord_t x, coord_t y, coord_t cx, coord_t cy, const void *pattern, bool_t mono, color_t fg, color_t bg) {
+		coord_t		i, j, n, s;
+		uint8_t		bits;
+
+		n = cx > (GDISP_LINEBUF_SIZE & ~7) ? (GDISP_LINEBUF_SIZE & ~7) : cx;
+		for(j = 0; j < cy; j++) {
+			/* The pattern is anchored to the screen so that adjacent fills line up */
+			if (mono) {
+				bits = ((const uint8_t *)pattern)[(y+j) & 7];
+				for(i = 0; i < n; i++)
+					gdispPackPixels(gdispLineBuf, n, i, 0, (bits & (0x80 >> ((x+i) & 7))) ? fg : bg);
+			} else {
+				for(i = 0; i < n; i++)
+					gdispPackPixels(gdispLineBuf, n, i, 0, ((const pixel_t *)pattern)[((y+j) & 7) * 8 + ((x+i) & 7)]);
+			}
+			for(s = 0; s < cx; s += n)
+				gdisp_lld_blit_area_ex(x+s, y+j, cx - s > n ? n : cx - s, 1, 0, 0, n, gdispLineBuf);
+		}
+	}
+
+	void gdispFillAreaPattern_unsafe(coord_t x, coord_t y, coord_t cx, coord_t cy, const uint8_t *pattern, color_t fg, color_t bg) {
+		if (cx <= 0 || cy <= 0) return;
+		pattern_lines(x, y, cx, cy, pattern, TRUE, fg, bg);
+	}
+
+	void gdispFillAreaPattern(coord_t x, coord_t y, coord_t cx, coord_t cy, const uint8_t *pattern, color_t fg, color_t bg) {
+		gdispLock();
+		gdispFillAreaPattern_unsafe(x, y, cx, cy, pattern, fg, bg);
+		gdispUnlock();
+	}
+
+	void gdispFillAreaPatternColor_unsafe(coord_t x, coord_t y, coord_t cx, coord_t cy, const pixel_t *pattern) {
+		if (cx <= 0 || cy <= 0) return;
+		pattern_lines(x, y, cx, cy, pattern, FALSE, 0, 0);
+	}
+
+	void gdispFillAreaPatternColor(coord_t x, coord_t y, coord_t cx, coord_t cy, const pixel_t *pattern) {
+		gdispLock();
+		gdispFillAreaPatternColor_unsafe(x, y, cx, cy, pattern);
+		gdispUnlock();
+	}
+#endif
+
+#if GDISP_NEED_SCALE
+	#if GDISP_PACKED_PIXELS
+		#error "GDISP: Scaled blits do not support packed pixel formats"
+	#endif
+
+	/* Calculate a scaled line into buf.
+	 *	row0 and row1 are the source lines above and below the sample point and fy (0 to 255) is the weight of row1.
+	 */
+	static void scale_line(pixel_t *buf, coord_t cnt, fpcoord_t sx, fpcoord_t dx, const pixel_t *row0, const pixel_t *row1, unsigned fy, coord_t srccx2, scalemode_t mode) {
+		coord_t		i, x0, x1;
+		unsigned	fx, w00, w01, w10, w11;
+		color_t		c00, c01, c10, c11;
+
+		if (mode == scaleNearest) {
+			for(i = 0; i < cnt; i++, sx += dx)
+				buf[i] = row0[FP2COORD(sx)];
+			return;
+		}
+
+		for(i = 0; i < cnt; i++, sx += dx) {
+			if (sx <= 0) {
+				x0 = x1 = 0;
+				fx = 0;
+			} else {
+				x0 = FP2COORD(sx);
+				x1 = x0+1 < srccx2 ? x0+1 : x0;
+				fx = (sx >> 8) & 0xFF;
+			}
+			c00 = row0[x0]; c01 = row0[x1];
+			c10 = row1[x0]; c11 = row1[x1];
+
+			/* Nothing to blend - this is very common in flat areas of an image */
+			if (c00 == c01 && c00 == c10 && c00 == c11) {
+				buf[i] = c00;
+				continue;
+			}
+			w00 = (256-fx)*(256-fy); w01 = fx*(256-fy);
+			w10 = (256-fx)*fy; w11 = fx*fy;
+			buf[i] = RGB2COLOR(
+				(RED_OF(c00)*w00 + RED_OF(c01)*w01 + RED_OF(c10)*w10 + RED_OF(c11)*w11 + 0x8000) >> 16,
+				(GREEN_OF(c00)*w00 + GREEN_OF(c01)*w01 + GREEN_OF(c10)*w10 + GREEN_OF(c11)*w11 + 0x8000) >> 16,
+				(BLUE_OF(c00)*w00 + BLUE_OF(c01)*w01 + BLUE_OF(c10)*w10 + BLUE_OF(c11)*w11 + 0x8000) >> 16);
+		}
+	}
+
+	void gdispBlitAreaScaled_unsafe(coord_t x, coord_t y, coord_t cx, coord_t cy, coord_t srcx, coord_t srcy, coord_t srccx2, coord_t srccy2, coord_t srccx, const pixel_t *buffer, scalemode_t mode) {
+		fpcoord_t		dx, dy, sx0, sy, lastsy;
+		coord_t			i0, i1, n, lines, y0, s;
+		const pixel_t	*row0, *row1;
+		unsigned		fy;
+
+		if (cx <= 0 || cy <= 0 || srccx2 <= 0 || srccy2 <= 0) return;
+
+		/* The source step per destination pixel. Samples are taken at pixel centers. */
+		dx = COORD2FP(srccx2) / cx;
+		dy = COORD2FP(srccy2) / cy;
+		sx0 = dx/2;
+		sy = dy/2;
+		if (mode == scaleBilinear) {
+			sx0 -= 0x8000;
+			sy -= 0x8000;
+		}
+
+		/* Don't calculate anything that will be clipped anyway */
+		i0 = 0; i1 = cx;
+		#if GDISP_NEED_VALIDATION || GDISP_NEED_CLIP
+			if (x < GDISP.clipx0) i0 = GDISP.clipx0 - x;
+			if (x+cx > GDISP.clipx1) i1 = GDISP.clipx1 - x;
+			if (y < GDISP.clipy0) { n = GDISP.clipy0 - y; sy += dy*n; y += n; cy -= n; }
+			if (y+cy > GDISP.clipy1) cy = GDISP.clipy1 - y;
+			if (i0 >= i1 || cy <= 0) return;
+		#endif
+		x += i0;
+		sx0 += dx*i0;
+		cx = i1 - i0;
+
+		/* Lines too long for the line buffer are calculated and sent in pieces */
+		if (cx > GDISP_LINEBUF_SIZE) {
+			for(; cy; cy--, y++, sy += dy) {
+				fy = sy <= 0 ? 0 : (sy >> 8) & 0xFF;
+				row0 = buffer + (srcy + (sy <= 0 ? 0 : FP2COORD(sy))) * srccx + srcx;
+				row1 = sy <= 0 || FP2COORD(sy)+1 >= srccy2 ? row0 : row0 + srccx;
+				for(s = 0; s < cx; s += n) {
+					n = cx - s > GDISP_LINEBUF_SIZE ? GDISP_LINEBUF_SIZE : cx - s;
+					scale_line(gdispLineBuf, n, sx0 + dx*s, dx, row0, row1, fy, srccx2, mode);
+					gdisp_lld_blit_area_ex(x+s, y, n, 1, 0, 0, n, gdispLineBuf);
+				}
+			}
+			return;
+		}
+
+		/* Otherwise as many lines as fit are built up in the line buffer and sent together.
+		 *	A line sampled from the same place as the line before is just copied.
+		 *	The line before is always the last line in the buffer when starting a new block.
+		 */
+		lines = GDISP_LINEBUF_SIZE / cx;
+		lastsy = -COORD2FP(2);
+		while(cy) {
+			y0 = y;
+			for(n = 0; n < lines && cy; n++, cy--, y++, sy += dy) {
+				if (mode == scaleNearest ? FP2COORD(sy) == FP2COORD(lastsy) : sy == lastsy) {
+					s = n ? n-1 : lines-1;
+					if (s != n)
+						memcpy(gdispLineBuf + n*cx, gdispLineBuf + s*cx, cx * sizeof(pixel_t));
+					continue;
+				}
+				fy = sy <= 0 ? 0 : (sy >> 8) & 0xFF;
+				row0 = buffer + (srcy + (sy <= 0 ? 0 : FP2COORD(sy))) * srccx + srcx;
+				row1 = sy <= 0 || FP2COORD(sy)+1 >= srccy2 ? row0 : row0 + srccx;
+				scale_line(gdispLineBuf + n*cx, cx, sx0, dx, row0, row1, fy, srccx2, mode);
+				lastsy = sy;
+			}
+			gdisp_lld_blit_area_ex(x, y0, cx, n, 0, 0, cx, gdispLineBuf);
+		}
+	}
+
+	void gdispBlitAreaScaled(coord_t x, coord_t y, coord_t cx, coord_t cy, coord_t srcx, coord_t srcy, coord_t srccx2, coord_t srccy2, coord_t srccx, const pixel_t *buffer, scalemode_t mode) {
+		gdispLock();
+		gdispBlitAreaScaled_unsafe(x, y, cx, cy, srcx, srcy, srccx2, srccy2, srccx, buffer, mode);
+		gdispUnlock();
+	}
+#endif
+
+#if GDISP_NEED_ROTATE
+	#if GDISP_PACKED_PIXELS
+		#error "GDISP: Rotated blits do not support packed pixel formats"
+	#endif
+
+	/* sin() for 0 to 90 degrees in 16.16 fixed point */
+	static const fpcoord_t rotate_sintable[91] = {
+		0, 1144, 2287, 3430, 4572, 5712, 6850, 7987,
+		9121, 10252, 11380, 12505, 13626, 14742, 15855, 16962,
+		18064, 19161, 20252, 21336, 22415, 23486, 24550, 25607,
+		26656, 27697, 28729, 29753, 30767, 31772, 32768, 33754,
+		34729, 35693, 36647, 37590, 38521, 39441, 40348, 41243,
+		42126, 42995, 43852, 44695, 45525, 46341, 47143, 47930,
+		48703, 49461, 50203, 50931, 51643, 52339, 53020, 53684,
+		54332, 54963, 55578, 56175, 56756, 57319, 57865, 58393,
+		58903, 59396, 59870, 60326, 60764, 61183, 61584, 61966,
+		62328, 62672, 62997, 63303, 63589, 63856, 64104, 64332,
+		64540, 64729, 64898, 65048, 65177, 65287, 65376, 65446,
+		65496, 65526, 65536
+	};
+
+	static fpcoord_t rotate_sin(coord_t angle) {
+		angle %= 360;
+		if (angle < 0) angle += 360;
+		if (angle <= 90)	return rotate_sintable[angle];
+		if (angle <= 180)	return rotate_sintable[180-angle];
+		if (angle <= 270)	return -rotate_sintable[angle-180];
+		return -rotate_sintable[360-angle];
+	}
+
+	/* a/b rounded towards negative infinity (b > 0) */
+	static int64_t rotate_floordiv(int64_t a, int64_t b) {
+		return a >= 0 ? a / b : -((b - 1 - a) / b);
+	}
+
+	/* Narrow the span [*lo, *hi) so that 0 <= s + i*ds < lim for every i in it.
+	 *	s is 64 bits as the start of a line can be a long way outside a large bitmap.
+	 */
+	static void rotate_limit(coord_t *lo, coord_t *hi, int64_t s, fpcoord_t ds, fpcoord_t lim) {
+		int64_t		l, h;
+
+		if (!ds) {
+			if (s < 0 || s >= lim)
+				*hi = *lo;
+			return;
+		}
+		if (ds > 0) {
+			l = -rotate_floordiv(s, ds);
+			h = -rotate_floordiv(s - lim, ds);
+		} else {
+			l = rotate_floordiv(s - lim, -ds) + 1;
+			h = rotate_floordiv(s, -ds) + 1;
+		}
+		/* Clamp before narrowing - the quotients can be far outside a coord_t */
+		if (l > *lo) *lo = l > *hi ? *hi : (coord_t)l;
+		if (h < *hi) *hi = h < *lo ? *lo : (coord_t)h;
+	}
+
+	void gdispBlitAreaRotated_unsafe(coord_t x, coord_t y, coord_t srccx, coord_t srccy, const pixel_t *buffer, coord_t px, coord_t py, coord_t angle) {
+		fpcoord_t		sn, cs, u, v, lx, ly;
+		int64_t			u0, v0;
+		coord_t			x0, x1, y0, y1, lo, hi, i, j, k, n;
+		int32_t			ex[2], ey[2], bx0, bx1, by0, by1, b;
+
+		if (srccx <= 0 || srccy <= 0) return;
+
+		sn = rotate_sin(angle);
+		cs = rotate_sin(angle+90);
+
+		/* The bounding box of the rotated bitmap.
+		 *	The edges of the bitmap are on half pixels so everything here is in half pixel units.
+		 */
+		ex[0] = -2*px - 1; ex[1] = 2*(srccx-px) - 1;
+		ey[0] = -2*py - 1; ey[1] = 2*(srccy-py) - 1;
+		bx0 = by0 = 0x7FFFFFFF;
+		bx1 = by1 = -0x7FFFFFFF;
+		for(i = 0; i < 4; i++) {
+			b = (int32_t)((((int64_t)cs * ex[i&1] + (int64_t)sn * ey[i>>1]) >> 16) >> 1);
+			if (b < bx0) bx0 = b;
+			if (b+1 > bx1) bx1 = b+1;
+			b = (int32_t)((((int64_t)cs * ey[i>>1] - (int64_t)sn * ex[i&1]) >> 16) >> 1);
+			if (b < by0) by0 = b;
+			if (b+1 > by1) by1 = b+1;
+		}
+		bx0 += x; bx1 += x + 1;
+		by0 += y; by1 += y + 1;
+		#if GDISP_NEED_VALIDATION || GDISP_NEED_CLIP
+			if (bx0 < GDISP.clipx0) bx0 = GDISP.clipx0;
+			if (by0 < GDISP.clipy0) by0 = GDISP.clipy0;
+			if (bx1 > GDISP.clipx1) bx1 = GDISP.clipx1;
+			if (by1 > GDISP.clipy1) by1 = GDISP.clipy1;
+		#else
+			if (bx0 < -32768) bx0 = -32768;
+			if (by0 < -32768) by0 = -32768;
+			if (bx1 > 32767) bx1 = 32767;
+			if (by1 > 32767) by1 = 32767;
+		#endif
+		if (bx0 >= bx1 || by0 >= by1) return;
+		x0 = bx0; x1 = bx1;
+		y0 = by0; y1 = by1;
+
+		/* Inverse map each line back into the bitmap. Moving one pixel across the screen
+		 *	always moves the same amount in the bitmap so only the start of each line needs calculating.
+		 *	Sample points are offset by half a pixel so that rounding is just truncation.
+		 */
+		lx = COORD2FP(srccx);
+		ly = COORD2FP(srccy);
+		for(j = y0; j < y1; j++) {
+			u0 = (int64_t)cs * (x0-x) - (int64_t)sn * (j-y) + COORD2FP(px) + 0x8000;
+			v0 = (int64_t)sn * (x0-x) + (int64_t)cs * (j-y) + COORD2FP(py) + 0x8000;
+
+			/* The part of this line that lands inside the bitmap */
+			lo = 0;
+			hi = x1 - x0;
+			rotate_limit(&lo, &hi, u0, cs, lx);
+			rotate_limit(&lo, &hi, v0, sn, ly);
+			if (lo >= hi)
+				continue;
+
+			/* From here on everything is inside the bitmap so it fits in a fpcoord_t */
+			u = (fpcoord_t)(u0 + (int64_t)cs * lo);
+			v = (fpcoord_t)(v0 + (int64_t)sn * lo);
+			for(i = lo; i < hi; i += n) {
+				n = hi - i > GDISP_LINEBUF_SIZE ? GDISP_LINEBUF_SIZE : hi - i;
+				for(k = 0; k < n; k++, u += cs, v += sn)
+					gdispLineBuf[k] = buffer[FP2COORD(v) * srccx + FP2COORD(u)];
+				gdisp_lld_blit_area_ex(x0+i, j, n, 1, 0, 0, n, gdispLineBuf);
+			}
+		}
+	}
+
+	void gdispBlitAreaRotated(coord_t x, coord_t y, coord_t srccx, coord_t srccy, const pixel_t *buffer, coord_t px, coord_t py, coord_t angle) {
+		gdispLock();
+		gdispBlitAreaRotated_unsafe(x, y, srccx, srccy, buffer, px, py, angle);
+		gdispUnlock();
+	}
+#endif
+
+#if GDISP_NEED_TEXT && GDISP_NEED_TEXT_BLIT
+	static fontramp_t	stringRamp;
+
+	/*
+	 * Fill the area x, y, cx x font height with bgcolor and the string starting at tx.
+	 * Characters that don't completely fit before x+cx are not drawn.
+	 * Each piece of GDISP_TEXT_BLIT_SIZE pixels is expanded into the line buffer and sent with a single blit.
+	 */
+	static void blitString(coord_t x, coord_t y, coord_t cx, coord_t tx, const char *str, font_t font, color_t color, color_t bgcolor) {
+		const char		*s;
+		const color_t	*ramp;
+		coord_t			h, p, w, ex, bx, bcx, pcx, xpos, i, j;
+		unicode_t		c;
+		int				first;
+
+		h = font->height * font->yscale;
+		p = font->charPadding * font->xscale;
+		ex = x + cx;
+
+		#if GDISP_NEED_VALIDATION || GDISP_NEED_CLIP
+			if (y >= GDISP.clipy1 || y+h <= GDISP.clipy0) return;
+			bx = x < GDISP.clipx0 ? GDISP.clipx0 : x;
+			bcx = (ex > GDISP.clipx1 ? GDISP.clipx1 : ex) - bx;
+		#else
+			bx = x;
+			bcx = cx;
+		#endif
+		if (bcx <= 0) return;
+
+		ramp = fontGetRamp(&stringRamp, font->bpp, color, bgcolor);
+		pcx = GDISP_TEXT_BLIT_SIZE / h;
+		for(; bcx > 0; bx += pcx, bcx -= pcx) {
+			if (pcx > bcx)
+				pcx = bcx;
+
+			/* The background */
+			for(j = 0; j < h; j++)
+				for(i = 0; i < pcx; i++)
+					gdispPackPixels(gdispLineBuf, pcx, i, j, bgcolor);
+
+			/* The characters that overlap this piece */
+			s = str;
+			xpos = tx;
+			first = 1;
+			while(*s && xpos < bx+pcx) {
+				/* Get the next printable character */
+				c = _getStringChar(s);
+				w = _getCharWidth(font, c) * font->xscale;
+				if (!w) continue;
+
+				/* Handle inter-character padding */
+				if (p) {
+					if (!first)
+						xpos += p;
+					else
+						first = 0;
+				}
+
+				/* Expand the visible part of the character */
+				if (xpos + w > ex) break;
+				if (xpos + w > bx && xpos < bx+pcx) {
+					i = xpos < bx ? bx - xpos : 0;
+					fontExpandChar(gdispLineBuf, pcx, xpos + i - bx, c, font, i,
+						(xpos + w > bx+pcx ? bx+pcx - xpos : w) - i, ramp);
+				}
+				xpos += w;
+			}
+
+			gdispBlitAreaEx_unsafe(bx, y, pcx, h, 0, 0, pcx, gdispLineBuf);
+		}
+	}
 #endif
 
 	#if GDISP_NEED_TEXT
-	void gdispDrawString(coord_t x, coord_t y, const char *str, font_t font, color_t color) {
-		/* No mutex required as we only call high level functions which have their own mutex */
+	void gdispDrawString_unsafe(coord_t x, coord_t y, const char *str, font_t font, color_t color) {
 		coord_t		w, p;
-		char		c;
+		unicode_t	c;
 		int			first;
 		
 		if (!str) return;
@@ -673,7 +1388,7 @@ void gdispDrawBox(coord_t x, coord_t y, coord_t cx, coord_t cy, color_t color) {
 		p = font->charPadding * font->xscale;
 		while(*str) {
 			/* Get the next printable character */
-			c = *str++;
+			c = _getStringChar(str);
 			w = _getCharWidth(font, c) * font->xscale;
 			if (!w) continue;
 			
@@ -686,17 +1401,22 @@ void gdispDrawBox(coord_t x, coord_t y, coord_t cx, coord_t cy, color_t color) {
 			}
 			
 			/* Print the character */
-			gdispDrawChar(x, y, c, font, color);
+			gdispDrawChar_unsafe(x, y, c, font, color);
 			x += w;
 		}
 	}
+
+	void gdispDrawString(coord_t x, coord_t y, const char *str, font_t font, color_t color) {
+		gdispLock();
+		gdispDrawString_unsafe(x, y, str, font, color);
+		gdispUnlock();
+	}
 #endif
 	
 #if GDISP_NEED_TEXT
-	void gdispFillString(coord_t x, coord_t y, const char *str, font_t font, color_t color, color_t bgcolor) {
-		/* No mutex required as we only call high level functions which have their own mutex */
+	void gdispFillString_unsafe(coord_t x, coord_t y, const char *str, font_t font, color_t color, color_t bgcolor) {
 		coord_t		w, h, p;
-		char		c;
+		unicode_t	c;
 		int			first;
 		
 		if (!str) return;
@@ -704,35 +1424,49 @@ void gdispDrawBox(coord_t x, coord_t y, coord_t cx, coord_t cy, color_t color) {
 		first = 1;
 		h = font->height * font->yscale;
 		p = font->charPadding * font->xscale;
+
+		#if GDISP_NEED_TEXT_BLIT
+			/* Send the whole string in one go */
+			if (h <= GDISP_TEXT_BLIT_SIZE) {
+				blitString(x, y, gdispGetStringWidth(str, font), x, str, font, color, bgcolor);
+				return;
+			}
+		#endif
+
 		while(*str) {
 			/* Get the next printable character */
-			c = *str++;
+			c = _getStringChar(str);
 			w = _getCharWidth(font, c) * font->xscale;
 			if (!w) continue;
 			
 			/* Handle inter-character padding */
 			if (p) {
 				if (!first) {
-					gdispFillArea(x, y, p, h, bgcolor);
+					gdispFillArea_unsafe(x, y, p, h, bgcolor);
 					x += p;
 				} else
 					first = 0;
 			}
 
 			/* Print the character */
-			gdispFillChar(x, y, c, font, color, bgcolor);
+			gdispFillChar_unsafe(x, y, c, font, color, bgcolor);
 			x += w;
 		}
 	}
+
+	void gdispFillString(coord_t x, coord_t y, const char *str, font_t font, color_t color, color_t bgcolor) {
+		gdispLock();
+		gdispFillString_unsafe(x, y, str, font, color, bgcolor);
+		gdispUnlock();
+	}
 #endif
 	
 #if GDISP_NEED_TEXT
-	void gdispDrawStringBox(coord_t x, coord_t y, coord_t cx, coord_t cy, const char* str, font_t font, color_t color, justify_t justify) {
-		/* No mutex required as we only call high level functions which have their own mutex */
+	void gdispDrawStringBox_unsafe(coord_t x, coord_t y, coord_t cx, coord_t cy, const char* str, font_t font, color_t color, justify_t justify) {
 		coord_t		w, h, p, ypos, xpos;
-		char		c;
+		unicode_t	c;
 		int			first;
-		const char *rstr;
+		const char *rstr, *pstr;
 		
 		if (!str) str = "";
 
@@ -768,7 +1502,7 @@ void gdispDrawBox(coord_t x, coord_t y, coord_t cx, coord_t cy, color_t color) {
 				first = 1;
 				while(*str) {
 					/* Get the next printable character */
-					c = *str++;
+					c = _getStringChar(str);
 					w = _getCharWidth(font, c) * font->xscale;
 					if (!w) continue;
 					
@@ -793,26 +1527,26 @@ void gdispDrawBox(coord_t x, coord_t y, coord_t cx, coord_t cy, color_t color) {
 			for(rstr = str; *str; str++);
 			xpos = x+cx - 2;
 			first = 1;
-			for(str--; str >= rstr; str--) {
-				/* Get the next printable character */
-				c = *str;
+			while(str > rstr) {
+				/* Get the previous printable character */
+				pstr = str;
+				c = _getStringPrevChar(str, rstr);
 				w = _getCharWidth(font, c) * font->xscale;
 				if (!w) continue;
 				
 				/* Handle inter-character padding */
 				if (p) {
 					if (!first) {
-						if (xpos - p < x) break;
+						if (xpos - p < x) { str = pstr; break; }
 						xpos -= p;
 					} else
 						first = 0;
 				}
 
 				/* Print the character */
-				if (xpos - w < x) break;
+				if (xpos - w < x) { str = pstr; break; }
 				xpos -= w;
 			}
-			str++;
 			break;
 		case justifyLeft:
 			/* Fall through */
@@ -825,7 +1559,7 @@ void gdispDrawBox(coord_t x, coord_t y, coord_t cx, coord_t cy, color_t color) {
 		first = 1;
 		while(*str) {
 			/* Get the next printable character */
-			c = *str++;
+			c = _getStringChar(str);
 			w = _getCharWidth(font, c) * font->xscale;
 			if (!w) continue;
 			
@@ -840,19 +1574,24 @@ void gdispDrawBox(coord_t x, coord_t y, coord_t cx, coord_t cy, color_t color) {
 
 			/* Print the character */
 			if (xpos + w > x+cx) break;
-			gdispDrawChar(xpos, y, c, font, color);
+			gdispDrawChar_unsafe(xpos, y, c, font, color);
 			xpos += w;
 		}
 	}
+
+	void gdispDrawStringBox(coord_t x, coord_t y, coord_t cx, coord_t cy, const char* str, font_t font, color_t color, justify_t justify) {
+		gdispLock();
+		gdispDrawStringBox_unsafe(x, y, cx, cy, str, font, color, justify);
+		gdispUnlock();
+	}
 #endif
 	
 #if GDISP_NEED_TEXT
-	void gdispFillStringBox(coord_t x, coord_t y, coord_t cx, coord_t cy, const char* str, font_t font, color_t color, color_t bgcolor, justify_t justify) {
-		/* No mutex required as we only call high level functions which have their own mutex */
+	void gdispFillStringBox_unsafe(coord_t x, coord_t y, coord_t cx, coord_t cy, const char* str, font_t font, color_t color, color_t bgcolor, justify_t justify) {
 		coord_t		w, h, p, ypos, xpos;
-		char		c;
+		unicode_t	c;
 		int			first;
-		const char *rstr;
+		const char *rstr, *pstr;
 		
 		if (!str) str = "";
 
@@ -865,7 +1604,7 @@ void gdispDrawBox(coord_t x, coord_t y, coord_t cx, coord_t cy, color_t color) {
 		/* See if we need to fill above the font */
 		ypos = (cy - h + 1)/2;
 		if (ypos > 0) {
-			gdispFillArea(x, y, cx, ypos, bgcolor);
+			gdispFillArea_unsafe(x, y, cx, ypos, bgcolor);
 			y += ypos;
 			cy -= ypos;
 		}
@@ -873,7 +1612,7 @@ void gdispDrawBox(coord_t x, coord_t y, coord_t cx, coord_t cy, color_t color) {
 		/* See if we need to fill below the font */
 		ypos = cy - h;
 		if (ypos > 0) {
-			gdispFillArea(x, y+cy-ypos, cx, ypos, bgcolor);
+			gdispFillArea_unsafe(x, y+cy-ypos, cx, ypos, bgcolor);
 			cy -= ypos;
 		}
 		
@@ -891,7 +1630,7 @@ void gdispDrawBox(coord_t x, coord_t y, coord_t cx, coord_t cy, color_t color) {
 				first = 1;
 				while(*str) {
 					/* Get the next printable character */
-					c = *str++;
+					c = _getStringChar(str);
 					w = _getCharWidth(font, c) * font->xscale;
 					if (!w) continue;
 					
@@ -916,26 +1655,26 @@ void gdispDrawBox(coord_t x, coord_t y, coord_t cx, coord_t cy, color_t color) {
 			for(rstr = str; *str; str++);
 			xpos = x+cx - 2;
 			first = 1;
-			for(str--; str >= rstr; str--) {
-				/* Get the next printable character */
-				c = *str;
+			while(str > rstr) {
+				/* Get the previous printable character */
+				pstr = str;
+				c = _getStringPrevChar(str, rstr);
 				w = _getCharWidth(font, c) * font->xscale;
 				if (!w) continue;
 				
 				/* Handle inter-character padding */
 				if (p) {
 					if (!first) {
-						if (xpos - p < x) break;
+						if (xpos - p < x) { str = pstr; break; }
 						xpos -= p;
 					} else
 						first = 0;
 				}
 
 				/* Print the character */
-				if (xpos - w < x) break;
+				if (xpos - w < x) { str = pstr; break; }
 				xpos -= w;
 			}
-			str++;
 			break;
 		case justifyLeft:
 			/* Fall through */
@@ -944,15 +1683,24 @@ void gdispDrawBox(coord_t x, coord_t y, coord_t cx, coord_t cy, color_t color) {
 			break;
 		}
 		
+		#if GDISP_NEED_TEXT_BLIT
+			/* Send the space to the left, the characters and the space to the right in one go */
+			if (cy <= GDISP_TEXT_BLIT_SIZE) {
+				w = xpos < x ? xpos : x;
+				blitString(w, y, x+cx-w, xpos, str, font, color, bgcolor);
+				return;
+			}
+		#endif
+
 		/* Fill any space to the left */
 		if (x < xpos)
-			gdispFillArea(x, y, xpos-x, cy, bgcolor);
+			gdispFillArea_unsafe(x, y, xpos-x, cy, bgcolor);
 		
 		/* Print characters until we run out of room */
 		first = 1;
 		while(*str) {
 			/* Get the next printable character */
-			c = *str++;
+			c = _getStringChar(str);
 			w = _getCharWidth(font, c) * font->xscale;
 			if (!w) continue;
 			
@@ -960,7 +1708,7 @@ void gdispDrawBox(coord_t x, coord_t y, coord_t cx, coord_t cy, color_t color) {
 			if (p) {
 				if (!first) {
 					if (xpos + p > x+cx) break;
-					gdispFillArea(xpos, y, p, cy, bgcolor);
+					gdispFillArea_unsafe(xpos, y, p, cy, bgcolor);
 					xpos += p;
 				} else
 					first = 0;
@@ -968,13 +1716,19 @@ void gdispDrawBox(coord_t x, coord_t y, coord_t cx, coord_t cy, color_t color) {
 
 			/* Print the character */
 			if (xpos + w > x+cx) break;
-			gdispFillChar(xpos, y, c, font, color, bgcolor);
+			gdispFillChar_unsafe(xpos, y, c, font, color, bgcolor);
 			xpos += w;
 		}
 		
 		/* Fill any space to the right */
 		if (xpos < x+cx)
-			gdispFillArea(xpos, y, x+cx-xpos, cy, bgcolor);
+			gdispFillArea_unsafe(xpos, y, x+cx-xpos, cy, bgcolor);
+	}
+
+	void gdispFillStringBox(coord_t x, coord_t y, coord_t cx, coord_t cy, const char* str, font_t font, color_t color, color_t bgcolor, justify_t justify) {
+		gdispLock();
+		gdispFillStringBox_unsafe(x, y, cx, cy, str, font, color, bgcolor, justify);
+		gdispUnlock();
 	}
 #endif
 	
@@ -994,7 +1748,7 @@ void gdispDrawBox(coord_t x, coord_t y, coord_t cx, coord_t cy, color_t color) {
 #endif
 	
 #if GDISP_NEED_TEXT
-	coord_t gdispGetCharWidth(char c, font_t font) {
+	coord_t gdispGetCharWidth(unicode_t c, font_t font) {
 		/* No mutex required as we only read static data */
 		return _getCharWidth(font, c) * font->xscale;
 	}
@@ -1004,16 +1758,16 @@ void gdispDrawBox(coord_t x, coord_t y, coord_t cx, coord_t cy, color_t color) {
 	coord_t gdispGetStringWidth(const char* str, font_t font) {
 		/* No mutex required as we only read static data */
 		coord_t		w, p, x;
-		char		c;
+		unicode_t	c;
 		int			first;
 		
 		first = 1;
 		x = 0;
-		p = font->charPadding * font->xscale;
+		p = font->charPadding;
 		while(*str) {
 			/* Get the next printable character */
-			c = *str++;
-			w = _getCharWidth(font, c)  * font->xscale;
+			c = _getStringChar(str);
+			w = _getCharWidth(font, c);
 			if (!w) continue;
 			
 			/* Handle inter-character padding */
@@ -1027,7 +1781,9 @@ void gdispDrawBox(coord_t x, coord_t y, coord_t cx, coord_t cy, color_t color) {
 			/* Add the character width */
 			x += w;
 		}
-		return x;
+
+		/* Everything is scaled the same so scale once at the end */
+		return x * font->xscale;
 	}
 #endif
 
@@ -5,5 +5,8 @@ GFXSRC +=   $(GFXLIB)/src/gdisp/gdisp.c \
 			$(GFXLIB)/src/gdisp/image_gif.c \
 			$(GFXLIB)/src/gdisp/image_bmp.c \
 			$(GFXLIB)/src/gdisp/image_jpg.c \
-			$(GFXLIB)/src/gdisp/image_png.c
+			$(GFXLIB)/src/gdisp/image_png.c \
+			$(GFXLIB)/src/gdisp/tile.c \
+			$(GFXLIB)/src/gdisp/textbox.c \
+			$(GFXLIB)/src/gdisp/shadow.c
 			
\ No newline at end of file
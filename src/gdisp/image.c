@@ -88,13 +88,17 @@ static void ImageMemoryClose(struct gdispImageIO *pio) {
 static const gdispImageIOFunctions ImageMemoryFunctions =
 	{ ImageMemoryRead, ImageMemorySeek, ImageMemoryClose };
 
-bool_t gdispImageSetMemoryReader(gdispImage *img, const void *memimage) {
-	img->io.fns = &ImageMemoryFunctions;
-	img->io.pos = 0;
-	img->io.fd = memimage;
+bool_t gdispImageIOSetMemoryReader(gdispImageIO *pio, const void *memimage) {
+	pio->fns = &ImageMemoryFunctions;
+	pio->pos = 0;
+	pio->fd = memimage;
 	return TRUE;
 }
 
+bool_t gdispImageSetMemoryReader(gdispImage *img, const void *memimage) {
+	return gdispImageIOSetMemoryReader(&img->io, memimage);
+}
+
 static size_t ImageBaseFileStreamRead(struct gdispImageIO *pio, void *buf, size_t len) {
 	if (pio->fd == (void *)-1) return 0;
 	len = chSequentialStreamRead(((BaseFileStream *)pio->fd), (uint8_t *)buf, len);
@@ -120,15 +124,24 @@ static void ImageBaseFileStreamClose(struct gdispImageIO *pio) {
 static const gdispImageIOFunctions ImageBaseFileStreamFunctions =
 	{ ImageBaseFileStreamRead, ImageBaseFileStreamSeek, ImageBaseFileStreamClose };
 
-bool_t gdispImageSetBaseFileStreamReader(gdispImage *img, void *BaseFileStreamPtr) {
-	img->io.fns = &ImageBaseFileStreamFunctions;
-	img->io.pos = 0;
-	img->io.fd = BaseFileStreamPtr;
+bool_t gdispImageIOSetBaseFileStreamReader(gdispImageIO *pio, void *BaseFileStreamPtr) {
+	pio->fns = &ImageBaseFileStreamFunctions;
+	pio->pos = 0;
+	pio->fd = BaseFileStreamPtr;
 	return TRUE;
 }
 
-#if defined(WIN32)
+bool_t gdispImageSetBaseFileStreamReader(gdispImage *img, void *BaseFileStreamPtr) {
+	return gdispImageIOSetBaseFileStreamReader(&img->io, BaseFileStreamPtr);
+}
+
+#if defined(WIN32) || defined(__unix__)
 	#include <fcntl.h>
+	#include <unistd.h>
+
+	#ifndef O_BINARY
+		#define O_BINARY	0
+	#endif
 
 	static size_t ImageSimulFileRead(struct gdispImageIO *pio, void *buf, size_t len) {
 		if (pio->fd == (void *)-1) return 0;
@@ -156,11 +169,15 @@ bool_t gdispImageSetBaseFileStreamReader(gdispImage *img, void *BaseFileStreamPt
 	static const gdispImageIOFunctions ImageSimulFileFunctions =
 		{ ImageSimulFileRead, ImageSimulFileSeek, ImageSimulFileClose };
 
+	bool_t gdispImageIOSetSimulFileReader(gdispImageIO *pio, const char *filename) {
+		pio->fns = &ImageSimulFileFunctions;
+		pio->pos = 0;
+		pio->fd = (void *)open(filename, O_RDONLY|O_BINARY);
+		return pio->fd != (void *)-1;
+	}
+
 	bool_t gdispImageSetSimulFileReader(gdispImage *img, const char *filename) {
-		img->io.fns = &ImageSimulFileFunctions;
-		img->io.pos = 0;
-		img->io.fd = (void *)open(filename, O_RDONLY|O_BINARY);
-		return img->io.fd != (void *)-1;
+		return gdispImageIOSetSimulFileReader(&img->io, filename);
 	}
 #endif
 
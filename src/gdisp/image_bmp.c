@@ -52,13 +52,16 @@
 #ifndef GDISP_NEED_IMAGE_BMP_32
 	#define GDISP_NEED_IMAGE_BMP_32		TRUE
 #endif
+#ifndef GDISP_NEED_IMAGE_BMP_RLE_INDEX
+	#define GDISP_NEED_IMAGE_BMP_RLE_INDEX	FALSE
+#endif
 
-/**
- * How big a pixel array to allocate for blitting (in pixels)
- * Bigger is faster but uses more RAM.
- * This must be greater than 40 bytes and 32 pixels as we read our headers into this space as well
- */
-#define BLIT_BUFFER_SIZE	32
+#if GDISP_IMAGE_BMP_BLIT_BUFFER_SIZE < 32
+	#error "GDISP: GDISP_IMAGE_BMP_BLIT_BUFFER_SIZE must be at least 32 pixels"
+#endif
+#if GDISP_IMAGE_BMP_FILE_BUFFER_SIZE < 4
+	#error "GDISP: GDISP_IMAGE_BMP_FILE_BUFFER_SIZE must be at least 4 bytes"
+#endif
 
 /*
  * Determining endianness as at compile time is not guaranteed or compiler portable.
@@ -90,6 +93,16 @@ static const uint8_t	dwordOrder[4]	= { 1, 2, 3, 4 };
 	#define CONVERT_FROM_DWORD_LE(dw)	{ if (!isDWordLittleEndian()) dw = (((uint32_t)(((const uint8_t *)(&dw))[0]))|(((uint32_t)(((const uint8_t *)(&dw))[1]))<<8)|(((uint32_t)(((const uint8_t *)(&dw))[2]))<<16)|(((uint32_t)(((const uint8_t *)(&dw))[3]))<<24)); }
 #endif
 
+#if (GDISP_NEED_IMAGE_BMP_4_RLE || GDISP_NEED_IMAGE_BMP_8_RLE) && GDISP_NEED_IMAGE_BMP_RLE_INDEX
+/* The RLE decoder state at the start of a row */
+typedef struct bmprleindex {
+	uint32_t	pos;				// The file position
+	uint16_t	rlerun;
+	uint8_t		rlecode;
+	uint8_t		bmpflags;			// BMP_RLE_ENC or BMP_RLE_ABS
+	} bmprleindex;
+#endif
+
 typedef struct gdispImagePrivate {
 	uint8_t		bmpflags;
 		#define BMP_V2				0x01		// Version 2 (old) header format
@@ -108,6 +121,9 @@ typedef struct gdispImagePrivate {
 #if GDISP_NEED_IMAGE_BMP_4_RLE || GDISP_NEED_IMAGE_BMP_8_RLE
 	uint16_t	rlerun;
 	uint8_t		rlecode;
+	#if GDISP_NEED_IMAGE_BMP_RLE_INDEX
+	bmprleindex	*rleindex;			// The decoder state for each row (in file order)
+	#endif
 #endif
 #if GDISP_NEED_IMAGE_BMP_16 || GDISP_NEED_IMAGE_BMP_32
 	int8_t		shiftred;
@@ -121,9 +137,16 @@ typedef struct gdispImagePrivate {
 #endif
 	size_t		frame0pos;
 	pixel_t		*frame0cache;
-	pixel_t		buf[BLIT_BUFFER_SIZE];
+	pixel_t		buf[GDISP_IMAGE_BMP_BLIT_BUFFER_SIZE];
+#if GDISP_NEED_IMAGE_BMP_1 || GDISP_NEED_IMAGE_BMP_4 || GDISP_NEED_IMAGE_BMP_8 || GDISP_NEED_IMAGE_BMP_16 || GDISP_NEED_IMAGE_BMP_24 || GDISP_NEED_IMAGE_BMP_32
+	uint32_t	fbuf[(GDISP_IMAGE_BMP_FILE_BUFFER_SIZE+3)/4];	// Uncompressed data read from the file (dword aligned)
+#endif
 	} gdispImagePrivate;
 
+#if (GDISP_NEED_IMAGE_BMP_4_RLE || GDISP_NEED_IMAGE_BMP_8_RLE) && GDISP_NEED_IMAGE_BMP_RLE_INDEX
+static void buildRLEIndex(gdispImage *img);
+#endif
+
 gdispImageError gdispImageOpen_BMP(gdispImage *img) {
 	gdispImagePrivate *priv;
 	uint8_t		hdr[2];
@@ -145,6 +168,7 @@ gdispImageError gdispImageOpen_BMP(gdispImage *img) {
 		return GDISP_IMAGE_ERR_BADFORMAT;		// It can't be us
 
 	/* We know we are a BMP format image */
+	img->type = GDISP_IMAGE_TYPE_BMP;
 	img->flags = 0;
 
 	/* Allocate our private area */
@@ -159,15 +183,19 @@ gdispImageError gdispImageOpen_BMP(gdispImage *img) {
 #if GDISP_NEED_IMAGE_BMP_1 || GDISP_NEED_IMAGE_BMP_4 || GDISP_NEED_IMAGE_BMP_4_RLE || GDISP_NEED_IMAGE_BMP_8 || GDISP_NEED_IMAGE_BMP_8_RLE
 	priv->palette = 0;
 #endif
+#if (GDISP_NEED_IMAGE_BMP_4_RLE || GDISP_NEED_IMAGE_BMP_8_RLE) && GDISP_NEED_IMAGE_BMP_RLE_INDEX
+	priv->rleindex = 0;
+#endif
 
 	/* Skip the size field and the 2 reserved fields */
 	if (img->io.fns->read(&img->io, priv->buf, 8) != 8)
 		goto baddatacleanup;
 
 	/* Get the offset to the bitmap data */
-	if (img->io.fns->read(&img->io, &priv->frame0pos, 4) != 4)
+	if (img->io.fns->read(&img->io, &adword, 4) != 4)
 		goto baddatacleanup;
-	CONVERT_FROM_DWORD_LE(priv->frame0pos);
+	CONVERT_FROM_DWORD_LE(adword);
+	priv->frame0pos = adword;
 
 	/* Process the BITMAPCOREHEADER structure */
 
@@ -415,6 +443,12 @@ gdispImageError gdispImageOpen_BMP(gdispImage *img) {
 	}
 #endif
 
+#if (GDISP_NEED_IMAGE_BMP_4_RLE || GDISP_NEED_IMAGE_BMP_8_RLE) && GDISP_NEED_IMAGE_BMP_RLE_INDEX
+	/* Index the rows so drawing part of the image doesn't have to decode from the start */
+	if (priv->bmpflags & BMP_COMP_RLE)
+		buildRLEIndex(img);
+#endif
+
 	return GDISP_IMAGE_ERR_OK;
 
 baddatacleanup:
@@ -431,16 +465,55 @@ void gdispImageClose_BMP(gdispImage *img) {
 #if GDISP_NEED_IMAGE_BMP_1 || GDISP_NEED_IMAGE_BMP_4 || GDISP_NEED_IMAGE_BMP_4_RLE || GDISP_NEED_IMAGE_BMP_8 || GDISP_NEED_IMAGE_BMP_8_RLE
 		if (img->priv->palette)
 			chHeapFree((void *)img->priv->palette);
+#endif
+#if (GDISP_NEED_IMAGE_BMP_4_RLE || GDISP_NEED_IMAGE_BMP_8_RLE) && GDISP_NEED_IMAGE_BMP_RLE_INDEX
+		if (img->priv->rleindex)
+			chHeapFree((void *)img->priv->rleindex);
 #endif
 		if (img->priv->frame0cache)
 			chHeapFree((void *)img->priv->frame0cache);
 		chHeapFree((void *)img->priv);
 		img->priv = 0;
 	}
+	img->type = GDISP_IMAGE_TYPE_UNKNOWN;
 	img->membytes = 0;
 	img->io.fns->close(&img->io);
 }
 
+#if GDISP_NEED_IMAGE_BMP_1 || GDISP_NEED_IMAGE_BMP_4 || GDISP_NEED_IMAGE_BMP_8 || GDISP_NEED_IMAGE_BMP_16 || GDISP_NEED_IMAGE_BMP_24 || GDISP_NEED_IMAGE_BMP_32
+/* Limit a read to the size of the file buffer */
+#define rawMax(n)	((n) < GDISP_IMAGE_BMP_FILE_BUFFER_SIZE ? (n) : GDISP_IMAGE_BMP_FILE_BUFFER_SIZE)
+
+/*
+ * Read the data for the pixels of an uncompressed row starting at pixel x with a single read
+ * of up to max bytes. Once the last pixel of the row is read the file is moved past the row padding.
+ * Returns the number of pixels read (possibly some beyond the image width) or 0 on error.
+ */
+static coord_t readRow(gdispImage *img, coord_t x, void *buf, size_t max) {
+	gdispImagePrivate *	priv;
+	size_t				len, rowend;
+	coord_t				n;
+
+	priv = img->priv;
+
+	/* The bytes left in the row including the padding */
+	len = ((((size_t)img->width * priv->bitsperpixel + 31) >> 5) << 2) - ((size_t)x * priv->bitsperpixel >> 3);
+	rowend = img->io.pos + len;
+
+	/* Only read whole pixels. Other than 24 bit, pixels are read a dword at a time. */
+	max -= max % (priv->bitsperpixel == 24 ? 3 : 4);
+	if (len > max)
+		len = max;
+	if (!len || img->io.fns->read(&img->io, buf, len) != len)
+		return 0;
+
+	n = (len << 3) / priv->bitsperpixel;
+	if (x + n >= img->width && img->io.pos != rowend)
+		img->io.fns->seek(&img->io, rowend);
+	return n;
+}
+#endif
+
 static coord_t getPixels(gdispImage *img, coord_t x) {
 	gdispImagePrivate *	priv;
 	color_t *			pc;
@@ -454,27 +527,24 @@ static coord_t getPixels(gdispImage *img, coord_t x) {
 #if GDISP_NEED_IMAGE_BMP_1
 	case 1:
 		{
-		uint8_t		b[4];
-		uint8_t		m;
-
-			priv = img->priv;
-			pc = priv->buf;
-			len = 0;
-
-			while(x < img->width && len <= BLIT_BUFFER_SIZE-32) {
-				if (img->io.fns->read(&img->io, &b, 4) != 4)
-					return 0;
-
-				for(m=0x80; m; m >>= 1, pc++)
-					pc[0] = priv->palette[(m&b[0]) ? 1 : 0];
-				for(m=0x80; m; m >>= 1, pc++)
-					pc[0] = priv->palette[(m&b[1]) ? 1 : 0];
-				for(m=0x80; m; m >>= 1, pc++)
-					pc[0] = priv->palette[(m&b[2]) ? 1 : 0];
-				for(m=0x80; m; m >>= 1, pc++)
-					pc[0] = priv->palette[(m&b[3]) ? 1 : 0];
-				len += 32;
-				x += 32;
+		const uint8_t *	pb;
+		const pixel_t *	pal;
+		uint8_t			b;
+
+			if (!(len = readRow(img, x, priv->fbuf, rawMax(GDISP_IMAGE_BMP_BLIT_BUFFER_SIZE/8))))
+				return 0;
+			pal = priv->palette;
+			for(pb = (const uint8_t *)priv->fbuf, x = len; x; x -= 8) {
+				b = *pb++;
+				pc[0] = pal[b >> 7];
+				pc[1] = pal[(b >> 6) & 1];
+				pc[2] = pal[(b >> 5) & 1];
+				pc[3] = pal[(b >> 4) & 1];
+				pc[4] = pal[(b >> 3) & 1];
+				pc[5] = pal[(b >> 2) & 1];
+				pc[6] = pal[(b >> 1) & 1];
+				pc[7] = pal[b & 1];
+				pc += 8;
 			}
 		}
 		return len;
@@ -491,7 +561,7 @@ static coord_t getPixels(gdispImage *img, coord_t x) {
 
 			while(x < img->width) {
 				if (priv->bmpflags & BMP_RLE_ENC) {
-					while (priv->rlerun && len <= BLIT_BUFFER_SIZE-2 && x < img->width) {
+					while (priv->rlerun && len <= GDISP_IMAGE_BMP_BLIT_BUFFER_SIZE-2 && x < img->width) {
 						*pc++ = priv->palette[priv->rlecode >> 4];
 						priv->rlerun--;
 						len++;
@@ -506,7 +576,7 @@ static coord_t getPixels(gdispImage *img, coord_t x) {
 					if (priv->rlerun)			// Return if we have more run to do
 						return len;
 				} else if (priv->bmpflags & BMP_RLE_ABS) {
-					while (priv->rlerun && len <= BLIT_BUFFER_SIZE-2 && x < img->width) {
+					while (priv->rlerun && len <= GDISP_IMAGE_BMP_BLIT_BUFFER_SIZE-2 && x < img->width) {
 						if (img->io.fns->read(&img->io, &b, 1) != 1)
 							return 0;
 						*pc++ = priv->palette[b[0] >> 4];
@@ -564,22 +634,15 @@ static coord_t getPixels(gdispImage *img, coord_t x) {
 	#endif
 	#if GDISP_NEED_IMAGE_BMP_4
 		{
-			uint8_t		b[4];
-
-			while(x < img->width && len <= BLIT_BUFFER_SIZE-8) {
-				if (img->io.fns->read(&img->io, &b, 4) != 4)
-					return 0;
-
-				*pc++ = priv->palette[b[0] >> 4];
-				*pc++ = priv->palette[b[0] & 0x0F];
-				*pc++ = priv->palette[b[1] >> 4];
-				*pc++ = priv->palette[b[1] & 0x0F];
-				*pc++ = priv->palette[b[2] >> 4];
-				*pc++ = priv->palette[b[2] & 0x0F];
-				*pc++ = priv->palette[b[3] >> 4];
-				*pc++ = priv->palette[b[3] & 0x0F];
-				len += 8;
-				x += 8;
+		const uint8_t *	pb;
+		const pixel_t *	pal;
+
+			if (!(len = readRow(img, x, priv->fbuf, rawMax(GDISP_IMAGE_BMP_BLIT_BUFFER_SIZE/2))))
+				return 0;
+			pal = priv->palette;
+			for(pb = (const uint8_t *)priv->fbuf, x = len; x; x -= 2, pb++) {
+				*pc++ = pal[*pb >> 4];
+				*pc++ = pal[*pb & 0x0F];
 			}
 			return len;
 		}
@@ -597,7 +660,7 @@ static coord_t getPixels(gdispImage *img, coord_t x) {
 
 			while(x < img->width) {
 				if (priv->bmpflags & BMP_RLE_ENC) {
-					while (priv->rlerun && len < BLIT_BUFFER_SIZE && x < img->width) {
+					while (priv->rlerun && len < GDISP_IMAGE_BMP_BLIT_BUFFER_SIZE && x < img->width) {
 						*pc++ = priv->palette[priv->rlecode];
 						priv->rlerun--;
 						len++;
@@ -606,7 +669,7 @@ static coord_t getPixels(gdispImage *img, coord_t x) {
 					if (priv->rlerun)			// Return if we have more run to do
 						return len;
 				} else if (priv->bmpflags & BMP_RLE_ABS) {
-					while (priv->rlerun && len < BLIT_BUFFER_SIZE && x < img->width) {
+					while (priv->rlerun && len < GDISP_IMAGE_BMP_BLIT_BUFFER_SIZE && x < img->width) {
 						if (img->io.fns->read(&img->io, &b, 1) != 1)
 							return 0;
 						*pc++ = priv->palette[b[0]];
@@ -658,19 +721,14 @@ static coord_t getPixels(gdispImage *img, coord_t x) {
 	#endif
 	#if GDISP_NEED_IMAGE_BMP_8
 		{
-			uint8_t		b[4];
-
-			while(x < img->width && len <= BLIT_BUFFER_SIZE-4) {
-				if (img->io.fns->read(&img->io, &b, 4) != 4)
-					return 0;
-
-				*pc++ = priv->palette[b[0]];
-				*pc++ = priv->palette[b[1]];
-				*pc++ = priv->palette[b[2]];
-				*pc++ = priv->palette[b[3]];
-				len += 4;
-				x += 4;
-			}
+		const uint8_t *	pb;
+		const pixel_t *	pal;
+
+			if (!(len = readRow(img, x, priv->fbuf, rawMax(GDISP_IMAGE_BMP_BLIT_BUFFER_SIZE))))
+				return 0;
+			pal = priv->palette;
+			for(pb = (const uint8_t *)priv->fbuf, x = len; x; x--)
+				*pc++ = pal[*pb++];
 			return len;
 		}
 	#endif
@@ -679,44 +737,40 @@ static coord_t getPixels(gdispImage *img, coord_t x) {
 #if GDISP_NEED_IMAGE_BMP_16
 	case 16:
 		{
-		uint16_t	w[2];
-		color_t		r, g, b;
-
-			while(x < img->width && len <= BLIT_BUFFER_SIZE-2) {
-				if (img->io.fns->read(&img->io, &w, 4) != 4)
+		const uint16_t *pw;
+		uint16_t		w;
+		color_t			r, g, b;
+
+	#if GDISP_PIXELFORMAT == GDISP_PIXELFORMAT_RGB565
+			/* If the bit fields match our pixel format the data can be blitted as it is */
+			if (priv->maskred == 0xF800 && priv->maskgreen == 0x07E0 && priv->maskblue == 0x001F) {
+				if (!(len = readRow(img, x, priv->buf, GDISP_IMAGE_BMP_BLIT_BUFFER_SIZE*2)))
 					return 0;
-				CONVERT_FROM_WORD_LE(w[0]);
-				CONVERT_FROM_WORD_LE(w[1]);
-				if (priv->shiftred < 0)
-					r = (color_t)((w[0] & priv->maskred) << -priv->shiftred);
-				else
-					r = (color_t)((w[0] & priv->maskred) >> priv->shiftred);
-				if (priv->shiftgreen < 0)
-					g = (color_t)((w[0] & priv->maskgreen) << -priv->shiftgreen);
-				else
-					g = (color_t)((w[0] & priv->maskgreen) >> priv->shiftgreen);
-				if (priv->shiftblue < 0)
-					b = (color_t)((w[0] & priv->maskblue) << -priv->shiftblue);
-				else
-					b = (color_t)((w[0] & priv->maskblue) >> priv->shiftblue);
-				/* We don't support alpha yet */
-				*pc++ = RGB2COLOR(r, g, b);
+				for(x = 0; x < len; x++)
+					CONVERT_FROM_WORD_LE(pc[x]);
+				return len;
+			}
+	#endif
+
+			if (!(len = readRow(img, x, priv->fbuf, rawMax(GDISP_IMAGE_BMP_BLIT_BUFFER_SIZE*2))))
+				return 0;
+			for(pw = (const uint16_t *)priv->fbuf, x = len; x; x--) {
+				w = *pw++;
+				CONVERT_FROM_WORD_LE(w);
 				if (priv->shiftred < 0)
-					r = (color_t)((w[1] & priv->maskred) << -priv->shiftred);
+					r = (color_t)((w & priv->maskred) << -priv->shiftred);
 				else
-					r = (color_t)((w[1] & priv->maskred) >> priv->shiftred);
+					r = (color_t)((w & priv->maskred) >> priv->shiftred);
 				if (priv->shiftgreen < 0)
-					g = (color_t)((w[1] & priv->maskgreen) << -priv->shiftgreen);
+					g = (color_t)((w & priv->maskgreen) << -priv->shiftgreen);
 				else
-					g = (color_t)((w[1] & priv->maskgreen) >> priv->shiftgreen);
+					g = (color_t)((w & priv->maskgreen) >> priv->shiftgreen);
 				if (priv->shiftblue < 0)
-					b = (color_t)((w[1] & priv->maskblue) << -priv->shiftblue);
+					b = (color_t)((w & priv->maskblue) << -priv->shiftblue);
 				else
-					b = (uint8_t)((w[1] & priv->maskblue) >> priv->shiftblue);
+					b = (color_t)((w & priv->maskblue) >> priv->shiftblue);
 				/* We don't support alpha yet */
 				*pc++ = RGB2COLOR(r, g, b);
-				x += 2;
-				len += 2;
 			}
 		}
 		return len;
@@ -725,21 +779,12 @@ static coord_t getPixels(gdispImage *img, coord_t x) {
 #if GDISP_NEED_IMAGE_BMP_24
 	case 24:
 		{
-		uint8_t		b[3];
+		const uint8_t *	pb;
 
-			while(x < img->width && len < BLIT_BUFFER_SIZE) {
-				if (img->io.fns->read(&img->io, &b, 3) != 3)
-					return 0;
-				*pc++ = RGB2COLOR(b[2], b[1], b[0]);
-				x++;
-				len++;
-			}
-
-			if (x >= img->width) {
-				// Make sure we have read a multiple of 4 bytes for the line
-				if ((x & 3) && img->io.fns->read(&img->io, &b, x & 3) != (x & 3))
-					return 0;
-			}
+			if (!(len = readRow(img, x, priv->fbuf, rawMax(GDISP_IMAGE_BMP_BLIT_BUFFER_SIZE*3))))
+				return 0;
+			for(pb = (const uint8_t *)priv->fbuf, x = len; x; x--, pb += 3)
+				*pc++ = RGB2COLOR(pb[2], pb[1], pb[0]);
 		}
 		return len;
 #endif
@@ -747,12 +792,14 @@ static coord_t getPixels(gdispImage *img, coord_t x) {
 #if GDISP_NEED_IMAGE_BMP_32
 	case 32:
 		{
-		uint32_t	dw;
-		color_t		r, g, b;
-
-			while(x < img->width && len < BLIT_BUFFER_SIZE) {
-				if (img->io.fns->read(&img->io, &dw, 4) != 4)
-					return 0;
+		const uint32_t *pdw;
+		uint32_t		dw;
+		color_t			r, g, b;
+
+			if (!(len = readRow(img, x, priv->fbuf, rawMax(GDISP_IMAGE_BMP_BLIT_BUFFER_SIZE*4))))
+				return 0;
+			for(pdw = (const uint32_t *)priv->fbuf, x = len; x; x--) {
+				dw = *pdw++;
 				CONVERT_FROM_DWORD_LE(dw);
 				if (priv->shiftred < 0)
 					r = (color_t)((dw & priv->maskred) << -priv->shiftred);
@@ -768,8 +815,6 @@ static coord_t getPixels(gdispImage *img, coord_t x) {
 					b = (color_t)((dw & priv->maskblue) >> priv->shiftblue);
 				/* We don't support alpha yet */
 				*pc++ = RGB2COLOR(r, g, b);
-				x++;
-				len++;
 			}
 		}
 		return len;
@@ -780,6 +825,75 @@ static coord_t getPixels(gdispImage *img, coord_t x) {
 	}
 }
 
+#if GDISP_NEED_IMAGE_BMP_4_RLE || GDISP_NEED_IMAGE_BMP_8_RLE
+/* Start decoding RLE data from the beginning */
+static void startRLE(gdispImage *img) {
+	img->io.fns->seek(&img->io, img->priv->frame0pos);
+	img->priv->bmpflags &= ~(BMP_RLE_ENC|BMP_RLE_ABS);
+	img->priv->rlerun = 0;
+	img->priv->rlecode = 0;
+}
+#endif
+
+#if (GDISP_NEED_IMAGE_BMP_4_RLE || GDISP_NEED_IMAGE_BMP_8_RLE) && GDISP_NEED_IMAGE_BMP_RLE_INDEX
+/*
+ * Decode the whole image once, remembering where each row starts. If there isn't
+ * the memory or the data is bad the image is simply decoded from the start each time.
+ */
+static void buildRLEIndex(gdispImage *img) {
+	gdispImagePrivate *	priv;
+	bmprleindex *		pi;
+	coord_t				x, y, len;
+
+	priv = img->priv;
+	if (!(priv->rleindex = (bmprleindex *)chHeapAlloc(NULL, img->height * sizeof(bmprleindex))))
+		return;
+
+	startRLE(img);
+	for(y = 0, pi = priv->rleindex; y < img->height; y++, pi++) {
+		pi->pos = img->io.pos;
+		pi->rlerun = priv->rlerun;
+		pi->rlecode = priv->rlecode;
+		pi->bmpflags = priv->bmpflags & (BMP_RLE_ENC|BMP_RLE_ABS);
+		for(x = 0; x < img->width; x += len) {
+			if (!(len = getPixels(img, x))) {
+				chHeapFree((void *)priv->rleindex);
+				priv->rleindex = 0;
+				return;
+			}
+		}
+	}
+	img->membytes += img->height * sizeof(bmprleindex);
+}
+#endif
+
+/*
+ * Decode the current row from column mx up to column ex drawing the columns sx to sx+cx-1 at x, y.
+ * Returns FALSE on bad data.
+ */
+static bool_t drawRow(gdispImage *img, coord_t x, coord_t y, coord_t cx, coord_t sx, coord_t mx, coord_t ex) {
+	gdispImagePrivate *	priv;
+	coord_t				pos, len, st;
+
+	priv = img->priv;
+	while(mx < ex) {
+		if (!(pos = getPixels(img, mx)))
+			return FALSE;
+		/* Nothing is drawn when the row is only being skipped (cx == 0) */
+		if (cx > 0 && mx < sx+cx && mx+pos > sx) {
+			st = mx < sx ? sx - mx : 0;
+			len = pos-st;
+			if (mx+st+len > sx+cx) len = sx+cx-mx-st;
+			if (len == 1)
+				gdispDrawPixel(x+mx+st-sx, y, priv->buf[st]);
+			else
+				gdispBlitAreaEx(x+mx+st-sx, y, len, 1, st, 0, pos, priv->buf);
+		}
+		mx += pos;
+	}
+	return TRUE;
+}
+
 gdispImageError gdispImageCache_BMP(gdispImage *img) {
 	gdispImagePrivate *	priv;
 	color_t *			pcs;
@@ -839,8 +953,14 @@ gdispImageError gdispImageCache_BMP(gdispImage *img) {
 
 gdispImageError gdispImageDraw_BMP(gdispImage *img, coord_t x, coord_t y, coord_t cx, coord_t cy, coord_t sx, coord_t sy) {
 	gdispImagePrivate *	priv;
-	coord_t				mx, my;
-	coord_t				pos, len, st;
+	coord_t				my, fy, dy, n, mx;
+	size_t				stride;
+#if GDISP_NEED_IMAGE_BMP_4_RLE || GDISP_NEED_IMAGE_BMP_8_RLE
+	coord_t				ry;
+	#if GDISP_NEED_IMAGE_BMP_RLE_INDEX
+	bmprleindex *		pi;
+	#endif
+#endif
 
 	priv = img->priv;
 
@@ -855,49 +975,56 @@ gdispImageError gdispImageDraw_BMP(gdispImage *img, coord_t x, coord_t y, coord_
 		return GDISP_IMAGE_ERR_OK;
 	}
 
-	/* Start decoding from the beginning */
-	img->io.fns->seek(&img->io, priv->frame0pos);
-#if GDISP_NEED_IMAGE_BMP_4_RLE || GDISP_NEED_IMAGE_BMP_8_RLE
-	priv->rlerun = 0;
-	priv->rlecode = 0;
-#endif
-
+	/* Only the rows that are drawn are decoded. They are visited in file order. */
 	if (priv->bmpflags & BMP_TOP_TO_BOTTOM) {
-		for(my = 0; my < img->height; my++) {
-			mx = 0;
-			while(mx < img->width) {
-				if (!(pos = getPixels(img, mx)))
-					return GDISP_IMAGE_ERR_BADDATA;
-				if (my >= sy && my < sy+cy && mx < sx+cx && mx+pos >= sx) {
-					st = mx < sx ? sx - mx : 0;
-					len = pos-st;
-					if (mx+st+len > sx+cx) len = sx+cx-mx-st;
-					if (len == 1)
-						gdispDrawPixel(x+mx+st-sx, y+my-sy, priv->buf[st]);
-					else
-						gdispBlitAreaEx(x+mx+st-sx, y+my-sy, len, 1, st, 0, pos, priv->buf);
-				}
-				mx += pos;
-			}
-		}
+		my = sy;
+		dy = 1;
 	} else {
-		for(my = img->height-1; my >= 0; my--) {
-			mx = 0;
-			while(mx < img->width) {
-				if (!(pos = getPixels(img, mx)))
+		my = sy+cy-1;
+		dy = -1;
+	}
+
+#if GDISP_NEED_IMAGE_BMP_4_RLE || GDISP_NEED_IMAGE_BMP_8_RLE
+	if (priv->bmpflags & BMP_COMP_RLE) {
+	#if GDISP_NEED_IMAGE_BMP_RLE_INDEX
+		/* Restore the decoder state at the start of each row */
+		if (priv->rleindex) {
+			for(n = cy; n; n--, my += dy) {
+				pi = priv->rleindex + (dy > 0 ? my : img->height-1-my);
+				img->io.fns->seek(&img->io, pi->pos);
+				priv->bmpflags = (priv->bmpflags & ~(BMP_RLE_ENC|BMP_RLE_ABS)) | pi->bmpflags;
+				priv->rlerun = pi->rlerun;
+				priv->rlecode = pi->rlecode;
+				if (!drawRow(img, x, y+my-sy, cx, sx, 0, sx+cx))
 					return GDISP_IMAGE_ERR_BADDATA;
-				if (my >= sy && my < sy+cy && mx < sx+cx && mx+pos >= sx) {
-					st = mx < sx ? sx - mx : 0;
-					len = pos-st;
-					if (mx+st+len > sx+cx) len = sx+cx-mx-st;
-					if (len == 1)
-						gdispDrawPixel(x+mx+st-sx, y+my-sy, priv->buf[st]);
-					else
-						gdispBlitAreaEx(x+mx+st-sx, y+my-sy, len, 1, st, 0, pos, priv->buf);
-				}
-				mx += pos;
 			}
+			return GDISP_IMAGE_ERR_OK;
 		}
+	#endif
+
+		/* Decode (without drawing) the rows before the first one we need */
+		startRLE(img);
+		fy = dy > 0 ? my : img->height-1-my;
+		for(ry = 0; ry < fy; ry++) {
+			if (!drawRow(img, x, y, 0, sx, 0, img->width))
+				return GDISP_IMAGE_ERR_BADDATA;
+		}
+		for(n = cy; n; n--, my += dy) {
+			if (!drawRow(img, x, y+my-sy, cx, sx, 0, img->width))
+				return GDISP_IMAGE_ERR_BADDATA;
+		}
+		return GDISP_IMAGE_ERR_OK;
+	}
+#endif
+
+	/* Uncompressed rows can be read directly. Start with the dword holding pixel sx. */
+	stride = (((size_t)img->width * priv->bitsperpixel + 31) >> 5) << 2;
+	mx = priv->bitsperpixel < 24 ? sx & ~((32 / priv->bitsperpixel) - 1) : sx;
+	for(n = cy; n; n--, my += dy) {
+		fy = dy > 0 ? my : img->height-1-my;
+		img->io.fns->seek(&img->io, priv->frame0pos + fy * stride + ((size_t)mx * priv->bitsperpixel >> 3));
+		if (!drawRow(img, x, y+my-sy, cx, sx, mx, sx+cx))
+			return GDISP_IMAGE_ERR_BADDATA;
 	}
 
 	return GDISP_IMAGE_ERR_OK;
@@ -20,7 +20,9 @@
 
 /**
  * @file    src/gdisp/image_gif.c
- * @brief   GDISP native image code.
+ * @brief   GDISP GIF image code.
+ * @details	The image is decoded straight from the input into blit rows. No frame buffer
+ * 			is used and the LZW dictionary only exists while a frame is being decoded.
  */
 #include "ch.h"
 #include "hal.h"
@@ -28,20 +30,688 @@
 
 #if GFX_USE_GDISP && GDISP_NEED_IMAGE && GDISP_NEED_IMAGE_GIF
 
-#error "GIF support not implemented yet"
+#include <string.h>
 
-/* A pallete structure */
-typedef struct gdispImagePallete {
+/**
+ * How big a pixel array to allocate for blitting (in pixels)
+ * Bigger is faster but uses more RAM.
+ */
+#define BLIT_BUFFER_SIZE	32
+
+/* The LZW code size and dictionary limits set by the GIF specification */
+#define GIF_MAX_CODE_BITS	12
+#define GIF_MAX_CODES		(1<<GIF_MAX_CODE_BITS)
+#define GIF_CODE_NONE		0xFFFF
+
+/* Returned by initFrame() when the end of the file is reached */
+#define GIF_END_OF_FILE		1
+
+/* A frame within the file */
+typedef struct gifframe {
+	coord_t		x, y;					// The position of the frame within the image
+	coord_t		width, height;			// The size of the frame
+	uint16_t	delay;					// How long to show the frame for (in 1/100ths of a second)
 	uint8_t		flags;
-		#define GDISP_IMAGE_FLG_INT_TRANSPARENT		0x01
-	uint8_t		idxtrans;		/* The transparent idx */
-	uint8_t		maxidx;			/* The maximum index (0..255) */
-	uint8_t		repidx;			/* The index to use if the image data > maxidx */
-	color_t		pal[256];		/* The pallete entries - not all may actually be allocated */
-} gdispImagePallete;
-
-/* Draw a single palletized line (or partial line) */
-static void gdispDrawPalleteLine(const gdispImagePallete *pal, const uint8_t *line, coord_t x, coord_t y, coord_t cx);
+		#define GIFFRAME_INTERLACED		0x01	// The rows are stored interlaced
+		#define GIFFRAME_TRANSPARENT	0x02	// The paltrans index is transparent
+		#define GIFFRAME_LOCALPAL		0x04	// The frame has its own palette
+	uint8_t		paltrans;				// The transparent palette index
+	uint8_t		disposal;				// What to do with the frame before the next one is drawn
+		#define GIFDISPOSE_NONE			0		// Leave the frame in place
+		#define GIFDISPOSE_LEAVE		1		// Leave the frame in place
+		#define GIFDISPOSE_BACKGROUND	2		// Fill the frame area with the background color
+		#define GIFDISPOSE_PREVIOUS		3		// Restore what was there before the frame
+	uint8_t		codesz;					// The LZW minimum code size
+	uint16_t	palsize;				// The number of entries in the local palette
+	size_t		pospal;					// Where the local palette is in the file
+	size_t		posimg;					// Where the LZW data is in the file
+	size_t		posend;					// Where the next block after the frame is in the file
+	} gifframe;
+
+/* The LZW decoder state - only allocated while a frame is being decoded */
+typedef struct gifdecode {
+	uint8_t		blocksz;				// The bytes left in the current data sub-block
+	uint8_t		blockpos;				// Where we are up to in the current data sub-block
+	uint8_t		bitsz;					// The current code size
+	uint8_t		shiftbits;				// The number of bits in shiftdata
+	uint32_t	shiftdata;				// Bits read but not yet used
+	uint16_t	code_clear;				// The clear code
+	uint16_t	code_eof;				// The end of information code
+	uint16_t	code_max;				// The next dictionary entry to be allocated
+	uint16_t	code_last;				// The last code decoded
+	uint8_t		finchar;				// The first character of the last string decoded
+	uint8_t *	sp;						// The top of the string stack
+	uint8_t		block[255];				// The current data sub-block
+	uint8_t		out[BLIT_BUFFER_SIZE];	// Decoded palette indices
+	uint16_t	prefix[GIF_MAX_CODES];	// The dictionary
+	uint8_t		suffix[GIF_MAX_CODES];
+	uint8_t		stack[GIF_MAX_CODES];	// Strings are decoded backwards onto this stack
+	} gifdecode;
+
+typedef struct gdispImagePrivate {
+	uint8_t		flags;
+		#define GIF_LOOP				0x01	// The animation loops
+		#define GIF_LOOPFOREVER			0x02	// The animation loops forever
+		#define GIF_DISPOSE				0x04	// The dispose area needs to be filled before drawing
+	uint8_t		bgcolor;				// The background color palette index
+	uint16_t	loops;					// The number of times the animation has still to loop
+	uint16_t	maxloops;				// The number of times the animation loops
+	uint16_t	gpalsize;				// The number of entries in the global palette
+	pixel_t *	gpalette;				// The global palette
+	uint16_t	palsize;				// The number of entries in the current palette
+	pixel_t *	palette;				// The current palette (global or local)
+	size_t		frame0pos;				// Where the first frame starts in the file
+	gifframe	frame;					// The current frame
+	coord_t		dx, dy, dcx, dcy;		// The area to fill with the background color before drawing
+	size_t		cachepos;				// The posimg of the cached frame
+	size_t		cachesz;				// The size of the cached frame
+	uint8_t *	cache;					// A cached frame (palette indices)
+	pixel_t		buf[BLIT_BUFFER_SIZE];
+	} gdispImagePrivate;
+
+/* Skip data sub-blocks up to and including the block terminator */
+static bool_t skipBlocks(gdispImage *img) {
+	uint8_t		sz;
+
+	while(1) {
+		if (img->io.fns->read(&img->io, &sz, 1) != 1)
+			return FALSE;
+		if (!sz)
+			return TRUE;
+		img->io.fns->seek(&img->io, img->io.pos + sz);
+	}
+}
+
+/**
+ * Read the blocks from the current file position up to and including the next image descriptor.
+ * The frame only records where things are - the palette and the image data are not read.
+ * Returns GIF_END_OF_FILE if the trailer is found first.
+ */
+static gdispImageError initFrame(gdispImage *img, gifframe *frame) {
+	gdispImagePrivate *	priv;
+	uint8_t				b[11];
+
+	priv = img->priv;
+
+	/* The graphic control extension only applies to the image that follows it */
+	frame->delay = 0;
+	frame->flags = 0;
+	frame->paltrans = 0;
+	frame->disposal = GIFDISPOSE_NONE;
+
+	while(1) {
+		if (img->io.fns->read(&img->io, b, 1) != 1)
+			return GDISP_IMAGE_ERR_BADDATA;
+
+		switch(b[0]) {
+		case 0x2C:				// An image descriptor
+			if (img->io.fns->read(&img->io, b, 9) != 9)
+				return GDISP_IMAGE_ERR_BADDATA;
+			frame->x = b[0] | ((coord_t)b[1] << 8);
+			frame->y = b[2] | ((coord_t)b[3] << 8);
+			frame->width = b[4] | ((coord_t)b[5] << 8);
+			frame->height = b[6] | ((coord_t)b[7] << 8);
+			if (frame->x < 0 || frame->y < 0 || frame->width < 0 || frame->height < 0)
+				return GDISP_IMAGE_ERR_UNSUPPORTED;		// Bigger than a coord_t
+			if (b[8] & 0x40)
+				frame->flags |= GIFFRAME_INTERLACED;
+			if (b[8] & 0x80) {
+				frame->flags |= GIFFRAME_LOCALPAL;
+				frame->palsize = 2 << (b[8] & 0x07);
+				frame->pospal = img->io.pos;
+				img->io.fns->seek(&img->io, frame->pospal + frame->palsize * 3);
+			} else if (!priv->gpalette)
+				return GDISP_IMAGE_ERR_BADDATA;
+
+			/* The LZW data */
+			if (img->io.fns->read(&img->io, &frame->codesz, 1) != 1)
+				return GDISP_IMAGE_ERR_BADDATA;
+			if (frame->codesz < 2 || frame->codesz > 8)
+				return GDISP_IMAGE_ERR_BADDATA;
+			frame->posimg = img->io.pos;
+			if (!skipBlocks(img))
+				return GDISP_IMAGE_ERR_BADDATA;
+			frame->posend = img->io.pos;
+			return GDISP_IMAGE_ERR_OK;
+
+		case 0x21:				// An extension
+			if (img->io.fns->read(&img->io, b, 2) != 2)
+				return GDISP_IMAGE_ERR_BADDATA;
+			if (b[0] == 0xF9 && b[1] == 4) {			// Graphic control extension
+				if (img->io.fns->read(&img->io, b, 4) != 4)
+					return GDISP_IMAGE_ERR_BADDATA;
+				frame->disposal = (b[0] >> 2) & 0x07;
+				if (b[0] & 0x01) {
+					frame->flags |= GIFFRAME_TRANSPARENT;
+					frame->paltrans = b[3];
+				}
+				frame->delay = b[1] | ((uint16_t)b[2] << 8);
+			} else if (b[0] == 0xFF && b[1] == 11) {	// Application extension
+				if (img->io.fns->read(&img->io, b, 11) != 11)
+					return GDISP_IMAGE_ERR_BADDATA;
+				if (!memcmp(b, "NETSCAPE2.0", 11)) {		// The animation loop count
+					if (img->io.fns->read(&img->io, b, 1) != 1)
+						return GDISP_IMAGE_ERR_BADDATA;
+					if (!b[0])
+						break;							// That was the block terminator
+					if (b[0] != 3)
+						img->io.fns->seek(&img->io, img->io.pos + b[0]);
+					else {
+						if (img->io.fns->read(&img->io, b, 3) != 3)
+							return GDISP_IMAGE_ERR_BADDATA;
+						if (b[0] == 1 && !(priv->flags & GIF_LOOP)) {
+							priv->flags |= GIF_LOOP;
+							priv->maxloops = b[1] | ((uint16_t)b[2] << 8);
+							if (!priv->maxloops)
+								priv->flags |= GIF_LOOPFOREVER;
+							priv->loops = priv->maxloops;
+						}
+					}
+				}
+			} else
+				img->io.fns->seek(&img->io, img->io.pos + b[1]);
+			if (!skipBlocks(img))
+				return GDISP_IMAGE_ERR_BADDATA;
+			break;
+
+		case 0x3B:				// The trailer
+			return GIF_END_OF_FILE;
+
+		default:
+			return GDISP_IMAGE_ERR_BADDATA;
+		}
+	}
+}
+
+/* Make the current frame's palette the one used for drawing */
+static gdispImageError loadPalette(gdispImage *img) {
+	gdispImagePrivate *	priv;
+	pixel_t *			pal;
+	uint8_t				b[3];
+	uint16_t			i;
+
+	priv = img->priv;
+
+	/* Throw away any old local palette */
+	if (priv->palette && priv->palette != priv->gpalette) {
+		chHeapFree((void *)priv->palette);
+		img->membytes -= priv->palsize * sizeof(pixel_t);
+	}
+	priv->palette = priv->gpalette;
+	priv->palsize = priv->gpalsize;
+
+	if (!(priv->frame.flags & GIFFRAME_LOCALPAL))
+		return GDISP_IMAGE_ERR_OK;
+
+	/* If there is no memory for it the global palette stays. gdispImageDraw_GIF() tries again. */
+	if (!(pal = (pixel_t *)chHeapAlloc(NULL, priv->frame.palsize * sizeof(pixel_t))))
+		return GDISP_IMAGE_ERR_NOMEMORY;
+	priv->palette = pal;
+	img->membytes += priv->frame.palsize * sizeof(pixel_t);
+	priv->palsize = priv->frame.palsize;
+	img->io.fns->seek(&img->io, priv->frame.pospal);
+	for(i = 0; i < priv->palsize; i++) {
+		if (img->io.fns->read(&img->io, b, 3) != 3)
+			return GDISP_IMAGE_ERR_BADDATA;
+		priv->palette[i] = RGB2COLOR(b[0], b[1], b[2]);
+	}
+	return GDISP_IMAGE_ERR_OK;
+}
+
+/* Go back to the first frame */
+static gdispImageError startFrame0(gdispImage *img) {
+	gdispImagePrivate *	priv;
+	gdispImageError		err;
+
+	priv = img->priv;
+	priv->flags &= ~GIF_DISPOSE;
+	img->io.fns->seek(&img->io, priv->frame0pos);
+	if ((err = initFrame(img, &priv->frame)) != GDISP_IMAGE_ERR_OK)
+		return err == GIF_END_OF_FILE ? GDISP_IMAGE_ERR_BADDATA : err;
+	return loadPalette(img);
+}
+
+/* Start decoding the current frame */
+static gifdecode *startDecode(gdispImage *img) {
+	gdispImagePrivate *	priv;
+	gifdecode *			dec;
+
+	priv = img->priv;
+	if (!(dec = (gifdecode *)chHeapAlloc(NULL, sizeof(gifdecode))))
+		return 0;
+	dec->blocksz = 0;
+	dec->blockpos = 0;
+	dec->bitsz = priv->frame.codesz + 1;
+	dec->shiftbits = 0;
+	dec->shiftdata = 0;
+	dec->code_clear = 1 << priv->frame.codesz;
+	dec->code_eof = dec->code_clear + 1;
+	dec->code_max = dec->code_clear + 2;
+	dec->code_last = GIF_CODE_NONE;
+	dec->finchar = 0;
+	dec->sp = dec->stack;
+	img->io.fns->seek(&img->io, priv->frame.posimg);
+	return dec;
+}
+
+/* Get the next LZW code. Returns the end of information code at the end of the data. */
+static uint16_t getCode(gdispImage *img, gifdecode *dec) {
+	uint16_t	code;
+
+	while(dec->shiftbits < dec->bitsz) {
+		/* Get the next data sub-block */
+		if (dec->blockpos >= dec->blocksz) {
+			if (img->io.fns->read(&img->io, &dec->blocksz, 1) != 1 || !dec->blocksz
+					|| img->io.fns->read(&img->io, dec->block, dec->blocksz) != dec->blocksz) {
+				dec->blocksz = dec->blockpos = 0;
+				return dec->code_eof;
+			}
+			dec->blockpos = 0;
+		}
+		dec->shiftdata |= (uint32_t)dec->block[dec->blockpos++] << dec->shiftbits;
+		dec->shiftbits += 8;
+	}
+	code = dec->shiftdata & ((1 << dec->bitsz) - 1);
+	dec->shiftdata >>= dec->bitsz;
+	dec->shiftbits -= dec->bitsz;
+	return code;
+}
+
+/* Decode up to cnt palette indices into pout. Returns the number decoded - 0 at the end of the data or on an error. */
+static coord_t getIndices(gdispImage *img, gifdecode *dec, uint8_t *pout, coord_t cnt) {
+	coord_t		got;
+	uint16_t	code, incode;
+
+	for(got = 0; got < cnt; ) {
+		/* Anything left over from the last string */
+		if (dec->sp > dec->stack) {
+			do {
+				pout[got++] = *--dec->sp;
+			} while(dec->sp > dec->stack && got < cnt);
+			continue;
+		}
+
+		code = getCode(img, dec);
+		if (code == dec->code_eof)
+			break;
+
+		/* Start again with an empty dictionary */
+		if (code == dec->code_clear) {
+			dec->bitsz = img->priv->frame.codesz + 1;
+			dec->code_max = dec->code_clear + 2;
+			dec->code_last = GIF_CODE_NONE;
+			continue;
+		}
+
+		/* The first code after a clear is always a single character */
+		if (dec->code_last == GIF_CODE_NONE) {
+			if (code >= dec->code_clear)
+				break;
+			dec->code_last = code;
+			dec->finchar = code;
+			pout[got++] = code;
+			continue;
+		}
+
+		/* A code that isn't in the dictionary yet must be the last string plus its own first character */
+		incode = code;
+		if (code >= dec->code_max) {
+			if (code > dec->code_max)
+				break;
+			*dec->sp++ = dec->finchar;
+			code = dec->code_last;
+		}
+
+		/* Decode the string backwards onto the stack */
+		while(code >= dec->code_clear) {
+			if (dec->sp >= dec->stack+GIF_MAX_CODES-1)
+				return got;
+			*dec->sp++ = dec->suffix[code];
+			code = dec->prefix[code];
+		}
+		dec->finchar = code;
+		*dec->sp++ = code;
+
+		/* Add the new string to the dictionary */
+		if (dec->code_max < GIF_MAX_CODES) {
+			dec->prefix[dec->code_max] = dec->code_last;
+			dec->suffix[dec->code_max] = dec->finchar;
+			dec->code_max++;
+			if (dec->code_max >= (1 << dec->bitsz) && dec->bitsz < GIF_MAX_CODE_BITS)
+				dec->bitsz++;
+		}
+		dec->code_last = incode;
+	}
+	return got;
+}
+
+/* Draw a row of palette indices, skipping any transparent pixels */
+static void drawIndices(gdispImage *img, coord_t x, coord_t y, const uint8_t *pi, coord_t len) {
+	gdispImagePrivate *	priv;
+	coord_t				n;
+
+	priv = img->priv;
+	while(len) {
+		/* Skip transparent pixels */
+		if (priv->frame.flags & GIFFRAME_TRANSPARENT) {
+			while(len && *pi == priv->frame.paltrans) {
+				pi++; x++; len--;
+			}
+			if (!len)
+				break;
+		}
+
+		/* Convert the run up to the next transparent pixel */
+		for(n = 0; n < len && n < BLIT_BUFFER_SIZE; n++) {
+			if ((priv->frame.flags & GIFFRAME_TRANSPARENT) && pi[n] == priv->frame.paltrans)
+				break;
+			priv->buf[n] = pi[n] < priv->palsize ? priv->palette[pi[n]] : (priv->palsize ? priv->palette[0] : Black);
+		}
+		if (n == 1)
+			gdispDrawPixel(x, y, priv->buf[0]);
+		else
+			gdispBlitAreaEx(x, y, n, 1, 0, 0, n, priv->buf);
+		pi += n; x += n; len -= n;
+	}
+}
+
+/* Interlaced rows are stored in 4 passes */
+static const uint8_t	interlaceStart[4]	= { 0, 4, 2, 1 };
+static const uint8_t	interlaceStep[4]	= { 8, 8, 4, 2 };
+
+gdispImageError gdispImageOpen_GIF(gdispImage *img) {
+	gdispImagePrivate *	priv;
+	gdispImageError		err;
+	gifframe			next;
+	uint8_t				b[7];
+	uint16_t			i;
+
+	/* Read the file identifier */
+	if (img->io.fns->read(&img->io, b, 6) != 6)
+		return GDISP_IMAGE_ERR_BADFORMAT;		// It can't be us
+
+	if (b[0] != 'G' || b[1] != 'I' || b[2] != 'F' || b[3] != '8' || (b[4] != '7' && b[4] != '9') || b[5] != 'a')
+		return GDISP_IMAGE_ERR_BADFORMAT;		// It can't be us
+
+	/* We know we are a GIF format image */
+	img->type = GDISP_IMAGE_TYPE_GIF;
+	img->flags = 0;
+
+	/* Allocate our private area */
+	if (!(img->priv = (gdispImagePrivate *)chHeapAlloc(NULL, sizeof(gdispImagePrivate))))
+		return GDISP_IMAGE_ERR_NOMEMORY;
+	img->membytes = sizeof(gdispImagePrivate);
+
+	/* Initialise the essential bits in the private area */
+	priv = img->priv;
+	priv->flags = 0;
+	priv->loops = 0;
+	priv->maxloops = 0;
+	priv->gpalsize = 0;
+	priv->gpalette = 0;
+	priv->palsize = 0;
+	priv->palette = 0;
+	priv->cache = 0;
+
+	/* The logical screen descriptor */
+	if (img->io.fns->read(&img->io, b, 7) != 7)
+		goto baddatacleanup;
+	img->width = b[0] | ((coord_t)b[1] << 8);
+	img->height = b[2] | ((coord_t)b[3] << 8);
+	if (img->width < 1 || img->height < 1)
+		goto baddatacleanup;
+	priv->bgcolor = b[5];
+
+	/* Load the global palette */
+	if (b[4] & 0x80) {
+		priv->gpalsize = 2 << (b[4] & 0x07);
+		if (!(priv->gpalette = (pixel_t *)chHeapAlloc(NULL, priv->gpalsize * sizeof(pixel_t)))) {
+			gdispImageClose_GIF(img);
+			return GDISP_IMAGE_ERR_NOMEMORY;
+		}
+		img->membytes += priv->gpalsize * sizeof(pixel_t);
+		for(i = 0; i < priv->gpalsize; i++) {
+			if (img->io.fns->read(&img->io, b, 3) != 3)
+				goto baddatacleanup;
+			priv->gpalette[i] = RGB2COLOR(b[0], b[1], b[2]);
+		}
+	}
+	priv->frame0pos = img->io.pos;
+
+	/* Get the first frame */
+	if ((err = startFrame0(img)) != GDISP_IMAGE_ERR_OK) {
+		gdispImageClose_GIF(img);
+		return err;
+	}
+	if (priv->frame.flags & GIFFRAME_TRANSPARENT)
+		img->flags |= GDISP_IMAGE_FLG_TRANSPARENT;
+
+	/* Is there a second frame? */
+	img->io.fns->seek(&img->io, priv->frame.posend);
+	if (initFrame(img, &next) == GDISP_IMAGE_ERR_OK)
+		img->flags |= GDISP_IMAGE_FLG_ANIMATED;
+
+	return GDISP_IMAGE_ERR_OK;
+
+baddatacleanup:
+	gdispImageClose_GIF(img);				// Clean up the private data area
+	return GDISP_IMAGE_ERR_BADDATA;			// Oops - something wrong
+}
+
+void gdispImageClose_GIF(gdispImage *img) {
+	if (img->priv) {
+		if (img->priv->palette && img->priv->palette != img->priv->gpalette)
+			chHeapFree((void *)img->priv->palette);
+		if (img->priv->gpalette)
+			chHeapFree((void *)img->priv->gpalette);
+		if (img->priv->cache)
+			chHeapFree((void *)img->priv->cache);
+		chHeapFree((void *)img->priv);
+		img->priv = 0;
+	}
+	img->type = GDISP_IMAGE_TYPE_UNKNOWN;
+	img->membytes = 0;
+	img->io.fns->close(&img->io);
+}
+
+gdispImageError gdispImageCache_GIF(gdispImage *img) {
+	gdispImagePrivate *	priv;
+	gifdecode *			dec;
+	uint8_t *			p;
+	coord_t				my, mx, len, r;
+	uint8_t				pass;
+	size_t				sz;
+
+	/* If we are already cached - just return OK */
+	priv = img->priv;
+	if (priv->cache && priv->cachepos == priv->frame.posimg)
+		return GDISP_IMAGE_ERR_OK;
+
+	/* Only one frame is cached at a time */
+	if (priv->cache) {
+		chHeapFree((void *)priv->cache);
+		img->membytes -= priv->cachesz;
+		priv->cache = 0;
+	}
+
+	/* We need to allocate the cache */
+	sz = (size_t)priv->frame.width * priv->frame.height;
+	if (!sz)
+		return GDISP_IMAGE_ERR_OK;
+	if (!(dec = startDecode(img)))
+		return GDISP_IMAGE_ERR_NOMEMORY;
+	if (!(priv->cache = (uint8_t *)chHeapAlloc(NULL, sz))) {
+		chHeapFree((void *)dec);
+		return GDISP_IMAGE_ERR_NOMEMORY;
+	}
+	img->membytes += sz;
+	priv->cachepos = priv->frame.posimg;
+	priv->cachesz = sz;
+
+	/* Decode the entire frame into the cache */
+	pass = 0;
+	for(r = 0, my = 0; r < priv->frame.height; r++) {
+		p = priv->cache + (size_t)my * priv->frame.width;
+		for(mx = 0; mx < priv->frame.width; mx += len) {
+			if (!(len = getIndices(img, dec, p+mx, priv->frame.width-mx))) {
+				chHeapFree((void *)dec);
+				chHeapFree((void *)priv->cache);
+				img->membytes -= sz;
+				priv->cache = 0;
+				return GDISP_IMAGE_ERR_BADDATA;
+			}
+		}
+		if (priv->frame.flags & GIFFRAME_INTERLACED) {
+			for(my += interlaceStep[pass]; my >= priv->frame.height && pass < 3; my = interlaceStart[++pass]);
+		} else
+			my++;
+	}
+
+	chHeapFree((void *)dec);
+	return GDISP_IMAGE_ERR_OK;
+}
+
+gdispImageError gdispImageDraw_GIF(gdispImage *img, coord_t x, coord_t y, coord_t cx, coord_t cy, coord_t sx, coord_t sy) {
+	gdispImagePrivate *	priv;
+	gifdecode *			dec;
+	gdispImageError		err;
+	coord_t				fx0, fy0, fx1, fy1;
+	coord_t				my, mx, len, st, r;
+	uint8_t				pass;
+
+	priv = img->priv;
+
+	/* Check some reasonableness */
+	if (sx >= img->width || sy >= img->height) return GDISP_IMAGE_ERR_OK;
+	if (sx + cx > img->width) cx = img->width - sx;
+	if (sy + cy > img->height) cy = img->height - sy;
+
+	/* A local palette there wasn't memory for when the frame was started */
+	if ((priv->frame.flags & GIFFRAME_LOCALPAL) && priv->palette == priv->gpalette) {
+		if ((err = loadPalette(img)) != GDISP_IMAGE_ERR_OK)
+			return err;
+	}
+
+	/* Clear the area left by the previous frame */
+	if (priv->flags & GIF_DISPOSE) {
+		fx0 = priv->dx > sx ? priv->dx : sx;
+		fy0 = priv->dy > sy ? priv->dy : sy;
+		fx1 = priv->dx + priv->dcx < sx + cx ? priv->dx + priv->dcx : sx + cx;
+		fy1 = priv->dy + priv->dcy < sy + cy ? priv->dy + priv->dcy : sy + cy;
+		if (fx0 < fx1 && fy0 < fy1)
+			gdispFillArea(x+fx0-sx, y+fy0-sy, fx1-fx0, fy1-fy0,
+				priv->bgcolor < priv->gpalsize ? priv->gpalette[priv->bgcolor] : Black);
+	}
+
+	/* The part of the frame that we need to draw (in frame coordinates) */
+	fx0 = sx > priv->frame.x ? sx - priv->frame.x : 0;
+	fy0 = sy > priv->frame.y ? sy - priv->frame.y : 0;
+	fx1 = sx + cx - priv->frame.x;
+	if (fx1 > priv->frame.width) fx1 = priv->frame.width;
+	fy1 = sy + cy - priv->frame.y;
+	if (fy1 > priv->frame.height) fy1 = priv->frame.height;
+	if (fx0 >= fx1 || fy0 >= fy1)
+		return GDISP_IMAGE_ERR_OK;
+
+	/* Move the screen position to the frame origin */
+	x += priv->frame.x - sx;
+	y += priv->frame.y - sy;
+
+	/* Draw from the image cache - if it exists */
+	if (priv->cache && priv->cachepos == priv->frame.posimg) {
+		for(my = fy0; my < fy1; my++)
+			drawIndices(img, x+fx0, y+my, priv->cache + (size_t)my * priv->frame.width + fx0, fx1-fx0);
+		return GDISP_IMAGE_ERR_OK;
+	}
+
+	/* Decode straight to the screen */
+	if (!(dec = startDecode(img)))
+		return GDISP_IMAGE_ERR_NOMEMORY;
+	pass = 0;
+	for(r = 0, my = 0; r < priv->frame.height; r++) {
+		/* Once past the last row we need we can stop (unless the rows are interlaced) */
+		if (my >= fy1 && !(priv->frame.flags & GIFFRAME_INTERLACED))
+			break;
+
+		for(mx = 0; mx < priv->frame.width; mx += len) {
+			len = priv->frame.width - mx;
+			if (len > BLIT_BUFFER_SIZE)
+				len = BLIT_BUFFER_SIZE;
+			if (!(len = getIndices(img, dec, dec->out, len))) {
+				chHeapFree((void *)dec);
+				return GDISP_IMAGE_ERR_BADDATA;
+			}
+			if (my >= fy0 && my < fy1 && mx < fx1 && mx+len > fx0) {
+				st = mx < fx0 ? fx0 - mx : 0;
+				drawIndices(img, x+mx+st, y+my, dec->out+st, (mx+len > fx1 ? fx1 - mx : len) - st);
+			}
+		}
+
+		if (priv->frame.flags & GIFFRAME_INTERLACED) {
+			for(my += interlaceStep[pass]; my >= priv->frame.height && pass < 3; my = interlaceStart[++pass]);
+		} else
+			my++;
+	}
+
+	chHeapFree((void *)dec);
+	return GDISP_IMAGE_ERR_OK;
+}
+
+systime_t gdispImageNext_GIF(gdispImage *img) {
+	gdispImagePrivate *	priv;
+	gdispImageError		err;
+	systime_t			delay;
+	bool_t				looped;
+
+	priv = img->priv;
+
+	/* How long the current frame should be shown for */
+	delay = priv->frame.delay ? MS2ST(priv->frame.delay * 10) : TIME_IMMEDIATE;
+
+	/**
+	 * Remember the area to clear before the next frame is drawn.
+	 * Without a frame buffer we can't restore what was under the frame
+	 * so GIFDISPOSE_PREVIOUS is treated as GIFDISPOSE_NONE.
+	 */
+	priv->flags &= ~GIF_DISPOSE;
+	if (priv->frame.disposal == GIFDISPOSE_BACKGROUND) {
+		priv->flags |= GIF_DISPOSE;
+		priv->dx = priv->frame.x;
+		priv->dy = priv->frame.y;
+		priv->dcx = priv->frame.width;
+		priv->dcy = priv->frame.height;
+	}
+
+	/* Find the next frame */
+	img->io.fns->seek(&img->io, priv->frame.posend);
+	for(looped = FALSE; ; looped = TRUE) {
+		err = initFrame(img, &priv->frame);
+		if (err == GDISP_IMAGE_ERR_OK) {
+			/* Running out of memory for a local palette doesn't end the animation. The draw tries again. */
+			err = loadPalette(img);
+			if (err != GDISP_IMAGE_ERR_OK && err != GDISP_IMAGE_ERR_NOMEMORY)
+				break;
+			if (priv->frame.flags & GIFFRAME_TRANSPARENT)
+				img->flags |= GDISP_IMAGE_FLG_TRANSPARENT;
+			return delay;
+		}
+
+		/* At the end of the file we may need to loop back to the first frame */
+		if (err != GIF_END_OF_FILE || looped || !(priv->flags & GIF_LOOP))
+			break;
+		if (!(priv->flags & GIF_LOOPFOREVER)) {
+			if (!priv->loops)
+				break;
+			priv->loops--;
+		}
+		img->io.fns->seek(&img->io, priv->frame0pos);
+	}
+
+	/* No more frames - go back to the first frame for the next draw. Drawing it again plays the whole animation again. */
+	priv->loops = priv->maxloops;
+	startFrame0(img);
+	return TIME_INFINITE;
+}
 
 #endif /* GFX_USE_GDISP && GDISP_NEED_IMAGE && GDISP_NEED_IMAGE_GIF */
 /** @} */
@@ -20,7 +20,10 @@
 
 /**
  * @file    src/gdisp/image_jpg.c
- * @brief   GDISP native image code.
+ * @brief   GDISP JPG image code.
+ * @details	Baseline (sequential huffman) JPG images are decoded a row of MCU's at a time
+ * 			and each row is blitted straight to the display. Images can be scaled down by
+ * 			2, 4 or 8 in the DCT domain which is much faster than decoding at full size.
  */
 #include "ch.h"
 #include "hal.h"
@@ -28,7 +31,857 @@
 
 #if GFX_USE_GDISP && GDISP_NEED_IMAGE && GDISP_NEED_IMAGE_JPG
 
-#error "JPG support not implemented yet"
+#include <string.h>
+
+#if GDISP_IMAGE_JPG_FILE_BUFFER_SIZE < 1 || GDISP_IMAGE_JPG_FILE_BUFFER_SIZE > 65535
+	#error "GDISP: GDISP_IMAGE_JPG_FILE_BUFFER_SIZE must be between 1 and 65535 bytes"
+#endif
+
+/* The number of bits looked up at once when decoding huffman codes */
+#define HUFF_FAST_BITS		8
+
+/* Fixed point IDCT constants (AAN with 8 fractional bits) */
+#define IDCT_CONST_BITS		8
+#define IDCT_SCALE_BITS		3				// The extra fractional bits in the scaled quantization tables
+#define FIX_1_082392200		277
+#define FIX_1_414213562		362
+#define FIX_1_847759065		473
+#define FIX_2_613125930		669
+#define IDCT_MULTIPLY(v, c)	(((v) * (c)) >> IDCT_CONST_BITS)
+
+/* A huffman table as defined by the file */
+typedef struct jpghuffspec {
+	uint8_t		counts[16];				// The number of codes of each length
+	uint8_t		symbols[256];			// The symbols in code order
+	} jpghuffspec;
+
+/* A huffman table ready for decoding */
+typedef struct jpghuff {
+	uint16_t	fast[1<<HUFF_FAST_BITS];	// Codes up to HUFF_FAST_BITS long: (length << 8) | symbol
+	int32_t		maxcode[17];			// The largest code of each length (left justified) or -1
+	int32_t		valoff[17];				// The symbol index of the first code of each length less that code
+	const uint8_t *symbols;
+	} jpghuff;
+
+/* A component of the image */
+typedef struct jpgcomponent {
+	uint8_t		id;
+	uint8_t		hsamp, vsamp;			// The sampling factors
+	uint8_t		hshift, vshift;			// log2 of the upsampling needed
+	uint8_t		qt;						// The quantization table
+	uint8_t		dctable, actable;		// The huffman tables
+	} jpgcomponent;
+
+/* The decoder state - only allocated while the image is being decoded */
+typedef struct jpgdecode {
+	uint32_t	bitbuf;					// Bits read but not yet used (left justified)
+	uint8_t		bitcnt;					// The number of bits in bitbuf
+	uint8_t		marker;					// A marker found in the data (no more bits until it is dealt with)
+	bool_t		err;					// Bad or missing data
+	uint16_t	inpos, inlen;			// The unread bytes in inbuf
+	int16_t		dcpred[3];				// The DC predictors
+	coord_t		cw[3];					// The width of each component's sample buffer
+	uint8_t *	samples[3];				// A row of MCU's for each component
+	pixel_t *	pixels;					// A row of MCU's converted to pixels
+	jpghuff		huff[4];				// DC tables 0 and 1 then AC tables 0 and 1
+	int16_t		qt[4][64];				// The quantization tables (natural order, scaled for the IDCT)
+	int16_t		coef[64];				// The block being decoded
+	int32_t		ws[64];					// The IDCT work space
+	uint8_t		inbuf[GDISP_IMAGE_JPG_FILE_BUFFER_SIZE];
+	} jpgdecode;
+
+typedef struct gdispImagePrivate {
+	uint8_t		ncomps;					// 1 (greyscale) or 3 (YCbCr)
+	uint8_t		hmax, vmax;				// The largest sampling factors
+	uint8_t		scale;					// log2 of the scale denominator
+	uint8_t		qtdefined;				// Which quantization tables have been defined (a bit each)
+	uint8_t		htdefined;				// Which huffman tables have been defined (a bit each)
+	uint16_t	restart;				// The restart interval (in MCU's)
+	coord_t		fullwidth, fullheight;	// The unscaled image size
+	coord_t		mcusx, mcusy;			// The number of MCU's across and down
+	size_t		scanpos;				// Where the entropy coded data starts in the file
+	jpgcomponent comp[3];
+	uint8_t		qt[4][64];				// The quantization tables (zigzag order)
+	jpghuffspec	ht[4];					// DC tables 0 and 1 then AC tables 0 and 1
+	pixel_t *	frame0cache;
+	} gdispImagePrivate;
+
+/* The natural order of the zigzag coefficients (with extra entries for corrupt run lengths) */
+static const uint8_t	zigzag[64+16] = {
+	 0,  1,  8, 16,  9,  2,  3, 10, 17, 24, 32, 25, 18, 11,  4,  5,
+	12, 19, 26, 33, 40, 48, 41, 34, 27, 20, 13,  6,  7, 14, 21, 28,
+	35, 42, 49, 56, 57, 50, 43, 36, 29, 22, 15, 23, 30, 37, 44, 51,
+	58, 59, 52, 45, 38, 31, 39, 46, 53, 60, 61, 54, 47, 55, 62, 63,
+	63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63
+	};
+
+/* The AAN IDCT scale factors (natural order, 14 fractional bits) */
+static const uint16_t	aanscales[64] = {
+	16384, 22725, 21407, 19266, 16384, 12873,  8867,  4520,
+	22725, 31521, 29692, 26722, 22725, 17855, 12299,  6270,
+	21407, 29692, 27969, 25172, 21407, 16819, 11585,  5906,
+	19266, 26722, 25172, 22654, 19266, 15137, 10426,  5315,
+	16384, 22725, 21407, 19266, 16384, 12873,  8867,  4520,
+	12873, 17855, 16819, 15137, 12873, 10114,  6967,  3552,
+	 8867, 12299, 11585, 10426,  8867,  6967,  4799,  2446,
+	 4520,  6270,  5906,  5315,  4520,  3552,  2446,  1247
+	};
+
+/* The cosine tables for the reduced size IDCT's (12 fractional bits) - [x][u] */
+static const int16_t	idct4table[4*4] = {
+	1448,  1892,  1448,   784,
+	1448,   784, -1448, -1892,
+	1448,  -784, -1448,  1892,
+	1448, -1892,  1448,  -784
+	};
+static const int16_t	idct2table[2*2] = {
+	1448,  1448,
+	1448, -1448
+	};
+
+#define getBE16(p)		((((uint16_t)(p)[0])<<8)|((uint16_t)(p)[1]))
+#define clampSample(v)	((uint8_t)((v) < 0 ? 0 : ((v) > 255 ? 255 : (v))))
+
+/* Read len bytes of a marker segment, failing if the segment is too short */
+#define readSeg(p, n)	(seglen >= (n) && img->io.fns->read(&img->io, (p), (n)) == (n) && (seglen -= (n), TRUE))
+
+/**
+ * Get the next byte of the entropy coded data. The end of it isn't known until the bit reader
+ * finds the marker after it so the last refill may read up to a buffer past that marker.
+ */
+static uint8_t getByte(gdispImage *img, jpgdecode *d) {
+	if (d->inpos >= d->inlen) {
+		d->inlen = img->io.fns->read(&img->io, d->inbuf, GDISP_IMAGE_JPG_FILE_BUFFER_SIZE);
+		d->inpos = 0;
+		if (!d->inlen) {
+			d->err = TRUE;
+			return 0;
+		}
+	}
+	return d->inbuf[d->inpos++];
+}
+
+/* Make sure there are at least 25 bits in the bit buffer. After a marker the data is padded with zeros. */
+static void fillBits(gdispImage *img, jpgdecode *d) {
+	uint8_t		c;
+
+	while(d->bitcnt <= 24) {
+		c = 0;
+		if (!d->marker && !d->err) {
+			c = getByte(img, d);
+			if (c == 0xFF) {
+				/* 0xFF 0x00 is a stuffed 0xFF. Anything else is a marker. */
+				do {
+					c = getByte(img, d);
+				} while(c == 0xFF && !d->err);
+				if (c) {
+					d->marker = c;
+					c = 0;
+				} else
+					c = 0xFF;
+			}
+		}
+		d->bitbuf |= (uint32_t)c << (24 - d->bitcnt);
+		d->bitcnt += 8;
+	}
+}
+
+/* Get n bits (n <= 16) */
+static uint16_t getBits(gdispImage *img, jpgdecode *d, uint8_t n) {
+	uint16_t	v;
+
+	if (!n)
+		return 0;
+	if (d->bitcnt < n)
+		fillBits(img, d);
+	v = d->bitbuf >> (32 - n);
+	d->bitbuf <<= n;
+	d->bitcnt -= n;
+	return v;
+}
+
+/* Convert an n bit magnitude value to a signed value */
+static int16_t extend(uint16_t v, uint8_t n) {
+	return v < (1U << (n-1)) ? (int16_t)v - (int16_t)((1U << n) - 1) : (int16_t)v;
+}
+
+/* Build a decoding table. Returns FALSE if the table is invalid. */
+static bool_t buildHuff(jpghuff *h, const jpghuffspec *hs) {
+	uint32_t	code;
+	uint16_t	k, i, j;
+	uint8_t		len;
+
+	h->symbols = hs->symbols;
+	for(i = 0; i < (1<<HUFF_FAST_BITS); i++)
+		h->fast[i] = 0;
+	for(code = 0, k = 0, len = 1; len <= 16; len++, code <<= 1) {
+		h->valoff[len] = k - code;
+		if (code + hs->counts[len-1] > (1UL << len))
+			return FALSE;		// More codes than will fit in len bits
+		for(i = 0; i < hs->counts[len-1]; i++, k++, code++) {
+			if (len <= HUFF_FAST_BITS) {
+				for(j = 0; j < (1 << (HUFF_FAST_BITS - len)); j++)
+					h->fast[(code << (HUFF_FAST_BITS - len)) + j] = ((uint16_t)len << 8) | hs->symbols[k];
+			}
+		}
+		h->maxcode[len] = hs->counts[len-1] ? (int32_t)code - 1 : -1;
+	}
+	return TRUE;
+}
+
+/* Decode a huffman symbol. Returns -1 on an error. */
+static int16_t decodeHuff(gdispImage *img, jpgdecode *d, const jpghuff *h) {
+	uint16_t	e;
+	int32_t		code;
+	uint8_t		len;
+
+	if (d->bitcnt < 16)
+		fillBits(img, d);
+
+	/* Short codes are looked up directly */
+	if ((e = h->fast[d->bitbuf >> (32 - HUFF_FAST_BITS)])) {
+		len = e >> 8;
+		d->bitbuf <<= len;
+		d->bitcnt -= len;
+		return e & 0xFF;
+	}
+
+	/* Longer codes */
+	for(len = HUFF_FAST_BITS+1; len <= 16; len++) {
+		code = d->bitbuf >> (32 - len);
+		if (code <= h->maxcode[len]) {
+			d->bitbuf <<= len;
+			d->bitcnt -= len;
+			return h->symbols[h->valoff[len] + code];
+		}
+	}
+	return -1;
+}
+
+/* The full size AAN IDCT */
+static void idct8(jpgdecode *d, uint8_t *out, coord_t stride) {
+	const int16_t *	in;
+	int32_t *		ws;
+	int32_t			tmp0, tmp1, tmp2, tmp3, tmp4, tmp5, tmp6, tmp7;
+	int32_t			tmp10, tmp11, tmp12, tmp13;
+	int32_t			z5, z10, z11, z12, z13;
+	uint8_t			i;
+
+	/* Pass 1: the columns */
+	for(in = d->coef, ws = d->ws, i = 0; i < 8; i++, in++, ws++) {
+		if (!in[8] && !in[16] && !in[24] && !in[32] && !in[40] && !in[48] && !in[56]) {
+			ws[0] = ws[8] = ws[16] = ws[24] = ws[32] = ws[40] = ws[48] = ws[56] = in[0];
+			continue;
+		}
+
+		/* Even part */
+		tmp10 = in[0] + in[32];
+		tmp11 = in[0] - in[32];
+		tmp13 = in[16] + in[48];
+		tmp12 = IDCT_MULTIPLY(in[16] - in[48], FIX_1_414213562) - tmp13;
+		tmp0 = tmp10 + tmp13;
+		tmp3 = tmp10 - tmp13;
+		tmp1 = tmp11 + tmp12;
+		tmp2 = tmp11 - tmp12;
+
+		/* Odd part */
+		z13 = in[40] + in[24];
+		z10 = in[40] - in[24];
+		z11 = in[8] + in[56];
+		z12 = in[8] - in[56];
+		tmp7 = z11 + z13;
+		tmp11 = IDCT_MULTIPLY(z11 - z13, FIX_1_414213562);
+		z5 = IDCT_MULTIPLY(z10 + z12, FIX_1_847759065);
+		tmp10 = IDCT_MULTIPLY(z12, FIX_1_082392200) - z5;
+		tmp12 = z5 - IDCT_MULTIPLY(z10, FIX_2_613125930);
+		tmp6 = tmp12 - tmp7;
+		tmp5 = tmp11 - tmp6;
+		tmp4 = tmp10 + tmp5;
+
+		ws[0] = tmp0 + tmp7;
+		ws[56] = tmp0 - tmp7;
+		ws[8] = tmp1 + tmp6;
+		ws[48] = tmp1 - tmp6;
+		ws[16] = tmp2 + tmp5;
+		ws[40] = tmp2 - tmp5;
+		ws[32] = tmp3 + tmp4;
+		ws[24] = tmp3 - tmp4;
+	}
+
+	/* Pass 2: the rows */
+	#define DESCALE(v)	clampSample((((v) + (1 << (IDCT_SCALE_BITS+2))) >> (IDCT_SCALE_BITS+3)) + 128)
+	for(ws = d->ws, i = 0; i < 8; i++, ws += 8, out += stride) {
+		/* Even part */
+		tmp10 = ws[0] + ws[4];
+		tmp11 = ws[0] - ws[4];
+		tmp13 = ws[2] + ws[6];
+		tmp12 = IDCT_MULTIPLY(ws[2] - ws[6], FIX_1_414213562) - tmp13;
+		tmp0 = tmp10 + tmp13;
+		tmp3 = tmp10 - tmp13;
+		tmp1 = tmp11 + tmp12;
+		tmp2 = tmp11 - tmp12;
+
+		/* Odd part */
+		z13 = ws[5] + ws[3];
+		z10 = ws[5] - ws[3];
+		z11 = ws[1] + ws[7];
+		z12 = ws[1] - ws[7];
+		tmp7 = z11 + z13;
+		tmp11 = IDCT_MULTIPLY(z11 - z13, FIX_1_414213562);
+		z5 = IDCT_MULTIPLY(z10 + z12, FIX_1_847759065);
+		tmp10 = IDCT_MULTIPLY(z12, FIX_1_082392200) - z5;
+		tmp12 = z5 - IDCT_MULTIPLY(z10, FIX_2_613125930);
+		tmp6 = tmp12 - tmp7;
+		tmp5 = tmp11 - tmp6;
+		tmp4 = tmp10 + tmp5;
+
+		out[0] = DESCALE(tmp0 + tmp7);
+		out[7] = DESCALE(tmp0 - tmp7);
+		out[1] = DESCALE(tmp1 + tmp6);
+		out[6] = DESCALE(tmp1 - tmp6);
+		out[2] = DESCALE(tmp2 + tmp5);
+		out[5] = DESCALE(tmp2 - tmp5);
+		out[4] = DESCALE(tmp3 + tmp4);
+		out[3] = DESCALE(tmp3 - tmp4);
+	}
+	#undef DESCALE
+}
+
+/* A reduced size IDCT (n = 4 or 2) using only the lowest frequency coefficients */
+static void idctReduced(jpgdecode *d, uint8_t *out, coord_t stride, uint8_t n, const int16_t *table) {
+	int32_t		v;
+	uint8_t		x, y, u;
+
+	/* Pass 1: the columns. ws[y][u] keeps 2 extra fractional bits. */
+	for(y = 0; y < n; y++) {
+		for(u = 0; u < n; u++) {
+			for(v = 0, x = 0; x < n; x++)
+				v += (int32_t)table[y*n+x] * d->coef[x*8+u];
+			d->ws[y*8+u] = v >> 10;
+		}
+	}
+
+	/* Pass 2: the rows */
+	for(y = 0; y < n; y++, out += stride) {
+		for(x = 0; x < n; x++) {
+			for(v = 0, u = 0; u < n; u++)
+				v += (int32_t)table[x*n+u] * d->ws[y*8+u];
+			v = ((v + (1 << 13)) >> 14) + 128;
+			out[x] = clampSample(v);
+		}
+	}
+}
+
+/**
+ * Decode a block of component c.
+ * If out is set the block is transformed into it (a block is 8 >> scale samples square).
+ * Returns FALSE on bad data.
+ */
+static bool_t decodeBlock(gdispImage *img, jpgdecode *d, uint8_t c, uint8_t *out, coord_t stride) {
+	gdispImagePrivate *	priv;
+	const int16_t *		q;
+	int32_t				v;
+	int16_t				s;
+	uint8_t				k, n, nat, lim;
+
+	priv = img->priv;
+	q = d->qt[priv->comp[c].qt];
+
+	/* The DC coefficient */
+	if ((s = decodeHuff(img, d, &d->huff[priv->comp[c].dctable])) < 0 || s > 11)
+		return FALSE;
+	if (s)
+		d->dcpred[c] += extend(getBits(img, d, s), s);
+
+	/* Reduced size IDCT's only use the coefficients in the top left corner */
+	lim = 8 >> priv->scale;
+	if (out) {
+		memset(d->coef, 0, sizeof(d->coef));
+		v = (int32_t)d->dcpred[c] * q[0];
+		d->coef[0] = v < -32768 ? -32768 : (v > 32767 ? 32767 : v);
+	}
+
+	/* The AC coefficients */
+	for(k = 1; k < 64; k++) {
+		if ((s = decodeHuff(img, d, &d->huff[2+priv->comp[c].actable])) < 0)
+			return FALSE;
+		n = s & 0x0F;
+		if (!n) {
+			if (s != 0xF0)		// End of block
+				break;
+			k += 15;			// A run of 16 zeros
+			continue;
+		}
+		k += s >> 4;
+		v = extend(getBits(img, d, n), n);
+		if (out && k < 64) {
+			nat = zigzag[k];
+			if ((nat & 7) < lim && (nat >> 3) < lim) {
+				v *= q[nat];
+				d->coef[nat] = v < -32768 ? -32768 : (v > 32767 ? 32767 : v);
+			}
+		}
+	}
+	if (k > 64)
+		return FALSE;
+
+	if (out) {
+		switch(priv->scale) {
+		case 0:
+			idct8(d, out, stride);
+			break;
+		case 1:
+			idctReduced(d, out, stride, 4, idct4table);
+			break;
+		case 2:
+			idctReduced(d, out, stride, 2, idct2table);
+			break;
+		default:
+			v = ((d->coef[0] + 4) >> 3) + 128;
+			out[0] = clampSample(v);
+			break;
+		}
+	}
+	return TRUE;
+}
+
+/* Skip to the next restart marker and reset the decoder */
+static void restart(gdispImage *img, jpgdecode *d) {
+	uint8_t		c;
+
+	d->bitbuf = 0;
+	d->bitcnt = 0;
+	if (!d->marker) {
+		/* Find the marker */
+		while(!d->err) {
+			if (getByte(img, d) != 0xFF)
+				continue;
+			do {
+				c = getByte(img, d);
+			} while(c == 0xFF && !d->err);
+			if (c) {
+				d->marker = c;
+				break;
+			}
+		}
+	}
+
+	/* Only a restart marker lets us carry on */
+	if (d->marker >= 0xD0 && d->marker <= 0xD7)
+		d->marker = 0;
+	d->dcpred[0] = d->dcpred[1] = d->dcpred[2] = 0;
+}
+
+/**
+ * Convert rows [r0, r1) of the current row of MCU's to pixels for image columns [x0, x1).
+ * The first pixel goes to dst which has the given stride.
+ */
+static void convertRows(gdispImagePrivate *priv, jpgdecode *d, pixel_t *dst, coord_t stride, coord_t r0, coord_t r1, coord_t x0, coord_t x1) {
+	const uint8_t	*py, *pcb, *pcr;
+	pixel_t *		p;
+	int32_t			y, cb, cr, r, g, b;
+	coord_t			x;
+
+	for(; r0 < r1; r0++, dst += stride) {
+		p = dst;
+		py = d->samples[0] + (size_t)(r0 >> priv->comp[0].vshift) * d->cw[0];
+		if (priv->ncomps == 1) {
+			for(x = x0; x < x1; x++) {
+				y = py[x];
+				*p++ = RGB2COLOR(y, y, y);
+			}
+			continue;
+		}
+		pcb = d->samples[1] + (size_t)(r0 >> priv->comp[1].vshift) * d->cw[1];
+		pcr = d->samples[2] + (size_t)(r0 >> priv->comp[2].vshift) * d->cw[2];
+		for(x = x0; x < x1; x++) {
+			y = py[x >> priv->comp[0].hshift];
+			cb = (int32_t)pcb[x >> priv->comp[1].hshift] - 128;
+			cr = (int32_t)pcr[x >> priv->comp[2].hshift] - 128;
+			r = y + ((91881 * cr + 32768) >> 16);
+			g = y - ((22554 * cb + 46802 * cr - 32768) >> 16);
+			b = y + ((116130 * cb + 32768) >> 16);
+			*p++ = RGB2COLOR(clampSample(r), clampSample(g), clampSample(b));
+		}
+	}
+}
+
+/**
+ * Decode the image.
+ * If the cache is allocated the whole image is decoded into it.
+ * Otherwise the area sx, sy, cx, cy of the image is drawn at x, y.
+ */
+static gdispImageError decodeImage(gdispImage *img, coord_t x, coord_t y, coord_t cx, coord_t cy, coord_t sx, coord_t sy) {
+	gdispImagePrivate *	priv;
+	jpgdecode *			d;
+	uint8_t *			p;
+	size_t				len;
+	coord_t				bs, mcuw, mcuh, mx, my, top, r0, r1;
+	uint16_t			todo;
+	uint8_t				c, bx, by;
+	bool_t				visible;
+
+	priv = img->priv;
+	bs = 8 >> priv->scale;
+	mcuw = priv->hmax * bs;
+	mcuh = priv->vmax * bs;
+
+	/* Allocate the decoder, a row of MCU's for each component and (if not caching) the pixels for a row */
+	len = sizeof(jpgdecode);
+	for(c = 0; c < priv->ncomps; c++)
+		len += (size_t)priv->mcusx * priv->comp[c].hsamp * bs * priv->comp[c].vsamp * bs;
+	if (!priv->frame0cache)
+		len += (size_t)cx * mcuh * sizeof(pixel_t);
+	if (!(d = (jpgdecode *)chHeapAlloc(NULL, len)))
+		return GDISP_IMAGE_ERR_NOMEMORY;
+	d->pixels = (pixel_t *)(d+1);
+	p = (uint8_t *)(d->pixels + (priv->frame0cache ? 0 : (size_t)cx * mcuh));
+	for(c = 0; c < priv->ncomps; c++) {
+		d->samples[c] = p;
+		d->cw[c] = priv->mcusx * priv->comp[c].hsamp * bs;
+		p += (size_t)d->cw[c] * priv->comp[c].vsamp * bs;
+	}
+
+	/* Initialise the decoder */
+	d->bitbuf = 0;
+	d->bitcnt = 0;
+	d->marker = 0;
+	d->err = FALSE;
+	d->inpos = d->inlen = 0;
+	d->dcpred[0] = d->dcpred[1] = d->dcpred[2] = 0;
+	for(c = 0; c < 4; c++) {
+		if ((priv->htdefined & (1 << c)) && !buildHuff(&d->huff[c], &priv->ht[c]))
+			goto baddata;
+	}
+	for(c = 0; c < 4; c++) {
+		for(bx = 0; bx < 64; bx++) {
+			if (priv->scale)
+				d->qt[c][zigzag[bx]] = priv->qt[c][bx];
+			else
+				d->qt[c][zigzag[bx]] = ((uint32_t)priv->qt[c][bx] * aanscales[zigzag[bx]] + (1 << (13-IDCT_SCALE_BITS))) >> (14-IDCT_SCALE_BITS);
+		}
+	}
+	img->io.fns->seek(&img->io, priv->scanpos);
+
+	todo = priv->restart;
+	for(my = 0, top = 0; my < priv->mcusy; my++, top += mcuh) {
+		/* Once past the area there is nothing more to draw */
+		if (top >= sy + cy)
+			break;
+
+		for(mx = 0; mx < priv->mcusx; mx++) {
+			if (priv->restart) {
+				if (!todo) {
+					restart(img, d);
+					todo = priv->restart;
+				}
+				todo--;
+			}
+
+			/* Only transform the MCU's that are seen */
+			visible = top + mcuh > sy && mx * mcuw < sx + cx && (mx + 1) * mcuw > sx;
+			for(c = 0; c < priv->ncomps; c++) {
+				for(by = 0; by < priv->comp[c].vsamp; by++) {
+					for(bx = 0; bx < priv->comp[c].hsamp; bx++) {
+						if (!decodeBlock(img, d, c, visible ? d->samples[c] + (size_t)by * bs * d->cw[c] + (mx * priv->comp[c].hsamp + bx) * bs : 0, d->cw[c]))
+							goto baddata;
+					}
+				}
+			}
+		}
+
+		/* Output the rows of this row of MCU's that are in the area */
+		r0 = top < sy ? sy - top : 0;
+		r1 = top + mcuh > sy + cy ? sy + cy - top : mcuh;
+		if (r0 >= r1)
+			continue;
+		if (priv->frame0cache)
+			convertRows(priv, d, priv->frame0cache + (size_t)(top + r0) * img->width, img->width, r0, r1, 0, img->width);
+		else {
+			convertRows(priv, d, d->pixels, cx, r0, r1, sx, sx + cx);
+			gdispBlitAreaEx(x, y + top + r0 - sy, cx, r1 - r0, 0, 0, cx, d->pixels);
+		}
+	}
+
+	chHeapFree((void *)d);
+	return GDISP_IMAGE_ERR_OK;
+
+baddata:
+	chHeapFree((void *)d);
+	return GDISP_IMAGE_ERR_BADDATA;
+}
+
+/* Work out the scaled image size */
+static void setSize(gdispImage *img) {
+	gdispImagePrivate *	priv;
+
+	priv = img->priv;
+	img->width = (priv->fullwidth + (1 << priv->scale) - 1) >> priv->scale;
+	img->height = (priv->fullheight + (1 << priv->scale) - 1) >> priv->scale;
+}
+
+gdispImageError gdispImageOpen_JPG(gdispImage *img) {
+	gdispImagePrivate *	priv;
+	uint8_t				b[17];
+	uint16_t			seglen, i, n;
+	uint8_t				c, j;
+
+	/* Read the file identifier */
+	if (img->io.fns->read(&img->io, b, 2) != 2)
+		return GDISP_IMAGE_ERR_BADFORMAT;		// It can't be us
+
+	if (b[0] != 0xFF || b[1] != 0xD8)
+		return GDISP_IMAGE_ERR_BADFORMAT;		// It can't be us
+
+	/* We know we are a JPG format image */
+	img->type = GDISP_IMAGE_TYPE_JPG;
+	img->flags = 0;
+
+	/* Allocate our private area */
+	if (!(img->priv = (gdispImagePrivate *)chHeapAlloc(NULL, sizeof(gdispImagePrivate))))
+		return GDISP_IMAGE_ERR_NOMEMORY;
+	img->membytes = sizeof(gdispImagePrivate);
+
+	/* Initialise the essential bits in the private area */
+	priv = img->priv;
+	priv->ncomps = 0;
+	priv->scale = 0;
+	priv->qtdefined = 0;
+	priv->htdefined = 0;
+	priv->restart = 0;
+	priv->frame0cache = 0;
+
+	/* Read the marker segments up to the start of the scan */
+	while(1) {
+		/* Find the next marker (skipping any fill bytes) */
+		if (img->io.fns->read(&img->io, b, 2) != 2 || b[0] != 0xFF)
+			goto baddatacleanup;
+		while(b[1] == 0xFF) {
+			if (img->io.fns->read(&img->io, b+1, 1) != 1)
+				goto baddatacleanup;
+		}
+		if (b[1] == 0xD9)				// End of image
+			goto baddatacleanup;
+		if (b[1] == 0x01 || (b[1] >= 0xD0 && b[1] <= 0xD7))		// Markers without a segment
+			continue;
+		c = b[1];
+
+		/* Get the segment length (not including the length itself) */
+		if (img->io.fns->read(&img->io, b, 2) != 2 || getBE16(b) < 2)
+			goto baddatacleanup;
+		seglen = getBE16(b) - 2;
+
+		switch(c) {
+		case 0xC0:				// SOF0 - Baseline
+		case 0xC1:				// SOF1 - Extended sequential huffman
+			if (priv->ncomps || !readSeg(b, 6))
+				goto baddatacleanup;
+			if (b[0] != 8)								// Only 8 bit samples
+				goto unsupportedcleanup;
+			priv->fullheight = getBE16(b+1);
+			priv->fullwidth = getBE16(b+3);
+			priv->ncomps = b[5];
+			if (priv->fullheight <= 0 || priv->fullwidth <= 0)	// No DNL support and not too big
+				goto unsupportedcleanup;
+			if (priv->ncomps != 1 && priv->ncomps != 3)
+				goto unsupportedcleanup;
+			priv->hmax = priv->vmax = 1;
+			for(i = 0; i < priv->ncomps; i++) {
+				if (!readSeg(b, 3))
+					goto baddatacleanup;
+				priv->comp[i].id = b[0];
+				priv->comp[i].hsamp = b[1] >> 4;
+				priv->comp[i].vsamp = b[1] & 0x0F;
+				priv->comp[i].qt = b[2];
+				if (priv->comp[i].hsamp < 1 || priv->comp[i].hsamp > 4 || priv->comp[i].vsamp < 1 || priv->comp[i].vsamp > 4 || b[2] > 3)
+					goto baddatacleanup;
+				if (priv->comp[i].hsamp > priv->hmax) priv->hmax = priv->comp[i].hsamp;
+				if (priv->comp[i].vsamp > priv->vmax) priv->vmax = priv->comp[i].vsamp;
+			}
+
+			/* A single component scan is never interleaved so the sampling factors don't matter */
+			if (priv->ncomps == 1)
+				priv->comp[0].hsamp = priv->comp[0].vsamp = priv->hmax = priv->vmax = 1;
+
+			/* We only upsample by powers of 2 */
+			for(i = 0; i < priv->ncomps; i++) {
+				for(j = 0; (priv->comp[i].hsamp << j) < priv->hmax; j++);
+				if ((priv->comp[i].hsamp << j) != priv->hmax || j > 2)
+					goto unsupportedcleanup;
+				priv->comp[i].hshift = j;
+				for(j = 0; (priv->comp[i].vsamp << j) < priv->vmax; j++);
+				if ((priv->comp[i].vsamp << j) != priv->vmax || j > 2)
+					goto unsupportedcleanup;
+				priv->comp[i].vshift = j;
+			}
+			priv->mcusx = (priv->fullwidth + priv->hmax * 8 - 1) / (priv->hmax * 8);
+			priv->mcusy = (priv->fullheight + priv->vmax * 8 - 1) / (priv->vmax * 8);
+			break;
+
+		case 0xC2: case 0xC3: case 0xC5: case 0xC6: case 0xC7:		// Progressive, lossless and hierarchical
+		case 0xC9: case 0xCA: case 0xCB: case 0xCD: case 0xCE: case 0xCF:	// Arithmetic coding
+			goto unsupportedcleanup;
+
+		case 0xC4:				// DHT - Huffman tables
+			while(seglen) {
+				if (!readSeg(b, 17))
+					goto baddatacleanup;
+				c = b[0] & 0x0F;
+				if (c > 1 || (b[0] >> 4) > 1)
+					goto baddatacleanup;
+				if (b[0] >> 4)
+					c += 2;			// An AC table
+				for(n = 0, i = 0; i < 16; i++)
+					n += priv->ht[c].counts[i] = b[i+1];
+				if (n > 256 || !readSeg(priv->ht[c].symbols, n))
+					goto baddatacleanup;
+				priv->htdefined |= 1 << c;
+			}
+			break;
+
+		case 0xDB:				// DQT - Quantization tables
+			while(seglen) {
+				if (!readSeg(b, 1))
+					goto baddatacleanup;
+				if (b[0] >> 4)			// 16 bit tables are only used with 12 bit samples
+					goto unsupportedcleanup;
+				c = b[0] & 0x0F;
+				if (c > 3 || !readSeg(priv->qt[c], 64))
+					goto baddatacleanup;
+				priv->qtdefined |= 1 << c;
+			}
+			break;
+
+		case 0xDD:				// DRI - Restart interval
+			if (!readSeg(b, 2))
+				goto baddatacleanup;
+			priv->restart = getBE16(b);
+			break;
+
+		case 0xDA:				// SOS - Start of scan
+			if (!priv->ncomps || !readSeg(b, 1))
+				goto baddatacleanup;
+			if (b[0] != priv->ncomps)		// Only a single interleaved scan is supported
+				goto unsupportedcleanup;
+			for(i = 0; i < priv->ncomps; i++) {
+				if (!readSeg(b, 2))
+					goto baddatacleanup;
+				for(c = 0; c < priv->ncomps && priv->comp[c].id != b[0]; c++);
+				if (c != i || (b[1] >> 4) > 1 || (b[1] & 0x0F) > 1)
+					goto baddatacleanup;
+				priv->comp[c].dctable = b[1] >> 4;
+				priv->comp[c].actable = b[1] & 0x0F;
+				if (!(priv->htdefined & (1 << priv->comp[c].dctable)) || !(priv->htdefined & (4 << priv->comp[c].actable))
+						|| !(priv->qtdefined & (1 << priv->comp[c].qt)))
+					goto baddatacleanup;
+			}
+			if (!readSeg(b, 3))
+				goto baddatacleanup;
+			priv->scanpos = img->io.pos + seglen;
+			setSize(img);
+			return GDISP_IMAGE_ERR_OK;
+
+		default:				// Anything else (APPn, COM etc) is skipped
+			break;
+		}
+
+		/* Skip the rest of the segment */
+		img->io.fns->seek(&img->io, img->io.pos + seglen);
+	}
+
+baddatacleanup:
+	gdispImageClose_JPG(img);				// Clean up the private data area
+	return GDISP_IMAGE_ERR_BADDATA;			// Oops - something wrong
+
+unsupportedcleanup:
+	gdispImageClose_JPG(img);				// Clean up the private data area
+	return GDISP_IMAGE_ERR_UNSUPPORTED;		// Not supported
+}
+
+void gdispImageClose_JPG(gdispImage *img) {
+	if (img->priv) {
+		if (img->priv->frame0cache)
+			chHeapFree((void *)img->priv->frame0cache);
+		chHeapFree((void *)img->priv);
+		img->priv = 0;
+	}
+	img->type = GDISP_IMAGE_TYPE_UNKNOWN;
+	img->membytes = 0;
+	img->io.fns->close(&img->io);
+}
+
+gdispImageError gdispImageSetScale_JPG(gdispImage *img, uint8_t scale) {
+	gdispImagePrivate *	priv;
+	uint8_t				shift;
+
+	if (img->type != GDISP_IMAGE_TYPE_JPG || !img->priv)
+		return GDISP_IMAGE_ERR_BADFORMAT;
+	for(shift = 0; shift < 4 && (1 << shift) != scale; shift++);
+	if (shift >= 4)
+		return GDISP_IMAGE_ERR_UNSUPPORTED;
+
+	/* Throw away any cache at the old size */
+	priv = img->priv;
+	if (priv->frame0cache) {
+		chHeapFree((void *)priv->frame0cache);
+		img->membytes -= (size_t)img->width * img->height * sizeof(pixel_t);
+		priv->frame0cache = 0;
+	}
+	priv->scale = shift;
+	setSize(img);
+	return GDISP_IMAGE_ERR_OK;
+}
+
+gdispImageError gdispImageCache_JPG(gdispImage *img) {
+	gdispImagePrivate *	priv;
+	gdispImageError		err;
+	size_t				len;
+
+	/* If we are already cached - just return OK */
+	priv = img->priv;
+	if (priv->frame0cache)
+		return GDISP_IMAGE_ERR_OK;
+
+	/* We need to allocate the cache */
+	len = (size_t)img->width * img->height * sizeof(pixel_t);
+	if (!(priv->frame0cache = (pixel_t *)chHeapAlloc(NULL, len)))
+		return GDISP_IMAGE_ERR_NOMEMORY;
+
+	/* Decode the entire image into the cache */
+	if ((err = decodeImage(img, 0, 0, img->width, img->height, 0, 0)) != GDISP_IMAGE_ERR_OK) {
+		chHeapFree((void *)priv->frame0cache);
+		priv->frame0cache = 0;
+		return err;
+	}
+	img->membytes += len;
+	return GDISP_IMAGE_ERR_OK;
+}
+
+gdispImageError gdispImageDraw_JPG(gdispImage *img, coord_t x, coord_t y, coord_t cx, coord_t cy, coord_t sx, coord_t sy) {
+	gdispImagePrivate *	priv;
+
+	priv = img->priv;
+
+	/* Check some reasonableness */
+	if (sx >= img->width || sy >= img->height) return GDISP_IMAGE_ERR_OK;
+	if (sx + cx > img->width) cx = img->width - sx;
+	if (sy + cy > img->height) cy = img->height - sy;
+
+	/* Draw from the image cache - if it exists */
+	if (priv->frame0cache) {
+		gdispBlitAreaEx(x, y, cx, cy, sx, sy, img->width, priv->frame0cache);
+		return GDISP_IMAGE_ERR_OK;
+	}
+
+	return decodeImage(img, x, y, cx, cy, sx, sy);
+}
+
+systime_t gdispImageNext_JPG(gdispImage *img) {
+	(void) img;
+
+	/* No more frames/pages */
+	return TIME_INFINITE;
+}
 
 #endif /* GFX_USE_GDISP && GDISP_NEED_IMAGE && GDISP_NEED_IMAGE_JPG */
 /** @} */
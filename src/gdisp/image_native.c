@@ -28,20 +28,215 @@
 
 #if GFX_USE_GDISP && GDISP_NEED_IMAGE && GDISP_NEED_IMAGE_NATIVE
 
+#ifndef GDISP_NEED_IMAGE_NATIVE_RLE
+	#define GDISP_NEED_IMAGE_NATIVE_RLE	TRUE
+#endif
+
 /**
  * How big a pixel array to allocate for blitting
  * Bigger is faster but uses more RAM.
  */
 #define BLIT_BUFFER_SIZE	32
 
+/**
+ * How many bytes of RLE data to read from the file at a time
+ */
+#define FILE_BUFFER_SIZE	64
+
+/**
+ * Repeat runs shorter than this are blitted along with their neighbours rather than filled
+ */
+#define RLE_MIN_FILL		4
+
 #define HEADER_SIZE			8
 #define FRAME0POS			(HEADER_SIZE)
 
+/* Flags for the nativeflags field */
+#define NATIVE_RLE			0x01		// The pixel data is RLE compressed
+
 typedef struct gdispImagePrivate {
 	pixel_t		*frame0cache;
+	#if GDISP_NEED_IMAGE_NATIVE_RLE
+		uint8_t		nativeflags;
+		uint8_t		inpos;
+		uint8_t		inlen;
+		size_t		inend;			// The file position of the end of the RLE data
+		uint8_t		inbuf[FILE_BUFFER_SIZE];
+	#endif
 	pixel_t		buf[BLIT_BUFFER_SIZE];
 	} gdispImagePrivate;
 
+#if GDISP_NEED_IMAGE_NATIVE_RLE
+	/* Read entry y of the row offset table. Entry height is the end of the RLE data. */
+	static bool_t readRowOffset(gdispImage *img, coord_t y, size_t *pos) {
+		uint8_t		b[4];
+
+		img->io.fns->seek(&img->io, FRAME0POS + (size_t)y * 4);
+		if (img->io.fns->read(&img->io, b, 4) != 4)
+			return FALSE;
+		*pos = (((uint32_t)b[0])<<24) | (((uint32_t)b[1])<<16) | (((uint32_t)b[2])<<8) | b[3];
+		return TRUE;
+	}
+
+	/* Seek to the RLE data for row y */
+	static bool_t seekRLE(gdispImage *img, coord_t y) {
+		size_t		pos;
+
+		if (!readRowOffset(img, y, &pos))
+			return FALSE;
+		img->io.fns->seek(&img->io, pos);
+		img->priv->inpos = img->priv->inlen = 0;
+		return TRUE;
+	}
+
+	/* Get the next byte of RLE data. Returns -1 at the end of the data. */
+	static int getByte(gdispImage *img) {
+		gdispImagePrivate *	priv;
+		size_t				len;
+
+		priv = img->priv;
+		if (priv->inpos >= priv->inlen) {
+			/* Never read past the end of the RLE data - the image may be in memory of just that size */
+			len = img->io.pos < priv->inend ? priv->inend - img->io.pos : 0;
+			if (len > FILE_BUFFER_SIZE)
+				len = FILE_BUFFER_SIZE;
+			priv->inlen = len ? img->io.fns->read(&img->io, priv->inbuf, len) : 0;
+			priv->inpos = 0;
+			if (!priv->inlen)
+				return -1;
+		}
+		return priv->inbuf[priv->inpos++];
+	}
+
+	/* Get the next pixel of RLE data */
+	static bool_t getPixel(gdispImage *img, pixel_t *pc) {
+		uint8_t		*p;
+		unsigned	i;
+		int			c;
+
+		for(p = (uint8_t *)pc, i = 0; i < sizeof(pixel_t); i++) {
+			if ((c = getByte(img)) < 0)
+				return FALSE;
+			p[i] = c;
+		}
+		return TRUE;
+	}
+
+	/*
+	 * Decode a row of RLE data. If dst is set the whole row is stored there. Otherwise
+	 * columns sx to sx+cx-1 are drawn at x,y - repeat runs are drawn as fills and everything
+	 * else is gathered up and blitted. Consecutive repeat runs of the same color are joined
+	 * into a single fill.
+	 */
+	static bool_t decodeRow(gdispImage *img, coord_t x, coord_t y, coord_t cx, coord_t sx, pixel_t *dst) {
+		gdispImagePrivate *	priv;
+		coord_t				mx, ex, n, bx, blen, fx, flen, st, en;
+		pixel_t				color, fcolor;
+		int					c;
+
+		priv = img->priv;
+		ex = sx + cx;
+		bx = blen = fx = flen = 0;
+		fcolor = 0;
+
+		for(mx = 0; mx < img->width; mx += n) {
+			if ((c = getByte(img)) < 0)
+				return FALSE;
+
+			/* A no-op */
+			if (c == 128) {
+				n = 0;
+				continue;
+			}
+
+			/* A literal run of c+1 pixels */
+			if (c < 128) {
+				n = c + 1;
+				if (mx + n > img->width)
+					return FALSE;
+				for(st = mx; st < mx + n; st++) {
+					if (!getPixel(img, &color))
+						return FALSE;
+					if (dst)
+						dst[st] = color;
+					else if (st >= sx && st < ex) {
+						if (flen) {
+							gdispFillArea(x+fx-sx, y, flen, 1, fcolor);
+							flen = 0;
+						}
+						if (!blen)
+							bx = st;
+						priv->buf[blen++] = color;
+						if (blen >= BLIT_BUFFER_SIZE) {
+							gdispBlitAreaEx(x+bx-sx, y, blen, 1, 0, 0, blen, priv->buf);
+							blen = 0;
+						}
+					}
+				}
+				continue;
+			}
+
+			/* A repeat run of 257-c pixels */
+			n = 257 - c;
+			if (mx + n > img->width || !getPixel(img, &color))
+				return FALSE;
+			if (dst) {
+				for(st = mx; st < mx + n; st++)
+					dst[st] = color;
+				continue;
+			}
+
+			/* Clip the run to the columns we want */
+			st = mx < sx ? sx : mx;
+			en = mx + n > ex ? ex : mx + n;
+			if (st >= en)
+				continue;
+
+			/* Join it to the fill we are building */
+			if (flen && fx + flen == st && fcolor == color) {
+				flen += en - st;
+				continue;
+			}
+
+			/* A short run is cheaper to blit with its neighbours */
+			if (en - st < RLE_MIN_FILL) {
+				if (flen) {
+					gdispFillArea(x+fx-sx, y, flen, 1, fcolor);
+					flen = 0;
+				}
+				for(; st < en; st++) {
+					if (!blen)
+						bx = st;
+					priv->buf[blen++] = color;
+					if (blen >= BLIT_BUFFER_SIZE) {
+						gdispBlitAreaEx(x+bx-sx, y, blen, 1, 0, 0, blen, priv->buf);
+						blen = 0;
+					}
+				}
+				continue;
+			}
+
+			/* Start a new fill */
+			if (blen) {
+				gdispBlitAreaEx(x+bx-sx, y, blen, 1, 0, 0, blen, priv->buf);
+				blen = 0;
+			}
+			if (flen)
+				gdispFillArea(x+fx-sx, y, flen, 1, fcolor);
+			fx = st;
+			flen = en - st;
+			fcolor = color;
+		}
+
+		/* Draw whatever is left */
+		if (blen)
+			gdispBlitAreaEx(x+bx-sx, y, blen, 1, 0, 0, blen, priv->buf);
+		if (flen)
+			gdispFillArea(x+fx-sx, y, flen, 1, fcolor);
+		return TRUE;
+	}
+#endif
+
 gdispImageError gdispImageOpen_NATIVE(gdispImage *img) {
 	uint8_t		hdr[HEADER_SIZE];
 
@@ -49,13 +244,18 @@ gdispImageError gdispImageOpen_NATIVE(gdispImage *img) {
 	if (img->io.fns->read(&img->io, hdr, 8) != 8)
 		return GDISP_IMAGE_ERR_BADFORMAT;		// It can't be us
 
-	if (hdr[0] != 'N' || hdr[1] != 'I')
+	#if GDISP_NEED_IMAGE_NATIVE_RLE
+		if (hdr[0] != 'N' || (hdr[1] != 'I' && hdr[1] != 'R'))
+	#else
+		if (hdr[0] != 'N' || hdr[1] != 'I')
+	#endif
 		return GDISP_IMAGE_ERR_BADFORMAT;		// It can't be us
 
 	if (hdr[6] != GDISP_PIXELFORMAT/256 || hdr[7] != (GDISP_PIXELFORMAT & 0xFF))
 		return GDISP_IMAGE_ERR_UNSUPPORTED;		// Unsupported pixel format
 
 	/* We know we are a native format image */
+	img->type = GDISP_IMAGE_TYPE_NATIVE;
 	img->flags = 0;
 	img->width = (((uint16_t)hdr[2])<<8) | (hdr[3]);
 	img->height = (((uint16_t)hdr[4])<<8) | (hdr[5]);
@@ -65,6 +265,17 @@ gdispImageError gdispImageOpen_NATIVE(gdispImage *img) {
 		return GDISP_IMAGE_ERR_NOMEMORY;
 	img->membytes = sizeof(gdispImagePrivate);
 	img->priv->frame0cache = 0;
+	#if GDISP_NEED_IMAGE_NATIVE_RLE
+		img->priv->nativeflags = hdr[1] == 'R' ? NATIVE_RLE : 0;
+
+		/* The last entry of the row table says where the RLE data ends */
+		if ((img->priv->nativeflags & NATIVE_RLE)) {
+			if (!readRowOffset(img, img->height, &img->priv->inend) || img->priv->inend < FRAME0POS + ((size_t)img->height + 1) * 4) {
+				gdispImageClose_NATIVE(img);			// Clean up the private data area
+				return GDISP_IMAGE_ERR_BADDATA;
+			}
+		}
+	#endif
 
 	return GDISP_IMAGE_ERR_OK;
 }
@@ -76,6 +287,7 @@ void gdispImageClose_NATIVE(gdispImage *img) {
 		chHeapFree((void *)img->priv);
 		img->priv = 0;
 	}
+	img->type = GDISP_IMAGE_TYPE_UNKNOWN;
 	img->membytes = 0;
 	img->io.fns->close(&img->io);
 }
@@ -94,12 +306,35 @@ gdispImageError gdispImageCache_NATIVE(gdispImage *img) {
 		return GDISP_IMAGE_ERR_NOMEMORY;
 	img->membytes += len;
 
+	#if GDISP_NEED_IMAGE_NATIVE_RLE
+		/* Decode the entire bitmap into cache */
+		if ((img->priv->nativeflags & NATIVE_RLE)) {
+			coord_t		y;
+
+			if (!seekRLE(img, 0))
+				goto baddatacleanup;
+			for(y = 0; y < img->height; y++) {
+				if (!decodeRow(img, 0, 0, 0, 0, img->priv->frame0cache + (size_t)y * img->width))
+					goto baddatacleanup;
+			}
+			return GDISP_IMAGE_ERR_OK;
+		}
+	#endif
+
 	/* Read the entire bitmap into cache */
 	img->io.fns->seek(&img->io, FRAME0POS);
 	if (img->io.fns->read(&img->io, img->priv->frame0cache, len) != len)
 		return GDISP_IMAGE_ERR_BADDATA;
 
 	return GDISP_IMAGE_ERR_OK;
+
+#if GDISP_NEED_IMAGE_NATIVE_RLE
+baddatacleanup:
+	chHeapFree((void *)img->priv->frame0cache);
+	img->priv->frame0cache = 0;
+	img->membytes -= len;
+	return GDISP_IMAGE_ERR_BADDATA;
+#endif
 }
 
 gdispImageError gdispImageDraw_NATIVE(gdispImage *img, coord_t x, coord_t y, coord_t cx, coord_t cy, coord_t sx, coord_t sy) {
@@ -117,8 +352,21 @@ gdispImageError gdispImageDraw_NATIVE(gdispImage *img, coord_t x, coord_t y, coo
 		return GDISP_IMAGE_ERR_OK;
 	}
 
+	#if GDISP_NEED_IMAGE_NATIVE_RLE
+		/* Use the row table to find the first row and then decode the rows one after another */
+		if ((img->priv->nativeflags & NATIVE_RLE)) {
+			if (!seekRLE(img, sy))
+				return GDISP_IMAGE_ERR_BADDATA;
+			for(;cy;cy--, y++) {
+				if (!decodeRow(img, x, y, cx, sx, 0))
+					return GDISP_IMAGE_ERR_BADDATA;
+			}
+			return GDISP_IMAGE_ERR_OK;
+		}
+	#endif
+
 	/* For this image decoder we cheat and just seek straight to the region we want to display */
-	pos = FRAME0POS + (img->width * sy + cx) * sizeof(pixel_t);
+	pos = FRAME0POS + ((size_t)img->width * sy + sx) * sizeof(pixel_t);
 
 	/* Cycle through the lines */
 	for(;cy;cy--, y++) {
@@ -130,7 +378,7 @@ gdispImageError gdispImageDraw_NATIVE(gdispImage *img, coord_t x, coord_t y, coo
 			// Read the data
 			len = img->io.fns->read(&img->io,
 						img->priv->buf,
-						mx > BLIT_BUFFER_SIZE ? (BLIT_BUFFER_SIZE*sizeof(pixel_t)) : (mx * sizeof(pixel_t)))
+						mcx > BLIT_BUFFER_SIZE ? (BLIT_BUFFER_SIZE*sizeof(pixel_t)) : (mcx * sizeof(pixel_t)))
 					/ sizeof(pixel_t);
 			if (!len)
 				return GDISP_IMAGE_ERR_BADDATA;
@@ -20,7 +20,9 @@
 
 /**
  * @file    src/gdisp/image_png.c
- * @brief   GDISP native image code.
+ * @brief   GDISP PNG image code.
+ * @details	The image data is inflated a row at a time into a (configurable) sliding
+ * 			window. Each row is unfiltered and converted straight to pixels for blitting.
  */
 #include "ch.h"
 #include "hal.h"
@@ -28,7 +30,996 @@
 
 #if GFX_USE_GDISP && GDISP_NEED_IMAGE && GDISP_NEED_IMAGE_PNG
 
-#error "PNG support not implemented yet"
+#include <string.h>
+
+/* Deflate limits */
+#define INFLATE_MAXBITS		15				// The longest huffman code
+#define INFLATE_MAXLCODES	288				// The number of literal/length codes
+#define INFLATE_MAXDCODES	30				// The number of distance codes
+#define INFLATE_FIXLCODES	288				// The number of fixed literal/length codes
+
+/* The inflate states */
+#define INFLATE_HEADER		0				// Read a block header
+#define INFLATE_STORED		1				// In a stored block
+#define INFLATE_CODES		2				// In a huffman coded block
+#define INFLATE_DONE		3				// At the end of the stream
+
+/* A canonical huffman code table */
+typedef struct pnghuff {
+	int16_t		count[INFLATE_MAXBITS+1];	// The number of codes of each length
+	int16_t *	symbol;						// The symbols in canonical order
+	} pnghuff;
+
+/* The decoder state - only allocated while the image is being decoded */
+typedef struct pngdecode {
+	/* The input */
+	uint32_t	chunkleft;					// The bytes left in the current IDAT chunk
+	uint16_t	inpos, inlen;				// The unread bytes in inbuf
+	uint32_t	bitbuf;						// Bits read but not yet used
+	uint8_t		bitcnt;						// The number of bits in bitbuf
+	bool_t		err;						// Bad or missing data
+
+	/* The inflate state */
+	uint8_t		state;
+	bool_t		final;						// This is the last block
+	uint16_t	stored;						// The bytes left in a stored block
+	uint16_t	copylen;					// The bytes left to copy from the window
+	uint16_t	copydist;					// How far back in the window to copy from
+	pnghuff		lencode;
+	pnghuff		distcode;
+	int16_t		lensym[INFLATE_MAXLCODES];
+	int16_t		distsym[INFLATE_MAXDCODES];
+	uint8_t		lengths[INFLATE_MAXLCODES+INFLATE_MAXDCODES];
+
+	/* The sliding window */
+	bool_t		wfull;						// The window has wrapped
+	uint32_t	wpos;						// The next byte to write
+	uint32_t	wsize;						// The size of the window
+	uint8_t *	window;
+
+	/* The rows */
+	uint8_t *	cur;						// The current row (with its filter type byte)
+	uint8_t *	prev;						// The previous row (with its filter type byte)
+	uint8_t		opaque[GDISP_IMAGE_PNG_BLIT_BUFFER_SIZE];	// Which converted pixels are not transparent
+	pixel_t		buf[GDISP_IMAGE_PNG_BLIT_BUFFER_SIZE];		// The converted pixels
+	uint8_t		inbuf[GDISP_IMAGE_PNG_FILE_BUFFER_SIZE];	// Data read from the file
+	} pngdecode;
+
+typedef struct gdispImagePrivate {
+	uint8_t		bitdepth;					// Bits per sample
+	uint8_t		colortype;					// The PNG color type
+		#define PNG_COLOR_GREY			0
+		#define PNG_COLOR_RGB			2
+		#define PNG_COLOR_PALETTE		3
+		#define PNG_COLOR_GREYALPHA		4
+		#define PNG_COLOR_RGBA			6
+	uint8_t		pngflags;
+		#define PNG_INTERLACED			0x01		// Adam7 interlacing
+		#define PNG_TRANS				0x02		// A tRNS chunk was found
+	uint8_t		bpp;						// Bytes per complete pixel (at least 1) for unfiltering
+	uint8_t		bitspp;						// Bits per pixel
+	uint16_t	transgrey;					// The transparent grey sample (tRNS)
+	uint16_t	transred, transgreen, transblue;	// The transparent color (tRNS)
+	uint16_t	palsize;					// The number of palette entries
+	pixel_t *	palette;					// The palette
+	uint8_t *	paltrans;					// Which palette entries are transparent (a bit each)
+	uint32_t	wsize;						// The inflate window size needed
+	size_t		idatpos;					// Where the first IDAT data starts in the file
+	uint32_t	idatlen;					// The length of the first IDAT chunk
+	pixel_t *	frame0cache;				// The cached image
+	uint8_t *	maskcache;					// Which cached pixels are not transparent (a bit each)
+	} gdispImagePrivate;
+
+/* Adam7 interlacing */
+static const uint8_t	adam7xstart[7]	= { 0, 4, 0, 2, 0, 1, 0 };
+static const uint8_t	adam7ystart[7]	= { 0, 0, 4, 0, 2, 0, 1 };
+static const uint8_t	adam7xstep[7]	= { 8, 8, 4, 4, 2, 2, 1 };
+static const uint8_t	adam7ystep[7]	= { 8, 8, 8, 4, 4, 2, 2 };
+
+/* Deflate length and distance code tables */
+static const uint16_t	lenbase[29]		= {	3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+											35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+static const uint8_t	lenextra[29]	= {	0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+											3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+static const uint16_t	distbase[30]	= {	1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+											257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
+											8193, 12289, 16385, 24577 };
+static const uint8_t	distextra[30]	= {	0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+											7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+/* The order the code length code lengths are stored in */
+static const uint8_t	lengthorder[19]	= { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+#define getBE32(p)		((((uint32_t)(p)[0])<<24)|(((uint32_t)(p)[1])<<16)|(((uint32_t)(p)[2])<<8)|((uint32_t)(p)[3]))
+#define getBE16(p)		((((uint16_t)(p)[0])<<8)|((uint16_t)(p)[1]))
+
+/* Get the next byte of the compressed data, moving on through the IDAT chunks */
+static uint8_t getByte(gdispImage *img, pngdecode *d) {
+	uint8_t		hdr[12];
+	size_t		len;
+
+	if (d->inpos >= d->inlen) {
+		while(!d->chunkleft) {
+			/* Skip the CRC and read the next chunk header */
+			if (img->io.fns->read(&img->io, hdr, 12) != 12 || hdr[8] != 'I' || hdr[9] != 'D' || hdr[10] != 'A' || hdr[11] != 'T') {
+				d->err = TRUE;
+				return 0;
+			}
+			d->chunkleft = getBE32(hdr+4);
+		}
+		len = d->chunkleft > GDISP_IMAGE_PNG_FILE_BUFFER_SIZE ? GDISP_IMAGE_PNG_FILE_BUFFER_SIZE : d->chunkleft;
+		if (img->io.fns->read(&img->io, d->inbuf, len) != len) {
+			d->err = TRUE;
+			return 0;
+		}
+		d->chunkleft -= len;
+		d->inpos = 0;
+		d->inlen = len;
+	}
+	return d->inbuf[d->inpos++];
+}
+
+/* Get n bits (n <= 16) of the compressed data */
+static uint16_t getBits(gdispImage *img, pngdecode *d, uint8_t n) {
+	uint16_t	v;
+
+	while(d->bitcnt < n) {
+		d->bitbuf |= (uint32_t)getByte(img, d) << d->bitcnt;
+		d->bitcnt += 8;
+	}
+	v = d->bitbuf & ((1UL << n) - 1);
+	d->bitbuf >>= n;
+	d->bitcnt -= n;
+	return v;
+}
+
+/* Build a huffman table from the code lengths. Returns FALSE if the lengths are over-subscribed. */
+static bool_t buildHuff(pnghuff *h, const uint8_t *length, uint16_t n) {
+	int16_t		offs[INFLATE_MAXBITS+1];
+	int16_t		left;
+	uint16_t	i;
+
+	for(i = 0; i <= INFLATE_MAXBITS; i++)
+		h->count[i] = 0;
+	for(i = 0; i < n; i++)
+		h->count[length[i]]++;
+
+	/* Incomplete codes are allowed - the missing codes are reported as errors when decoded */
+	for(left = 1, i = 1; i <= INFLATE_MAXBITS; i++) {
+		left <<= 1;
+		left -= h->count[i];
+		if (left < 0)
+			return FALSE;
+	}
+
+	for(offs[1] = 0, i = 1; i < INFLATE_MAXBITS; i++)
+		offs[i+1] = offs[i] + h->count[i];
+	for(i = 0; i < n; i++) {
+		if (length[i])
+			h->symbol[offs[length[i]]++] = i;
+	}
+	return TRUE;
+}
+
+/* Decode a symbol. Returns -1 on an error. */
+static int16_t decodeSym(gdispImage *img, pngdecode *d, const pnghuff *h) {
+	int32_t		code, first, index, count;
+	uint8_t		len;
+
+	code = first = index = 0;
+	for(len = 1; len <= INFLATE_MAXBITS; len++) {
+		code |= getBits(img, d, 1);
+		count = h->count[len];
+		if (code - count < first)
+			return h->symbol[index + (code - first)];
+		index += count;
+		first += count;
+		first <<= 1;
+		code <<= 1;
+	}
+	return -1;
+}
+
+/* Read the huffman tables for a dynamic block */
+static bool_t readDynamic(gdispImage *img, pngdecode *d) {
+	uint16_t	nlen, ndist, ncode, i;
+	int16_t		sym;
+	uint8_t		len, rep;
+
+	nlen = getBits(img, d, 5) + 257;
+	ndist = getBits(img, d, 5) + 1;
+	ncode = getBits(img, d, 4) + 4;
+	if (nlen > INFLATE_MAXLCODES || ndist > INFLATE_MAXDCODES)
+		return FALSE;
+
+	/* The code length code */
+	for(i = 0; i < 19; i++)
+		d->lengths[lengthorder[i]] = i < ncode ? getBits(img, d, 3) : 0;
+	if (!buildHuff(&d->lencode, d->lengths, 19))
+		return FALSE;
+
+	/* The literal/length and distance code lengths */
+	for(i = 0; i < nlen + ndist; ) {
+		if ((sym = decodeSym(img, d, &d->lencode)) < 0)
+			return FALSE;
+		if (sym < 16) {
+			d->lengths[i++] = sym;
+			continue;
+		}
+		len = 0;
+		if (sym == 16) {
+			if (!i)
+				return FALSE;
+			len = d->lengths[i-1];
+			rep = 3 + getBits(img, d, 2);
+		} else if (sym == 17)
+			rep = 3 + getBits(img, d, 3);
+		else
+			rep = 11 + getBits(img, d, 7);
+		if (i + rep > nlen + ndist)
+			return FALSE;
+		while(rep--)
+			d->lengths[i++] = len;
+	}
+
+	/* There must be an end of block code */
+	if (!d->lengths[256])
+		return FALSE;
+	return buildHuff(&d->lencode, d->lengths, nlen) && buildHuff(&d->distcode, d->lengths+nlen, ndist);
+}
+
+/* Read the fixed huffman tables */
+static void readFixed(pngdecode *d) {
+	uint16_t	i;
+
+	for(i = 0; i < 144; i++) d->lengths[i] = 8;
+	for(; i < 256; i++) d->lengths[i] = 9;
+	for(; i < 280; i++) d->lengths[i] = 7;
+	for(; i < INFLATE_FIXLCODES; i++) d->lengths[i] = 8;
+	buildHuff(&d->lencode, d->lengths, INFLATE_FIXLCODES);
+	for(i = 0; i < INFLATE_MAXDCODES; i++) d->lengths[i] = 5;
+	buildHuff(&d->distcode, d->lengths, INFLATE_MAXDCODES);
+}
+
+/* Add a byte to the output */
+#define putByte(d, p, c)	{ 	(d)->window[(d)->wpos] = *(p)++ = (c);				\
+								if (++(d)->wpos >= (d)->wsize) {					\
+									(d)->wpos = 0;									\
+									(d)->wfull = TRUE;								\
+								}													\
+							}
+
+/* Inflate len bytes into p. Returns FALSE on an error or if the data ends early. */
+static bool_t inflateBytes(gdispImage *img, pngdecode *d, uint8_t *p, size_t len) {
+	uint32_t	pos;
+	int16_t		sym;
+	uint8_t		b[4];
+
+	while(len) {
+		/* Finish any copy from the window */
+		if (d->copylen) {
+			pos = d->wpos >= d->copydist ? d->wpos - d->copydist : d->wpos + d->wsize - d->copydist;
+			do {
+				putByte(d, p, d->window[pos]);
+				if (++pos >= d->wsize)
+					pos = 0;
+				len--;
+			} while(--d->copylen && len);
+			continue;
+		}
+
+		switch(d->state) {
+		case INFLATE_HEADER:
+			if (d->final)
+				return FALSE;
+			d->final = getBits(img, d, 1);
+			switch(getBits(img, d, 2)) {
+			case 0:					// Stored
+				d->bitbuf >>= d->bitcnt & 7;
+				d->bitcnt &= ~7;
+				b[0] = getBits(img, d, 8);
+				b[1] = getBits(img, d, 8);
+				b[2] = getBits(img, d, 8);
+				b[3] = getBits(img, d, 8);
+				d->stored = b[0] | ((uint16_t)b[1] << 8);
+				if ((b[2] ^ b[0]) != 0xFF || (b[3] ^ b[1]) != 0xFF)
+					return FALSE;
+				d->state = INFLATE_STORED;
+				break;
+			case 1:					// Fixed huffman codes
+				readFixed(d);
+				d->state = INFLATE_CODES;
+				break;
+			case 2:					// Dynamic huffman codes
+				if (!readDynamic(img, d))
+					return FALSE;
+				d->state = INFLATE_CODES;
+				break;
+			default:
+				return FALSE;
+			}
+			break;
+
+		case INFLATE_STORED:
+			while(d->stored && len) {
+				putByte(d, p, getBits(img, d, 8));
+				d->stored--;
+				len--;
+			}
+			if (!d->stored)
+				d->state = INFLATE_HEADER;
+			break;
+
+		case INFLATE_CODES:
+			if ((sym = decodeSym(img, d, &d->lencode)) < 0)
+				return FALSE;
+			if (sym < 256) {
+				putByte(d, p, sym);
+				len--;
+			} else if (sym == 256)
+				d->state = INFLATE_HEADER;
+			else {
+				sym -= 257;
+				if (sym >= 29)
+					return FALSE;
+				d->copylen = lenbase[sym] + getBits(img, d, lenextra[sym]);
+				if ((sym = decodeSym(img, d, &d->distcode)) < 0 || sym >= 30)
+					return FALSE;
+				d->copydist = distbase[sym] + getBits(img, d, distextra[sym]);
+				if (d->copydist > (d->wfull ? d->wsize : d->wpos))
+					return FALSE;
+			}
+			break;
+
+		default:
+			return FALSE;
+		}
+
+		if (d->err)
+			return FALSE;
+	}
+	return !d->err;
+}
+
+/* The Paeth predictor */
+static uint8_t paeth(uint8_t a, uint8_t b, uint8_t c) {
+	int16_t		p, pa, pb, pc;
+
+	p = (int16_t)a + b - c;
+	pa = p > a ? p - a : a - p;
+	pb = p > b ? p - b : b - p;
+	pc = p > c ? p - c : c - p;
+	if (pa <= pb && pa <= pc)
+		return a;
+	return pb <= pc ? b : c;
+}
+
+/* Get the next row of a (sub) image and unfilter it. Returns FALSE on an error. */
+static bool_t getRow(gdispImage *img, pngdecode *d, uint32_t rowbytes) {
+	uint8_t *	p;
+	uint8_t *	q;
+	uint32_t	i;
+	uint8_t		bpp;
+
+	/* The previous row becomes the current row */
+	p = d->prev;
+	d->prev = d->cur;
+	d->cur = p;
+
+	if (!inflateBytes(img, d, p, rowbytes+1))
+		return FALSE;
+
+	/* Skip the filter type byte */
+	q = d->prev+1;
+	bpp = img->priv->bpp;
+	switch(*p++) {
+	case 0:					// None
+		break;
+	case 1:					// Sub
+		for(i = bpp; i < rowbytes; i++)
+			p[i] += p[i-bpp];
+		break;
+	case 2:					// Up
+		for(i = 0; i < rowbytes; i++)
+			p[i] += q[i];
+		break;
+	case 3:					// Average
+		for(i = 0; i < bpp; i++)
+			p[i] += q[i] >> 1;
+		for(; i < rowbytes; i++)
+			p[i] += ((uint16_t)p[i-bpp] + q[i]) >> 1;
+		break;
+	case 4:					// Paeth
+		for(i = 0; i < bpp; i++)
+			p[i] += q[i];
+		for(; i < rowbytes; i++)
+			p[i] += paeth(p[i-bpp], q[i], q[i-bpp]);
+		break;
+	default:
+		return FALSE;
+	}
+	return TRUE;
+}
+
+/**
+ * Convert up to GDISP_IMAGE_PNG_BLIT_BUFFER_SIZE pixels from the current row starting at pixel x.
+ * The pixels go into d->buf and d->opaque.
+ */
+static void convertPixels(gdispImagePrivate *priv, pngdecode *d, coord_t x, coord_t cnt) {
+	const uint8_t *	p;
+	pixel_t *		pc;
+	uint8_t *		po;
+	uint16_t		v, r, g, b;
+	uint8_t			shift, mask;
+
+	p = d->cur+1;
+	pc = d->buf;
+	po = d->opaque;
+	switch(priv->colortype) {
+	case PNG_COLOR_GREY:
+		if (priv->bitdepth < 8) {
+			mask = (1 << priv->bitdepth) - 1;
+			for(; cnt; cnt--, x++) {
+				shift = 8 - priv->bitdepth - ((x * priv->bitdepth) & 7);
+				v = (p[(x * priv->bitdepth) >> 3] >> shift) & mask;
+				*po++ = !(priv->pngflags & PNG_TRANS) || v != priv->transgrey;
+				v = v * 255 / mask;
+				*pc++ = RGB2COLOR(v, v, v);
+			}
+		} else if (priv->bitdepth == 8) {
+			for(p += x; cnt; cnt--, p++) {
+				*po++ = !(priv->pngflags & PNG_TRANS) || p[0] != priv->transgrey;
+				*pc++ = RGB2COLOR(p[0], p[0], p[0]);
+			}
+		} else {
+			for(p += x*2; cnt; cnt--, p += 2) {
+				*po++ = !(priv->pngflags & PNG_TRANS) || getBE16(p) != priv->transgrey;
+				*pc++ = RGB2COLOR(p[0], p[0], p[0]);
+			}
+		}
+		break;
+
+	case PNG_COLOR_RGB:
+		if (priv->bitdepth == 8) {
+			for(p += x*3; cnt; cnt--, p += 3) {
+				*po++ = !(priv->pngflags & PNG_TRANS) || p[0] != priv->transred || p[1] != priv->transgreen || p[2] != priv->transblue;
+				*pc++ = RGB2COLOR(p[0], p[1], p[2]);
+			}
+		} else {
+			for(p += x*6; cnt; cnt--, p += 6) {
+				r = getBE16(p); g = getBE16(p+2); b = getBE16(p+4);
+				*po++ = !(priv->pngflags & PNG_TRANS) || r != priv->transred || g != priv->transgreen || b != priv->transblue;
+				*pc++ = RGB2COLOR(p[0], p[2], p[4]);
+			}
+		}
+		break;
+
+	case PNG_COLOR_PALETTE:
+		for(; cnt; cnt--, x++) {
+			if (priv->bitdepth == 8)
+				v = p[x];
+			else {
+				shift = 8 - priv->bitdepth - ((x * priv->bitdepth) & 7);
+				v = (p[(x * priv->bitdepth) >> 3] >> shift) & ((1 << priv->bitdepth) - 1);
+			}
+			if (v >= priv->palsize)
+				v = 0;
+			*po++ = !priv->paltrans || !(priv->paltrans[v >> 3] & (1 << (v & 7)));
+			*pc++ = priv->palette[v];
+		}
+		break;
+
+	case PNG_COLOR_GREYALPHA:
+		/* Alpha is either on or off - anything less than half is transparent */
+		if (priv->bitdepth == 8) {
+			for(p += x*2; cnt; cnt--, p += 2) {
+				*po++ = p[1] >= 0x80;
+				*pc++ = RGB2COLOR(p[0], p[0], p[0]);
+			}
+		} else {
+			for(p += x*4; cnt; cnt--, p += 4) {
+				*po++ = p[2] >= 0x80;
+				*pc++ = RGB2COLOR(p[0], p[0], p[0]);
+			}
+		}
+		break;
+
+	case PNG_COLOR_RGBA:
+		if (priv->bitdepth == 8) {
+			for(p += x*4; cnt; cnt--, p += 4) {
+				*po++ = p[3] >= 0x80;
+				*pc++ = RGB2COLOR(p[0], p[1], p[2]);
+			}
+		} else {
+			for(p += x*8; cnt; cnt--, p += 8) {
+				*po++ = p[6] >= 0x80;
+				*pc++ = RGB2COLOR(p[0], p[2], p[4]);
+			}
+		}
+		break;
+	}
+}
+
+/**
+ * Draw pixels [x0, x1) of the current row of a (sub) image.
+ * Pixel i of the row is drawn at screen position x + i * xstep.
+ */
+static void drawRow(gdispImage *img, pngdecode *d, coord_t x, coord_t y, coord_t x0, coord_t x1, uint8_t xstep) {
+	coord_t		n, i, st;
+
+	for(; x0 < x1; x0 += n) {
+		n = x1 - x0;
+		if (n > GDISP_IMAGE_PNG_BLIT_BUFFER_SIZE)
+			n = GDISP_IMAGE_PNG_BLIT_BUFFER_SIZE;
+		convertPixels(img->priv, d, x0, n);
+
+		/* Interlaced passes are drawn a pixel at a time */
+		if (xstep != 1) {
+			for(i = 0; i < n; i++) {
+				if (d->opaque[i])
+					gdispDrawPixel(x + (x0+i) * xstep, y, d->buf[i]);
+			}
+			continue;
+		}
+
+		/* Blit each run of opaque pixels */
+		for(i = 0; i < n; ) {
+			for(; i < n && !d->opaque[i]; i++);
+			for(st = i; i < n && d->opaque[i]; i++);
+			if (i - st == 1)
+				gdispDrawPixel(x + x0 + st, y, d->buf[st]);
+			else if (i > st)
+				gdispBlitAreaEx(x + x0 + st, y, i - st, 1, st, 0, n, d->buf);
+		}
+	}
+}
+
+/* Store pixels [0, cnt) of the current row of a (sub) image in the cache at image position x, y */
+static void cacheRow(gdispImage *img, pngdecode *d, coord_t x, coord_t y, coord_t cnt, uint8_t xstep) {
+	gdispImagePrivate *	priv;
+	size_t				pos;
+	coord_t				x0, n, i;
+
+	priv = img->priv;
+	pos = (size_t)y * img->width + x;
+	for(x0 = 0; x0 < cnt; x0 += n) {
+		n = cnt - x0;
+		if (n > GDISP_IMAGE_PNG_BLIT_BUFFER_SIZE)
+			n = GDISP_IMAGE_PNG_BLIT_BUFFER_SIZE;
+		convertPixels(priv, d, x0, n);
+		for(i = 0; i < n; i++, pos += xstep) {
+			priv->frame0cache[pos] = d->buf[i];
+			if (priv->maskcache) {
+				if (d->opaque[i])
+					priv->maskcache[pos >> 3] |= 1 << (pos & 7);
+				else
+					priv->maskcache[pos >> 3] &= ~(1 << (pos & 7));
+			}
+		}
+	}
+}
+
+/* The size of a row of a (sub) image in bytes */
+static uint32_t rowBytes(gdispImagePrivate *priv, coord_t width) {
+	return ((uint32_t)width * priv->bitspp + 7) >> 3;
+}
+
+/* Start decoding the image data */
+static pngdecode *startDecode(gdispImage *img) {
+	gdispImagePrivate *	priv;
+	pngdecode *			d;
+	uint32_t			rowbytes;
+
+	priv = img->priv;
+	rowbytes = rowBytes(priv, img->width) + 1;
+	if (!(d = (pngdecode *)chHeapAlloc(NULL, sizeof(pngdecode) + priv->wsize + 2 * rowbytes)))
+		return 0;
+	d->chunkleft = priv->idatlen;
+	d->inpos = d->inlen = 0;
+	d->bitbuf = 0;
+	d->bitcnt = 0;
+	d->err = FALSE;
+	d->state = INFLATE_HEADER;
+	d->final = FALSE;
+	d->copylen = 0;
+	d->lencode.symbol = d->lensym;
+	d->distcode.symbol = d->distsym;
+	d->wfull = FALSE;
+	d->wpos = 0;
+	d->wsize = priv->wsize;
+	d->window = (uint8_t *)(d+1);
+	d->cur = d->window + d->wsize;
+	d->prev = d->cur + rowbytes;
+	img->io.fns->seek(&img->io, priv->idatpos);
+
+	/* Skip the zlib header (it was checked when the image was opened) */
+	getByte(img, d);
+	getByte(img, d);
+	return d;
+}
+
+/**
+ * Decode the image.
+ * If the cache is allocated the whole image is decoded into it.
+ * Otherwise the area sx, sy, cx, cy of the image is drawn at x, y.
+ */
+static gdispImageError decodeImage(gdispImage *img, coord_t x, coord_t y, coord_t cx, coord_t cy, coord_t sx, coord_t sy) {
+	gdispImagePrivate *	priv;
+	pngdecode *			d;
+	coord_t				pw, my, x0, x1;
+	uint32_t			rowbytes;
+	uint8_t				pass, xst, yst, xstep, ystep;
+
+	priv = img->priv;
+	if (!(d = startDecode(img)))
+		return GDISP_IMAGE_ERR_NOMEMORY;
+
+	for(pass = (priv->pngflags & PNG_INTERLACED) ? 0 : 6; pass < 7; pass++) {
+		/* The sub-image for this pass */
+		if (priv->pngflags & PNG_INTERLACED) {
+			xst = adam7xstart[pass]; yst = adam7ystart[pass];
+			xstep = adam7xstep[pass]; ystep = adam7ystep[pass];
+		} else {
+			xst = yst = 0;
+			xstep = ystep = 1;
+		}
+		if (img->width <= xst || img->height <= yst)
+			continue;
+		pw = (img->width - xst + xstep - 1) / xstep;
+		rowbytes = rowBytes(priv, pw);
+
+		/* The first row of each pass is unfiltered against zeros */
+		memset(d->cur, 0, rowbytes+1);
+
+		/* The pixels of the sub-image that are in the area */
+		if (sx > xst)
+			x0 = (sx - xst + xstep - 1) / xstep;
+		else
+			x0 = 0;
+		x1 = (sx + cx - xst + xstep - 1) / xstep;
+		if (x1 > pw) x1 = pw;
+
+		for(my = yst; my < img->height; my += ystep) {
+			/* Once past the area there is nothing more to draw */
+			if (!priv->frame0cache && my >= sy + cy)
+				break;
+
+			if (!getRow(img, d, rowbytes)) {
+				chHeapFree((void *)d);
+				return GDISP_IMAGE_ERR_BADDATA;
+			}
+
+			if (priv->frame0cache)
+				cacheRow(img, d, xst, my, pw, xstep);
+			else if (my >= sy && x0 < x1)
+				drawRow(img, d, x + xst - sx, y + my - sy, x0, x1, xstep);
+		}
+
+		/* Rows of this pass past the area still have to be decoded for the next pass */
+		if (pass < 6) {
+			for(; my < img->height; my += ystep) {
+				if (!getRow(img, d, rowbytes)) {
+					chHeapFree((void *)d);
+					return GDISP_IMAGE_ERR_BADDATA;
+				}
+			}
+		}
+	}
+
+	chHeapFree((void *)d);
+	return GDISP_IMAGE_ERR_OK;
+}
+
+gdispImageError gdispImageOpen_PNG(gdispImage *img) {
+	gdispImagePrivate *	priv;
+	uint8_t				b[14];
+	uint32_t			len, adword, raw;
+	uint16_t			i;
+	coord_t				pw, ph;
+	uint8_t				pass;
+
+	/* Read the file identifier */
+	if (img->io.fns->read(&img->io, b, 8) != 8)
+		return GDISP_IMAGE_ERR_BADFORMAT;		// It can't be us
+
+	if (b[0] != 137 || b[1] != 'P' || b[2] != 'N' || b[3] != 'G' || b[4] != 13 || b[5] != 10 || b[6] != 26 || b[7] != 10)
+		return GDISP_IMAGE_ERR_BADFORMAT;		// It can't be us
+
+	/* We know we are a PNG format image */
+	img->type = GDISP_IMAGE_TYPE_PNG;
+	img->flags = 0;
+
+	/* Allocate our private area */
+	if (!(img->priv = (gdispImagePrivate *)chHeapAlloc(NULL, sizeof(gdispImagePrivate))))
+		return GDISP_IMAGE_ERR_NOMEMORY;
+	img->membytes = sizeof(gdispImagePrivate);
+
+	/* Initialise the essential bits in the private area */
+	priv = img->priv;
+	priv->pngflags = 0;
+	priv->palsize = 0;
+	priv->palette = 0;
+	priv->paltrans = 0;
+	priv->frame0cache = 0;
+	priv->maskcache = 0;
+
+	/* The IHDR chunk must be first */
+	if (img->io.fns->read(&img->io, b, 8) != 8 || getBE32(b) != 13 || b[4] != 'I' || b[5] != 'H' || b[6] != 'D' || b[7] != 'R')
+		goto baddatacleanup;
+	if (img->io.fns->read(&img->io, b, 13) != 13)
+		goto baddatacleanup;
+	adword = getBE32(b);
+	if (adword < 1 || adword > 32767)
+		goto unsupportedcleanup;
+	img->width = adword;
+	adword = getBE32(b+4);
+	if (adword < 1 || adword > 32767)
+		goto unsupportedcleanup;
+	img->height = adword;
+	priv->bitdepth = b[8];
+	priv->colortype = b[9];
+	if (b[10] || b[11] || b[12] > 1)			// Compression, filter and interlace methods
+		goto unsupportedcleanup;
+	if (b[12])
+		priv->pngflags |= PNG_INTERLACED;
+
+	/* Check the bit depth is valid for the color type */
+	switch(priv->colortype) {
+	case PNG_COLOR_GREY:
+		if (priv->bitdepth != 1 && priv->bitdepth != 2 && priv->bitdepth != 4 && priv->bitdepth != 8 && priv->bitdepth != 16)
+			goto baddatacleanup;
+		priv->bitspp = priv->bitdepth;
+		break;
+	case PNG_COLOR_PALETTE:
+		if (priv->bitdepth != 1 && priv->bitdepth != 2 && priv->bitdepth != 4 && priv->bitdepth != 8)
+			goto baddatacleanup;
+		priv->bitspp = priv->bitdepth;
+		break;
+	case PNG_COLOR_RGB:
+		if (priv->bitdepth != 8 && priv->bitdepth != 16)
+			goto baddatacleanup;
+		priv->bitspp = priv->bitdepth * 3;
+		break;
+	case PNG_COLOR_GREYALPHA:
+		if (priv->bitdepth != 8 && priv->bitdepth != 16)
+			goto baddatacleanup;
+		priv->bitspp = priv->bitdepth * 2;
+		img->flags |= GDISP_IMAGE_FLG_TRANSPARENT;
+		break;
+	case PNG_COLOR_RGBA:
+		if (priv->bitdepth != 8 && priv->bitdepth != 16)
+			goto baddatacleanup;
+		priv->bitspp = priv->bitdepth * 4;
+		img->flags |= GDISP_IMAGE_FLG_TRANSPARENT;
+		break;
+	default:
+		goto baddatacleanup;
+	}
+	priv->bpp = priv->bitspp < 8 ? 1 : priv->bitspp >> 3;
+
+	/* Read the chunks up to the image data */
+	img->io.fns->seek(&img->io, img->io.pos + 4);		// The IHDR CRC
+	while(1) {
+		if (img->io.fns->read(&img->io, b, 8) != 8)
+			goto baddatacleanup;
+		len = getBE32(b);
+
+		if (b[4] == 'I' && b[5] == 'D' && b[6] == 'A' && b[7] == 'T')
+			break;
+
+		if (b[4] == 'P' && b[5] == 'L' && b[6] == 'T' && b[7] == 'E') {
+			if (priv->palette || len % 3 || len > 256*3)
+				goto baddatacleanup;
+			priv->palsize = len / 3;
+			if (!(priv->palette = (pixel_t *)chHeapAlloc(NULL, priv->palsize * sizeof(pixel_t))))
+				goto nomemcleanup;
+			img->membytes += priv->palsize * sizeof(pixel_t);
+			for(i = 0; i < priv->palsize; i++) {
+				if (img->io.fns->read(&img->io, b, 3) != 3)
+					goto baddatacleanup;
+				priv->palette[i] = RGB2COLOR(b[0], b[1], b[2]);
+			}
+			len = 0;
+
+		} else if (b[4] == 't' && b[5] == 'R' && b[6] == 'N' && b[7] == 'S') {
+			if ((priv->pngflags & PNG_TRANS))
+				goto baddatacleanup;				// Only one tRNS chunk is allowed
+			switch(priv->colortype) {
+			case PNG_COLOR_GREY:
+				if (len != 2 || img->io.fns->read(&img->io, b, 2) != 2)
+					goto baddatacleanup;
+				priv->transgrey = getBE16(b);
+				break;
+			case PNG_COLOR_RGB:
+				if (len != 6 || img->io.fns->read(&img->io, b, 6) != 6)
+					goto baddatacleanup;
+				priv->transred = getBE16(b);
+				priv->transgreen = getBE16(b+2);
+				priv->transblue = getBE16(b+4);
+				break;
+			case PNG_COLOR_PALETTE:
+				/* Palette entries less than half opaque are transparent. The palette must come first. */
+				if (!priv->palette || len > priv->palsize)
+					goto baddatacleanup;
+				if (!(priv->paltrans = (uint8_t *)chHeapAlloc(NULL, 256/8)))
+					goto nomemcleanup;
+				img->membytes += 256/8;
+				memset(priv->paltrans, 0, 256/8);
+				for(i = 0; i < len; i++) {
+					if (img->io.fns->read(&img->io, b, 1) != 1)
+						goto baddatacleanup;
+					if (b[0] < 0x80)
+						priv->paltrans[i >> 3] |= 1 << (i & 7);
+				}
+				break;
+			default:
+				goto baddatacleanup;
+			}
+			len = 0;
+			priv->pngflags |= PNG_TRANS;
+			img->flags |= GDISP_IMAGE_FLG_TRANSPARENT;
+
+		} else if (b[4] == 'I' && b[5] == 'E' && b[6] == 'N' && b[7] == 'D')
+			goto baddatacleanup;
+
+		/* Skip the rest of the chunk and its CRC */
+		img->io.fns->seek(&img->io, img->io.pos + len + 4);
+	}
+	if (priv->colortype == PNG_COLOR_PALETTE && !priv->palette)
+		goto baddatacleanup;
+	priv->idatpos = img->io.pos;
+	priv->idatlen = len;
+
+	/* Check the zlib header (it may be split over IDAT chunks) */
+	for(i = 0; i < 2; i++) {
+		while(!len) {
+			if (img->io.fns->read(&img->io, b+2, 12) != 12 || b[10] != 'I' || b[11] != 'D' || b[12] != 'A' || b[13] != 'T')
+				goto baddatacleanup;
+			len = getBE32(b+6);
+		}
+		if (img->io.fns->read(&img->io, b+i, 1) != 1)
+			goto baddatacleanup;
+		len--;
+	}
+	if ((b[0] & 0x0F) != 8 || (b[1] & 0x20) || (((uint16_t)b[0] << 8) | b[1]) % 31)
+		goto baddatacleanup;
+
+	/**
+	 * The window needs to be as big as the encoder's window.
+	 * It never needs to be bigger than all the data.
+	 */
+	priv->wsize = 1UL << ((b[0] >> 4) + 8);
+	for(raw = 0, pass = (priv->pngflags & PNG_INTERLACED) ? 0 : 6; pass < 7; pass++) {
+		if (priv->pngflags & PNG_INTERLACED) {
+			if (img->width <= adam7xstart[pass] || img->height <= adam7ystart[pass])
+				continue;
+			pw = (img->width - adam7xstart[pass] + adam7xstep[pass] - 1) / adam7xstep[pass];
+			ph = (img->height - adam7ystart[pass] + adam7ystep[pass] - 1) / adam7ystep[pass];
+		} else {
+			pw = img->width;
+			ph = img->height;
+		}
+		raw += (rowBytes(priv, pw) + 1) * ph;
+	}
+	if (priv->wsize > raw)
+		priv->wsize = raw;
+	if (priv->wsize > GDISP_IMAGE_PNG_WINDOW_SIZE)
+		goto unsupportedcleanup;
+
+	return GDISP_IMAGE_ERR_OK;
+
+nomemcleanup:
+	gdispImageClose_PNG(img);				// Clean up the private data area
+	return GDISP_IMAGE_ERR_NOMEMORY;		// Out of memory
+
+baddatacleanup:
+	gdispImageClose_PNG(img);				// Clean up the private data area
+	return GDISP_IMAGE_ERR_BADDATA;			// Oops - something wrong
+
+unsupportedcleanup:
+	gdispImageClose_PNG(img);				// Clean up the private data area
+	return GDISP_IMAGE_ERR_UNSUPPORTED;		// Not supported
+}
+
+void gdispImageClose_PNG(gdispImage *img) {
+	if (img->priv) {
+		if (img->priv->palette)
+			chHeapFree((void *)img->priv->palette);
+		if (img->priv->paltrans)
+			chHeapFree((void *)img->priv->paltrans);
+		if (img->priv->frame0cache)
+			chHeapFree((void *)img->priv->frame0cache);
+		if (img->priv->maskcache)
+			chHeapFree((void *)img->priv->maskcache);
+		chHeapFree((void *)img->priv);
+		img->priv = 0;
+	}
+	img->type = GDISP_IMAGE_TYPE_UNKNOWN;
+	img->membytes = 0;
+	img->io.fns->close(&img->io);
+}
+
+gdispImageError gdispImageCache_PNG(gdispImage *img) {
+	gdispImagePrivate *	priv;
+	gdispImageError		err;
+	size_t				len, mlen;
+
+	/* If we are already cached - just return OK */
+	priv = img->priv;
+	if (priv->frame0cache)
+		return GDISP_IMAGE_ERR_OK;
+
+	/* We need to allocate the cache */
+	len = (size_t)img->width * img->height * sizeof(pixel_t);
+	mlen = 0;
+	if (!(priv->frame0cache = (pixel_t *)chHeapAlloc(NULL, len)))
+		return GDISP_IMAGE_ERR_NOMEMORY;
+
+	/* Images with transparency also need a mask */
+	if ((img->flags & GDISP_IMAGE_FLG_TRANSPARENT)) {
+		mlen = ((size_t)img->width * img->height + 7) >> 3;
+		if (!(priv->maskcache = (uint8_t *)chHeapAlloc(NULL, mlen))) {
+			chHeapFree((void *)priv->frame0cache);
+			priv->frame0cache = 0;
+			return GDISP_IMAGE_ERR_NOMEMORY;
+		}
+	}
+
+	/* Decode the entire image into the cache */
+	if ((err = decodeImage(img, 0, 0, img->width, img->height, 0, 0)) != GDISP_IMAGE_ERR_OK) {
+		chHeapFree((void *)priv->frame0cache);
+		priv->frame0cache = 0;
+		if (priv->maskcache) {
+			chHeapFree((void *)priv->maskcache);
+			priv->maskcache = 0;
+		}
+		return err;
+	}
+	img->membytes += len + mlen;
+	return GDISP_IMAGE_ERR_OK;
+}
+
+gdispImageError gdispImageDraw_PNG(gdispImage *img, coord_t x, coord_t y, coord_t cx, coord_t cy, coord_t sx, coord_t sy) {
+	gdispImagePrivate *	priv;
+	coord_t				mx, my, st;
+	size_t				pos;
+
+	priv = img->priv;
+
+	/* Check some reasonableness */
+	if (sx >= img->width || sy >= img->height) return GDISP_IMAGE_ERR_OK;
+	if (sx + cx > img->width) cx = img->width - sx;
+	if (sy + cy > img->height) cy = img->height - sy;
+
+	/* Draw from the image cache - if it exists */
+	if (priv->frame0cache) {
+		if (!priv->maskcache) {
+			gdispBlitAreaEx(x, y, cx, cy, sx, sy, img->width, priv->frame0cache);
+			return GDISP_IMAGE_ERR_OK;
+		}
+
+		/* Blit each run of opaque pixels */
+		for(my = sy; my < sy + cy; my++) {
+			pos = (size_t)my * img->width;
+			for(mx = sx; mx < sx + cx; ) {
+				for(; mx < sx + cx && !(priv->maskcache[(pos+mx) >> 3] & (1 << ((pos+mx) & 7))); mx++);
+				for(st = mx; mx < sx + cx && (priv->maskcache[(pos+mx) >> 3] & (1 << ((pos+mx) & 7))); mx++);
+				if (mx > st)
+					gdispBlitAreaEx(x+st-sx, y+my-sy, mx-st, 1, st, my, img->width, priv->frame0cache);
+			}
+		}
+		return GDISP_IMAGE_ERR_OK;
+	}
+
+	return decodeImage(img, x, y, cx, cy, sx, sy);
+}
+
+systime_t gdispImageNext_PNG(gdispImage *img) {
+	(void) img;
+
+	/* No more frames/pages */
+	return TIME_INFINITE;
+}
 
 #endif /* GFX_USE_GDISP && GDISP_NEED_IMAGE && GDISP_NEED_IMAGE_PNG */
 /** @} */
@@ -0,0 +1,535 @@
+/*
+    ChibiOS/GFX - Copyright (C) 2012, 2013
+                 Joel Bodenmann aka Tectu <joel@unormal.org>
+
+    This file is part of ChibiOS/GFX.
+
+    ChibiOS/GFX is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    ChibiOS/GFX is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file    src/gdisp/shadow.c
+ * @brief   GDISP shadow framebuffer code.
+ *
+ * @details	The shadow framebuffer sits between the high level GDISP code and the
+ *			low level driver (the panel). It keeps a RAM copy of an area of the screen
+ *			so that pixel reads, area reads, scrolling and area copies are served from
+ *			RAM even if the panel can't read back. Writes are mirrored to the panel
+ *			either immediately or when @p gdispShadowFlush() is called.
+ *
+ *			The low level driver is compiled with its routines renamed to
+ *			gdisp_lld_panel_xxx() (see include/gdisp/lld/shadow.h) and this file
+ *			provides the real gdisp_lld_xxx() routines.
+ *
+ * @addtogroup GDISP
+ * @{
+ */
+#define GDISP_SHADOW_C
+
+#include "ch.h"
+#include "hal.h"
+#include "gfx.h"
+
+#if GFX_USE_GDISP && GDISP_NEED_SHADOW
+
+#include <string.h>
+
+#if GDISP_PACKED_PIXELS
+	#error "GDISP: The shadow framebuffer does not support packed pixel formats."
+#endif
+
+/* What the panel itself can do */
+#if GDISP_NEED_PIXELREAD && GDISP_HARDWARE_PIXELREAD
+	#define PANEL_READS		TRUE
+#else
+	#define PANEL_READS		FALSE
+#endif
+
+/* The panel routines (the renamed low level driver) */
+extern bool_t gdisp_lld_panel_init(void);
+extern void gdisp_lld_panel_clear(color_t color);
+extern void gdisp_lld_panel_draw_pixel(coord_t x, coord_t y, color_t color);
+extern void gdisp_lld_panel_fill_area(coord_t x, coord_t y, coord_t cx, coord_t cy, color_t color);
+extern void gdisp_lld_panel_blit_area_ex(coord_t x, coord_t y, coord_t cx, coord_t cy, coord_t srcx, coord_t srcy, coord_t srccx, const pixel_t *buffer);
+#if PANEL_READS
+	extern color_t gdisp_lld_panel_get_pixel_color(coord_t x, coord_t y);
+	extern void gdisp_lld_panel_read_area(coord_t x, coord_t y, coord_t cx, coord_t cy, pixel_t *buffer);
+#endif
+#if GDISP_NEED_CLIP
+	extern void gdisp_lld_panel_set_clip(coord_t x, coord_t y, coord_t cx, coord_t cy);
+#endif
+#if GDISP_NEED_CONTROL
+	extern void gdisp_lld_panel_control(unsigned what, void *value);
+#endif
+#if GDISP_NEED_QUERY
+	extern void *gdisp_lld_panel_query(unsigned what);
+#endif
+
+/* The routines provided here. Everything else is emulated on top of them. */
+#undef GDISP_HARDWARE_LINES
+#undef GDISP_HARDWARE_CLEARS
+#undef GDISP_HARDWARE_FILLS
+#undef GDISP_HARDWARE_BITFILLS
+#undef GDISP_HARDWARE_MONOFILLS
+#undef GDISP_HARDWARE_KEYEDFILLS
+#undef GDISP_HARDWARE_CIRCLES
+#undef GDISP_HARDWARE_CIRCLEFILLS
+#undef GDISP_HARDWARE_ELLIPSES
+#undef GDISP_HARDWARE_ELLIPSEFILLS
+#undef GDISP_HARDWARE_ARCS
+#undef GDISP_HARDWARE_ARCFILLS
+#undef GDISP_HARDWARE_TEXT
+#undef GDISP_HARDWARE_TEXTFILLS
+#undef GDISP_HARDWARE_SCROLL
+#undef GDISP_HARDWARE_PIXELREAD
+#undef GDISP_HARDWARE_READAREA
+#undef GDISP_HARDWARE_COPYAREA
+#undef GDISP_HARDWARE_CONTROL
+#undef GDISP_HARDWARE_QUERY
+#undef GDISP_HARDWARE_CLIP
+#define GDISP_HARDWARE_LINES		FALSE
+#define GDISP_HARDWARE_CLEARS		TRUE
+#define GDISP_HARDWARE_FILLS		TRUE
+#define GDISP_HARDWARE_BITFILLS		TRUE
+#define GDISP_HARDWARE_MONOFILLS	FALSE
+#define GDISP_HARDWARE_KEYEDFILLS	FALSE
+#define GDISP_HARDWARE_CIRCLES		FALSE
+#define GDISP_HARDWARE_CIRCLEFILLS	FALSE
+#define GDISP_HARDWARE_ELLIPSES		FALSE
+#define GDISP_HARDWARE_ELLIPSEFILLS	FALSE
+#define GDISP_HARDWARE_ARCS			FALSE
+#define GDISP_HARDWARE_ARCFILLS		FALSE
+#define GDISP_HARDWARE_TEXT			FALSE
+#define GDISP_HARDWARE_TEXTFILLS	FALSE
+#define GDISP_HARDWARE_SCROLL		TRUE
+#define GDISP_HARDWARE_PIXELREAD	TRUE
+#define GDISP_HARDWARE_READAREA		TRUE
+#define GDISP_HARDWARE_COPYAREA		TRUE
+#define GDISP_HARDWARE_CONTROL		TRUE
+#define GDISP_HARDWARE_QUERY		TRUE
+#define GDISP_HARDWARE_CLIP			TRUE
+
+#include "gdisp/lld/emulation.c"
+
+static pixel_t *	shadowBuf;				/* The shadow pixels */
+static size_t		shadowSize;				/* The number of pixels allocated */
+static coord_t		shx0, shy0;				/* The top left of the shadow area */
+static coord_t		shx1, shy1;				/* The bottom right of the shadow area (not inclusive) */
+#if !GDISP_SHADOW_AUTOFLUSH
+	static coord_t *	dirtyx0;			/* For each shadow row the changed columns (empty if dirtyx0 >= dirtyx1) */
+	static coord_t *	dirtyx1;
+	static coord_t		dirtyRows;			/* The number of rows allocated */
+#endif
+
+/* The address of a pixel in the shadow */
+#define SHADOWPIXEL(x, y)		(&shadowBuf[((y) - shy0) * (shx1 - shx0) + ((x) - shx0)])
+
+/* Is an area completely within the shadow */
+static bool_t shadow_covers(coord_t x, coord_t y, coord_t cx, coord_t cy) {
+	return x >= shx0 && y >= shy0 && x+cx <= shx1 && y+cy <= shy1;
+}
+
+/* Work out the shadow area for the current orientation */
+static void shadow_setarea(void) {
+	shx0 = GDISP_SHADOW_X;
+	shy0 = GDISP_SHADOW_Y;
+	shx1 = GDISP_SHADOW_CX ? shx0 + GDISP_SHADOW_CX : GDISP.Width;
+	shy1 = GDISP_SHADOW_CY ? shy0 + GDISP_SHADOW_CY : GDISP.Height;
+	if (shx1 > GDISP.Width)		shx1 = GDISP.Width;
+	if (shy1 > GDISP.Height)	shy1 = GDISP.Height;
+	if (shx0 >= shx1 || shy0 >= shy1) {
+		shx1 = shx0;
+		shy1 = shy0;
+		return;
+	}
+
+	/* After a change of orientation the area may have to shrink to fit the memory we have */
+	if (shadowSize && (size_t)(shx1 - shx0) * (shy1 - shy0) > shadowSize)
+		shy1 = shy0 + shadowSize / (shx1 - shx0);
+	#if !GDISP_SHADOW_AUTOFLUSH
+		if (dirtyRows && shy1 - shy0 > dirtyRows)
+			shy1 = shy0 + dirtyRows;
+	#endif
+}
+
+/* Fill an area of the shadow (the area must be within the shadow) */
+static void shadow_fill(coord_t x, coord_t y, coord_t cx, coord_t cy, color_t color) {
+	pixel_t	*p, *q;
+	coord_t	i;
+
+	p = SHADOWPIXEL(x, y);
+	for(i = 0; i < cx; i++)
+		p[i] = color;
+	for(q = p, i = 1; i < cy; i++) {
+		q += shx1 - shx0;
+		memcpy(q, p, cx * sizeof(pixel_t));
+	}
+}
+
+#if !GDISP_SHADOW_AUTOFLUSH || GDISP_NEED_SCROLL || GDISP_NEED_COPYAREA
+/* The shadow area (x,y,cx,cy) has changed - bring the panel up to date */
+static void shadow_changed(coord_t x, coord_t y, coord_t cx, coord_t cy) {
+	#if GDISP_SHADOW_AUTOFLUSH
+		gdisp_lld_panel_blit_area_ex(x, y, cx, cy, x - shx0, y - shy0, shx1 - shx0, shadowBuf);
+	#else
+		coord_t	i;
+
+		for(i = y - shy0; i < y - shy0 + cy; i++) {
+			if (dirtyx0[i] >= dirtyx1[i]) {
+				dirtyx0[i] = x;
+				dirtyx1[i] = x + cx;
+			} else {
+				if (x < dirtyx0[i])			dirtyx0[i] = x;
+				if (x + cx > dirtyx1[i])	dirtyx1[i] = x + cx;
+			}
+		}
+	#endif
+}
+#endif
+
+/* Clear the shadow and the area of the panel it covers */
+static void shadow_reset(void) {
+	if (shx0 >= shx1)
+		return;
+	shadow_fill(shx0, shy0, shx1 - shx0, shy1 - shy0, Black);
+	#if !GDISP_SHADOW_AUTOFLUSH
+		memset(dirtyx0, 0, dirtyRows * sizeof(coord_t));
+		memset(dirtyx1, 0, dirtyRows * sizeof(coord_t));
+	#endif
+	gdisp_lld_panel_fill_area(shx0, shy0, shx1 - shx0, shy1 - shy0, Black);
+}
+
+#if GDISP_NEED_PIXELREAD || GDISP_NEED_SCROLL || GDISP_NEED_COPYAREA
+	/* Read an area of the screen. Pixels outside the shadow are left unchanged if the panel can't read back. */
+	static void shadow_read(coord_t x, coord_t y, coord_t cx, coord_t cy, pixel_t *buffer) {
+		coord_t		stride, j, i0, i1;
+
+		stride = cx;
+		#if GDISP_NEED_VALIDATION || GDISP_NEED_CLIP
+			if (x < 0) { cx += x; buffer -= x; x = 0; }
+			if (y < 0) { cy += y; buffer -= y*stride; y = 0; }
+			if (cx <= 0 || cy <= 0 || x >= GDISP.Width || y >= GDISP.Height) return;
+			if (x+cx > GDISP.Width)		cx = GDISP.Width - x;
+			if (y+cy > GDISP.Height)	cy = GDISP.Height - y;
+		#endif
+
+		for(j = 0; j < cy; j++, buffer += stride) {
+			/* The columns i0 to i1 (not inclusive) of this line come from the shadow */
+			if (y + j < shy0 || y + j >= shy1) {
+				i0 = i1 = 0;
+			} else {
+				i0 = shx0 - x;
+				i1 = shx1 - x;
+				if (i0 < 0)		i0 = 0;
+				if (i1 > cx)	i1 = cx;
+				if (i0 >= i1)	i0 = i1 = 0;
+			}
+			if (i0 < i1)
+				memcpy(buffer + i0, SHADOWPIXEL(x + i0, y + j), (i1 - i0) * sizeof(pixel_t));
+			#if PANEL_READS
+				if (i0 > 0)
+					gdisp_lld_panel_read_area(x, y + j, i0, 1, buffer);
+				if (i1 < cx)
+					gdisp_lld_panel_read_area(x + i1, y + j, cx - i1, 1, buffer + i1);
+			#endif
+		}
+	}
+#endif
+
+#if GDISP_NEED_SCROLL || GDISP_NEED_COPYAREA
+/* Move an area of the screen. The areas must already be clipped. */
+static void shadow_move(coord_t srcx, coord_t srcy, coord_t cx, coord_t cy, coord_t dstx, coord_t dsty) {
+	static pixel_t	moveBuf[GDISP_LINEBUF_SIZE];
+	coord_t			i, j, n, row, col;
+
+	/* Entirely in RAM. Lines are moved in the order that means a source line is never overwritten before it is read. */
+	if (shadow_covers(srcx, srcy, cx, cy) && shadow_covers(dstx, dsty, cx, cy)) {
+		for(j = 0; j < cy; j++) {
+			row = dsty > srcy ? cy - 1 - j : j;
+			memmove(SHADOWPIXEL(dstx, dsty + row), SHADOWPIXEL(srcx, srcy + row), cx * sizeof(pixel_t));
+		}
+		shadow_changed(dstx, dsty, cx, cy);
+		return;
+	}
+
+	/* Otherwise a piece of a line at a time. When moving right along the same
+	 *	line the pieces are moved starting from the right hand end.
+	 */
+	for(j = 0; j < cy; j++) {
+		row = dsty > srcy ? cy - 1 - j : j;
+		for(i = 0; i < cx; i += n) {
+			n = cx - i > GDISP_LINEBUF_SIZE ? GDISP_LINEBUF_SIZE : cx - i;
+			col = dsty == srcy && dstx > srcx ? cx - i - n : i;
+			shadow_read(srcx + col, srcy + row, n, 1, moveBuf);
+			gdisp_lld_blit_area_ex(dstx + col, dsty + row, n, 1, 0, 0, n, moveBuf);
+		}
+	}
+}
+#endif
+
+bool_t gdisp_lld_init(void) {
+	size_t	size;
+
+	if (!gdisp_lld_panel_init())
+		return FALSE;
+
+	shadowSize = 0;
+	shadow_setarea();
+	size = (size_t)(shx1 - shx0) * (shy1 - shy0);
+	if (size) {
+		shadowBuf = (pixel_t *)chHeapAlloc(NULL, size * sizeof(pixel_t));
+		#if !GDISP_SHADOW_AUTOFLUSH
+			/* Allow for the area changing shape when the orientation changes */
+			dirtyRows = shx1 - shx0 > shy1 - shy0 ? shx1 - shx0 : shy1 - shy0;
+			dirtyx0 = (coord_t *)chHeapAlloc(NULL, dirtyRows * sizeof(coord_t));
+			dirtyx1 = (coord_t *)chHeapAlloc(NULL, dirtyRows * sizeof(coord_t));
+			if (!dirtyx0 || !dirtyx1) {
+				if (dirtyx0) chHeapFree(dirtyx0);
+				if (dirtyx1) chHeapFree(dirtyx1);
+				if (shadowBuf) chHeapFree(shadowBuf);
+				shadowBuf = 0;
+				dirtyRows = 0;
+			}
+		#endif
+
+		/* Not enough memory - everything goes straight to the panel */
+		if (!shadowBuf)
+			shx1 = shx0;
+		else
+			shadowSize = size;
+	}
+	shadow_reset();
+	return TRUE;
+}
+
+void gdisp_lld_clear(color_t color) {
+	if (shx0 < shx1) {
+		shadow_fill(shx0, shy0, shx1 - shx0, shy1 - shy0, color);
+		#if !GDISP_SHADOW_AUTOFLUSH
+			memset(dirtyx0, 0, dirtyRows * sizeof(coord_t));
+			memset(dirtyx1, 0, dirtyRows * sizeof(coord_t));
+		#endif
+	}
+	gdisp_lld_panel_clear(color);
+}
+
+void gdisp_lld_draw_pixel(coord_t x, coord_t y, color_t color) {
+	#if GDISP_NEED_VALIDATION || GDISP_NEED_CLIP
+		if (x < GDISP.clipx0 || y < GDISP.clipy0 || x >= GDISP.clipx1 || y >= GDISP.clipy1) return;
+	#endif
+
+	if (!shadow_covers(x, y, 1, 1)) {
+		gdisp_lld_panel_draw_pixel(x, y, color);
+		return;
+	}
+	*SHADOWPIXEL(x, y) = color;
+	#if GDISP_SHADOW_AUTOFLUSH
+		gdisp_lld_panel_draw_pixel(x, y, color);
+	#else
+		shadow_changed(x, y, 1, 1);
+	#endif
+}
+
+void gdisp_lld_fill_area(coord_t x, coord_t y, coord_t cx, coord_t cy, color_t color) {
+	coord_t	x0, y0, x1, y1;
+
+	#if GDISP_NEED_VALIDATION || GDISP_NEED_CLIP
+		if (x < GDISP.clipx0) { cx -= GDISP.clipx0 - x; x = GDISP.clipx0; }
+		if (y < GDISP.clipy0) { cy -= GDISP.clipy0 - y; y = GDISP.clipy0; }
+		if (cx <= 0 || cy <= 0 || x >= GDISP.clipx1 || y >= GDISP.clipy1) return;
+		if (x+cx > GDISP.clipx1)	cx = GDISP.clipx1 - x;
+		if (y+cy > GDISP.clipy1)	cy = GDISP.clipy1 - y;
+	#endif
+
+	#if !GDISP_SHADOW_AUTOFLUSH
+		if (shadow_covers(x, y, cx, cy)) {
+			shadow_fill(x, y, cx, cy, color);
+			shadow_changed(x, y, cx, cy);
+			return;
+		}
+	#endif
+
+	/* Update the part in the shadow and send the lot to the panel */
+	x0 = x < shx0 ? shx0 : x;
+	y0 = y < shy0 ? shy0 : y;
+	x1 = x + cx > shx1 ? shx1 : x + cx;
+	y1 = y + cy > shy1 ? shy1 : y + cy;
+	if (x0 < x1 && y0 < y1)
+		shadow_fill(x0, y0, x1 - x0, y1 - y0, color);
+	gdisp_lld_panel_fill_area(x, y, cx, cy, color);
+}
+
+void gdisp_lld_blit_area_ex(coord_t x, coord_t y, coord_t cx, coord_t cy, coord_t srcx, coord_t srcy, coord_t srccx, const pixel_t *buffer) {
+	coord_t	x0, y0, x1, y1;
+	coord_t	j;
+
+	#if GDISP_NEED_VALIDATION || GDISP_NEED_CLIP
+		if (x < GDISP.clipx0) { cx -= GDISP.clipx0 - x; srcx += GDISP.clipx0 - x; x = GDISP.clipx0; }
+		if (y < GDISP.clipy0) { cy -= GDISP.clipy0 - y; srcy += GDISP.clipy0 - y; y = GDISP.clipy0; }
+		if (srcx+cx > srccx) cx = srccx - srcx;
+		if (cx <= 0 || cy <= 0 || x >= GDISP.clipx1 || y >= GDISP.clipy1) return;
+		if (x+cx > GDISP.clipx1)	cx = GDISP.clipx1 - x;
+		if (y+cy > GDISP.clipy1)	cy = GDISP.clipy1 - y;
+	#endif
+
+	/* Update the part in the shadow */
+	x0 = x < shx0 ? shx0 : x;
+	y0 = y < shy0 ? shy0 : y;
+	x1 = x + cx > shx1 ? shx1 : x + cx;
+	y1 = y + cy > shy1 ? shy1 : y + cy;
+	if (x0 < x1)
+		for(j = y0; j < y1; j++)
+			memcpy(SHADOWPIXEL(x0, j), buffer + (srcy + j - y) * srccx + srcx + x0 - x, (x1 - x0) * sizeof(pixel_t));
+
+	#if !GDISP_SHADOW_AUTOFLUSH
+		if (shadow_covers(x, y, cx, cy)) {
+			shadow_changed(x, y, cx, cy);
+			return;
+		}
+	#endif
+	gdisp_lld_panel_blit_area_ex(x, y, cx, cy, srcx, srcy, srccx, buffer);
+}
+
+#if GDISP_NEED_CLIP
+	void gdisp_lld_set_clip(coord_t x, coord_t y, coord_t cx, coord_t cy) {
+		gdisp_lld_panel_set_clip(x, y, cx, cy);
+	}
+#endif
+
+#if GDISP_NEED_PIXELREAD
+	void gdisp_lld_read_area(coord_t x, coord_t y, coord_t cx, coord_t cy, pixel_t *buffer) {
+		shadow_read(x, y, cx, cy, buffer);
+	}
+
+	color_t gdisp_lld_get_pixel_color(coord_t x, coord_t y) {
+		#if GDISP_NEED_VALIDATION || GDISP_NEED_CLIP
+			if (x < 0 || x >= GDISP.Width || y < 0 || y >= GDISP.Height) return 0;
+		#endif
+
+		if (shadow_covers(x, y, 1, 1))
+			return *SHADOWPIXEL(x, y);
+		#if PANEL_READS
+			return gdisp_lld_panel_get_pixel_color(x, y);
+		#else
+			return 0;
+		#endif
+	}
+#endif
+
+#if GDISP_NEED_SCROLL
+	void gdisp_lld_vertical_scroll(coord_t x, coord_t y, coord_t cx, coord_t cy, int lines, color_t bgcolor) {
+		#if GDISP_NEED_VALIDATION || GDISP_NEED_CLIP
+			if (x < GDISP.clipx0) { cx -= GDISP.clipx0 - x; x = GDISP.clipx0; }
+			if (y < GDISP.clipy0) { cy -= GDISP.clipy0 - y; y = GDISP.clipy0; }
+			if (!lines || cx <= 0 || cy <= 0 || x >= GDISP.clipx1 || y >= GDISP.clipy1) return;
+			if (x+cx > GDISP.clipx1)	cx = GDISP.clipx1 - x;
+			if (y+cy > GDISP.clipy1)	cy = GDISP.clipy1 - y;
+		#endif
+
+		if (lines >= cy || -lines >= cy) {
+			gdisp_lld_fill_area(x, y, cx, cy, bgcolor);
+		} else if (lines > 0) {
+			shadow_move(x, y + lines, cx, cy - lines, x, y);
+			gdisp_lld_fill_area(x, y + cy - lines, cx, lines, bgcolor);
+		} else {
+			shadow_move(x, y, cx, cy + lines, x, y - lines);
+			gdisp_lld_fill_area(x, y, cx, -lines, bgcolor);
+		}
+	}
+#endif
+
+#if GDISP_NEED_COPYAREA
+	void gdisp_lld_copy_area(coord_t srcx, coord_t srcy, coord_t cx, coord_t cy, coord_t dstx, coord_t dsty) {
+		#if GDISP_NEED_VALIDATION || GDISP_NEED_CLIP
+			/* The source must be on the screen and the destination within the clipping area */
+			if (srcx < 0) { cx += srcx; dstx -= srcx; srcx = 0; }
+			if (srcy < 0) { cy += srcy; dsty -= srcy; srcy = 0; }
+			if (srcx+cx > GDISP.Width)	cx = GDISP.Width - srcx;
+			if (srcy+cy > GDISP.Height)	cy = GDISP.Height - srcy;
+			if (dstx < GDISP.clipx0) { cx -= GDISP.clipx0 - dstx; srcx += GDISP.clipx0 - dstx; dstx = GDISP.clipx0; }
+			if (dsty < GDISP.clipy0) { cy -= GDISP.clipy0 - dsty; srcy += GDISP.clipy0 - dsty; dsty = GDISP.clipy0; }
+			if (cx <= 0 || cy <= 0 || dstx >= GDISP.clipx1 || dsty >= GDISP.clipy1) return;
+			if (dstx+cx > GDISP.clipx1)	cx = GDISP.clipx1 - dstx;
+			if (dsty+cy > GDISP.clipy1)	cy = GDISP.clipy1 - dsty;
+		#endif
+		if (srcx == dstx && srcy == dsty) return;
+
+		shadow_move(srcx, srcy, cx, cy, dstx, dsty);
+	}
+#endif
+
+#if GDISP_NEED_CONTROL
+	void gdisp_lld_control(unsigned what, void *value) {
+		gdisp_orientation_t	orient;
+
+		orient = GDISP.Orientation;
+		gdisp_lld_panel_control(what, value);
+
+		/* The shadow area is in screen coordinates so it starts again in the new orientation */
+		if (what == GDISP_CONTROL_ORIENTATION && GDISP.Orientation != orient && shadowSize) {
+			shadow_setarea();
+			shadow_reset();
+		}
+	}
+#endif
+
+#if GDISP_NEED_QUERY
+	void *gdisp_lld_query(unsigned what) {
+		return gdisp_lld_panel_query(what);
+	}
+#endif
+
+void gdispShadowFlush(void) {
+	#if !GDISP_SHADOW_AUTOFLUSH
+		coord_t		i, j, rows;
+		#if GDISP_NEED_VALIDATION || GDISP_NEED_CLIP
+			coord_t		clipx0, clipy0, clipx1, clipy1;
+		#endif
+
+		gdispLock();
+
+		/* The panel must accept the whole shadow regardless of the current clipping area */
+		#if GDISP_NEED_VALIDATION || GDISP_NEED_CLIP
+			clipx0 = GDISP.clipx0;	GDISP.clipx0 = 0;
+			clipy0 = GDISP.clipy0;	GDISP.clipy0 = 0;
+			clipx1 = GDISP.clipx1;	GDISP.clipx1 = GDISP.Width;
+			clipy1 = GDISP.clipy1;	GDISP.clipy1 = GDISP.Height;
+		#endif
+
+		/* Neighbouring rows that changed over the same columns are sent with a single blit */
+		rows = shy1 - shy0;
+		for(i = 0; i < rows; i = j) {
+			j = i + 1;
+			if (dirtyx0[i] >= dirtyx1[i])
+				continue;
+			while(j < rows && dirtyx0[j] == dirtyx0[i] && dirtyx1[j] == dirtyx1[i])
+				j++;
+			gdisp_lld_panel_blit_area_ex(dirtyx0[i], shy0 + i, dirtyx1[i] - dirtyx0[i], j - i, dirtyx0[i] - shx0, i, shx1 - shx0, shadowBuf);
+			memset(dirtyx0 + i, 0, (j - i) * sizeof(coord_t));
+			memset(dirtyx1 + i, 0, (j - i) * sizeof(coord_t));
+		}
+
+		#if GDISP_NEED_VALIDATION || GDISP_NEED_CLIP
+			GDISP.clipx0 = clipx0;
+			GDISP.clipy0 = clipy0;
+			GDISP.clipx1 = clipx1;
+			GDISP.clipy1 = clipy1;
+		#endif
+
+		gdispUnlock();
+	#endif
+}
+
+#endif /* GFX_USE_GDISP && GDISP_NEED_SHADOW */
+/** @} */
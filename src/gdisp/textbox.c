@@ -0,0 +1,324 @@
+/*
+    ChibiOS/GFX - Copyright (C) 2012, 2013
+                 Joel Bodenmann aka Tectu <joel@unormal.org>
+
+    This file is part of ChibiOS/GFX.
+
+    ChibiOS/GFX is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    ChibiOS/GFX is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file    src/gdisp/textbox.c
+ * @brief   GDISP multi-line text box code.
+ *
+ * @addtogroup GDISP
+ * @{
+ */
+#include "ch.h"
+#include "hal.h"
+#include "gfx.h"
+
+#if GFX_USE_GDISP && GDISP_NEED_TEXT && GDISP_NEED_TEXTBOX
+
+#include "gdisp/fonts.h"
+
+static const char	ellipsis[] = "...";
+
+/*
+ * Measure a line starting at s and return where the next line starts.
+ * Returns NULL if the line ends at the end of the string.
+ */
+static const char *breakLine(const gdispTextLayout *pl, const char *s, gdispTextLine *pline) {
+	const char	*p, *q, *brk, *ink;
+	coord_t		w, pad, width, brkwidth, inkwidth;
+	unicode_t	c;
+	bool_t		inspace;
+
+	pad = pl->font->charPadding * pl->font->xscale;
+	width = brkwidth = inkwidth = 0;
+	brk = 0;
+	ink = s;
+	inspace = FALSE;
+	for(p = s; *p; ) {
+		/* A forced line break */
+		if (*p == '\n') {
+			p++;
+			goto linedone;
+		}
+
+		/* Get the next printable character */
+		q = p;
+		c = _getStringChar(p);
+		w = _getCharWidth(pl->font, c) * pl->font->xscale;
+		if (!w) continue;
+
+		/* Handle inter-character padding */
+		if (width)
+			w += pad;
+
+		/* Remember where a run of spaces starts - we can break the line there */
+		if (c == ' ') {
+			if (!inspace) {
+				brk = q;
+				brkwidth = width;
+				inspace = TRUE;
+			}
+		} else
+			inspace = FALSE;
+
+		/* Does it still fit? The first character always does */
+		if ((pl->flags & GDISP_TEXT_WRAP) && width && width + w > pl->cx) {
+			if (brk && brkwidth) {
+				/* Break between words. A forced break straight after the spaces is part of this break. */
+				ink = brk;
+				inkwidth = brkwidth;
+				for(p = brk; *p == ' '; p++);
+				if (*p == '\n')
+					p++;
+			} else
+				/* The word is too long for a line - break it */
+				p = q;
+			if (!*p)
+				p = 0;
+			goto linedone;
+		}
+		width += w;
+
+		/* Trailing spaces aren't part of the line */
+		if (c != ' ') {
+			ink = p;
+			inkwidth = width;
+		}
+	}
+	p = 0;
+
+linedone:
+	pline->start = s - pl->str;
+	pline->len = ink - s;
+	pline->width = inkwidth;
+	return p;
+}
+
+/* Lay out lines until there are at least needed of them */
+static void layout(gdispTextLayout *pl, const char *str, font_t font, coord_t cx, unsigned needed) {
+	const char		*next;
+
+	/* Anything other than the contents changed means starting again */
+	if (pl->str != str || pl->font != font || pl->cx != cx) {
+		pl->str = str;
+		pl->font = font;
+		pl->cx = cx;
+		pl->complete = FALSE;
+		pl->next = 0;
+		pl->count = 0;
+	}
+
+	if (needed > pl->maxlines)
+		needed = pl->maxlines;
+	while(pl->count < needed && !pl->complete) {
+		next = breakLine(pl, str + pl->next, &pl->lines[pl->count]);
+		pl->count++;
+		if (next)
+			pl->next = next - str;
+		else
+			pl->complete = TRUE;
+	}
+}
+
+/* Draw characters from s to e that fit before ex and return where the next character would go */
+static coord_t drawChars(coord_t x, coord_t y, coord_t ex, const char *s, const char *e, font_t font, color_t color, color_t bgcolor, bool_t fill, bool_t *pfirst) {
+	coord_t		w, p, h;
+	unicode_t	c;
+
+	h = font->height * font->yscale;
+	p = font->charPadding * font->xscale;
+	while(s < e) {
+		/* Get the next printable character */
+		c = _getStringChar(s);
+		w = _getCharWidth(font, c) * font->xscale;
+		if (!w) continue;
+
+		/* Handle inter-character padding */
+		if (p) {
+			if (!*pfirst) {
+				if (x + p > ex) break;
+				if (fill)
+					gdispFillArea_unsafe(x, y, p, h, bgcolor);
+				x += p;
+			} else
+				*pfirst = FALSE;
+		}
+
+		/* Print the character */
+		if (x + w > ex) break;
+		if (fill)
+			gdispFillChar_unsafe(x, y, c, font, color, bgcolor);
+		else
+			gdispDrawChar_unsafe(x, y, c, font, color);
+		x += w;
+	}
+	return x;
+}
+
+/* Draw a line. If more is TRUE there is text after this line that can't be shown. */
+static void drawLine(coord_t x, coord_t y, coord_t cx, const gdispTextLayout *pl, const gdispTextLine *pline, bool_t more,
+						color_t color, color_t bgcolor, bool_t fill, justify_t justify) {
+	const char	*s, *e, *q, *fit;
+	coord_t		width, ewidth, w, p, xpos;
+	unicode_t	c;
+	bool_t		first;
+
+	s = pl->str + pline->start;
+	e = s + pline->len;
+	width = pline->width;
+	ewidth = 0;
+
+	/* Find how much of the line fits with the ellipsis after it */
+	if ((pl->flags & GDISP_TEXT_ELLIPSIS) && (more || width > cx)) {
+		p = pl->font->charPadding * pl->font->xscale;
+		ewidth = gdispGetStringWidth(ellipsis, pl->font);
+		width = 0;
+		for(fit = q = s; q < e; ) {
+			c = _getStringChar(q);
+			w = _getCharWidth(pl->font, c) * pl->font->xscale;
+			if (!w) continue;
+			if (width)
+				w += p;
+			if (width + w + p + ewidth > cx) break;
+			width += w;
+			fit = q;
+		}
+		e = fit;
+		if (width)
+			width += p;
+		width += ewidth;
+	}
+
+	switch(justify) {
+	case justifyCenter:
+		xpos = x + (cx - width)/2;
+		break;
+	case justifyRight:
+		xpos = x + cx - width;
+		break;
+	case justifyLeft:
+		/* Fall through */
+	default:
+		xpos = x;
+		break;
+	}
+	if (xpos < x)
+		xpos = x;
+
+	/* Fill any space to the left */
+	if (fill && x < xpos)
+		gdispFillArea_unsafe(x, y, xpos-x, pl->font->height * pl->font->yscale, bgcolor);
+
+	/* The text and the ellipsis */
+	first = TRUE;
+	xpos = drawChars(xpos, y, x+cx, s, e, pl->font, color, bgcolor, fill, &first);
+	if (ewidth)
+		xpos = drawChars(xpos, y, x+cx, ellipsis, ellipsis+sizeof(ellipsis)-1, pl->font, color, bgcolor, fill, &first);
+
+	/* Fill any space to the right */
+	if (fill && xpos < x+cx)
+		gdispFillArea_unsafe(xpos, y, x+cx-xpos, pl->font->height * pl->font->yscale, bgcolor);
+}
+
+static void textBox(coord_t x, coord_t y, coord_t cx, coord_t cy, const char *str, font_t font, color_t color, color_t bgcolor, bool_t fill, justify_t justify, gdispTextLayout *pl) {
+	coord_t		h, pitch, ey;
+	unsigned	i, n;
+
+	if (!str) str = "";
+
+	h = font->height * font->yscale;
+	pitch = font->lineSpacing * font->yscale;
+	if (pitch < h)
+		pitch = h;
+
+	/* Only whole lines are shown. Lay out one more so we know if the text is cut off. */
+	n = cy < h ? 0 : (cy - h) / pitch + 1;
+	layout(pl, str, font, cx, n + 1);
+	if (n > pl->count)
+		n = pl->count;
+
+	ey = y + cy;
+	gdispLock();
+	for(i = 0; i < n; i++) {
+		drawLine(x, y, cx, pl, &pl->lines[i], i == n-1 && (n < pl->count || !pl->complete), color, bgcolor, fill, justify);
+		y += h;
+
+		/* Fill between the lines */
+		if (fill && i < n-1 && pitch > h)
+			gdispFillArea_unsafe(x, y, cx, pitch - h, bgcolor);
+		y += pitch - h;
+	}
+
+	/* Fill below the last line */
+	if (fill) {
+		if (n)
+			y -= pitch - h;
+		if (y < ey)
+			gdispFillArea_unsafe(x, y, cx, ey - y, bgcolor);
+	}
+	gdispUnlock();
+}
+
+void gdispTextLayoutInit(gdispTextLayout *pl, gdispTextLine *lines, unsigned maxlines, uint8_t flags) {
+	pl->str = 0;
+	pl->font = 0;
+	pl->cx = 0;
+	pl->flags = flags;
+	pl->complete = FALSE;
+	pl->next = 0;
+	pl->count = 0;
+	pl->maxlines = maxlines;
+	pl->lines = lines;
+}
+
+void gdispTextLayoutChanged(gdispTextLayout *pl, size_t pos) {
+	unsigned	i;
+
+	/* Find the line the change is in */
+	for(i = pl->count; i > 0 && pl->lines[i-1].start > pos; i--);
+	if (i)
+		i--;
+
+	/* When wrapping the first word of this line might now fit on the line before */
+	if (i && (pl->flags & GDISP_TEXT_WRAP))
+		i--;
+
+	if (i < pl->count) {
+		pl->count = i;
+		pl->next = pl->lines[i].start;
+	}
+	pl->complete = FALSE;
+}
+
+unsigned gdispTextLayoutUpdate(gdispTextLayout *pl, const char *str, font_t font, coord_t cx) {
+	if (!str) str = "";
+	layout(pl, str, font, cx, pl->maxlines);
+	return pl->count;
+}
+
+void gdispDrawTextBox(coord_t x, coord_t y, coord_t cx, coord_t cy, const char *str, font_t font, color_t color, justify_t justify, gdispTextLayout *pl) {
+	textBox(x, y, cx, cy, str, font, color, color, FALSE, justify, pl);
+}
+
+void gdispFillTextBox(coord_t x, coord_t y, coord_t cx, coord_t cy, const char *str, font_t font, color_t color, color_t bgcolor, justify_t justify, gdispTextLayout *pl) {
+	textBox(x, y, cx, cy, str, font, color, bgcolor, TRUE, justify, pl);
+}
+
+#endif /* GFX_USE_GDISP && GDISP_NEED_TEXT && GDISP_NEED_TEXTBOX */
+/** @} */
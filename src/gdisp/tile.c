@@ -0,0 +1,487 @@
+/*
+    ChibiOS/GFX - Copyright (C) 2012, 2013
+                 Joel Bodenmann aka Tectu <joel@unormal.org>
+
+    This file is part of ChibiOS/GFX.
+
+    ChibiOS/GFX is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    ChibiOS/GFX is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file    src/gdisp/tile.c
+ * @brief   GDISP tile renderer code.
+ *
+ * @addtogroup GDISP
+ * @{
+ */
+#include "ch.h"
+#include "hal.h"
+#include "gfx.h"
+
+#if GFX_USE_GDISP && GDISP_NEED_TILE
+
+#if GDISP_NEED_TEXT
+	#include "gdisp/fonts.h"
+#endif
+
+/* The address of a pixel in the tile buffer */
+#define TILEPIXEL(pt, x, y)		(&(pt)->buf[((y) - (pt)->y0) * (pt)->cx + ((x) - (pt)->x0)])
+
+void gdispTileRender(coord_t x, coord_t y, coord_t cx, coord_t cy, pixel_t *buf, size_t bufsize, gdispTileRenderFn fn, void *param) {
+	gdispTile	t;
+	coord_t		lines;
+
+	if (cx <= 0 || cy <= 0) return;
+
+	/* How many lines fit in the tile buffer */
+	lines = bufsize / (size_t)cx;
+	if (!lines) return;
+	if (lines > cy)
+		lines = cy;
+
+	t.x0 = x;
+	t.x1 = x + cx;
+	t.cx = cx;
+	t.buf = buf;
+
+	for(t.y0 = y; t.y0 < y + cy; t.y0 = t.y1) {
+		t.y1 = t.y0 + lines;
+		if (t.y1 > y + cy)
+			t.y1 = y + cy;
+
+		/* Compose the tile */
+		fn(&t, param);
+
+		/* Send it - one window for the whole tile. We must wait for the blit to complete
+		 *	before we can re-use the buffer so it can't be queued in async mode.
+		 */
+		gdispLock();
+		gdispBlitAreaEx_unsafe(t.x0, t.y0, cx, t.y1 - t.y0, 0, 0, cx, buf);
+		gdispUnlock();
+	}
+}
+
+bool_t gdispTileIntersects(const gdispTile *pt, coord_t x, coord_t y, coord_t cx, coord_t cy) {
+	return x < pt->x1 && x + cx > pt->x0 && y < pt->y1 && y + cy > pt->y0;
+}
+
+void gdispTileFillArea(gdispTile *pt, coord_t x, coord_t y, coord_t cx, coord_t cy, color_t color) {
+	pixel_t		*p;
+	coord_t		x1, y1, i;
+
+	/* Clip to the tile */
+	x1 = x + cx;
+	y1 = y + cy;
+	if (x < pt->x0) x = pt->x0;
+	if (y < pt->y0) y = pt->y0;
+	if (x1 > pt->x1) x1 = pt->x1;
+	if (y1 > pt->y1) y1 = pt->y1;
+	if (x >= x1 || y >= y1) return;
+
+	cx = x1 - x;
+	for(; y < y1; y++) {
+		p = TILEPIXEL(pt, x, y);
+		for(i = 0; i < cx; i++)
+			*p++ = color;
+	}
+}
+
+void gdispTileClear(gdispTile *pt, color_t color) {
+	gdispTileFillArea(pt, pt->x0, pt->y0, pt->x1 - pt->x0, pt->y1 - pt->y0, color);
+}
+
+void gdispTileDrawPixel(gdispTile *pt, coord_t x, coord_t y, color_t color) {
+	if (x < pt->x0 || x >= pt->x1 || y < pt->y0 || y >= pt->y1) return;
+	*TILEPIXEL(pt, x, y) = color;
+}
+
+void gdispTileDrawLine(gdispTile *pt, coord_t x0, coord_t y0, coord_t x1, coord_t y1, color_t color) {
+	int16_t dy, dx;
+	int16_t addx, addy;
+	int16_t P, diff, i;
+
+	/* Horizontal and vertical lines are just fills */
+	if (x0 == x1) {
+		if (y1 > y0)
+			gdispTileFillArea(pt, x0, y0, 1, y1-y0+1, color);
+		else
+			gdispTileFillArea(pt, x0, y1, 1, y0-y1+1, color);
+		return;
+	}
+	if (y0 == y1) {
+		if (x1 > x0)
+			gdispTileFillArea(pt, x0, y0, x1-x0+1, 1, color);
+		else
+			gdispTileFillArea(pt, x1, y0, x0-x1+1, 1, color);
+		return;
+	}
+
+	/* Don't bother if the line can't touch this tile */
+	if ((y0 < pt->y0 && y1 < pt->y0) || (y0 >= pt->y1 && y1 >= pt->y1))
+		return;
+
+	if (x1 >= x0) {
+		dx = x1 - x0;
+		addx = 1;
+	} else {
+		dx = x0 - x1;
+		addx = -1;
+	}
+	if (y1 >= y0) {
+		dy = y1 - y0;
+		addy = 1;
+	} else {
+		dy = y0 - y1;
+		addy = -1;
+	}
+
+	if (dx >= dy) {
+		dy *= 2;
+		P = dy - dx;
+		diff = P - dx;
+
+		for(i=0; i<=dx; ++i) {
+			gdispTileDrawPixel(pt, x0, y0, color);
+			if (P < 0) {
+				P  += dy;
+				x0 += addx;
+			} else {
+				P  += diff;
+				x0 += addx;
+				y0 += addy;
+			}
+		}
+	} else {
+		dx *= 2;
+		P = dx - dy;
+		diff = P - dy;
+
+		for(i=0; i<=dy; ++i) {
+			gdispTileDrawPixel(pt, x0, y0, color);
+			if (P < 0) {
+				P  += dx;
+				y0 += addy;
+			} else {
+				P  += diff;
+				x0 += addx;
+				y0 += addy;
+			}
+		}
+	}
+}
+
+void gdispTileDrawBox(gdispTile *pt, coord_t x, coord_t y, coord_t cx, coord_t cy, color_t color) {
+	if (cx <= 0 || cy <= 0) return;
+	if (cx <= 2 || cy <= 2) {
+		gdispTileFillArea(pt, x, y, cx, cy, color);
+		return;
+	}
+	gdispTileFillArea(pt, x, y, cx, 1, color);
+	gdispTileFillArea(pt, x, y+cy-1, cx, 1, color);
+	gdispTileFillArea(pt, x, y+1, 1, cy-2, color);
+	gdispTileFillArea(pt, x+cx-1, y+1, 1, cy-2, color);
+}
+
+void gdispTileBlitArea(gdispTile *pt, coord_t x, coord_t y, coord_t cx, coord_t cy, coord_t srcx, coord_t srcy, coord_t srccx, const pixel_t *buffer) {
+	const pixel_t	*s;
+	pixel_t			*d;
+	coord_t			i;
+
+	/* Clip to the tile adjusting the source position as we go */
+	if (x < pt->x0) { cx -= pt->x0 - x; srcx += pt->x0 - x; x = pt->x0; }
+	if (y < pt->y0) { cy -= pt->y0 - y; srcy += pt->y0 - y; y = pt->y0; }
+	if (x + cx > pt->x1) cx = pt->x1 - x;
+	if (y + cy > pt->y1) cy = pt->y1 - y;
+	if (cx <= 0 || cy <= 0) return;
+
+	buffer += srcy * srccx + srcx;
+	for(; cy; cy--, y++, buffer += srccx) {
+		s = buffer;
+		d = TILEPIXEL(pt, x, y);
+		for(i = 0; i < cx; i++)
+			*d++ = *s++;
+	}
+}
+
+#if GDISP_NEED_CIRCLE
+	void gdispTileDrawCircle(gdispTile *pt, coord_t x, coord_t y, coord_t radius, color_t color) {
+		coord_t a, b, P;
+
+		if (!gdispTileIntersects(pt, x-radius, y-radius, 2*radius+1, 2*radius+1))
+			return;
+
+		a = 0;
+		b = radius;
+		P = 1 - radius;
+
+		do {
+			gdispTileDrawPixel(pt, x+a, y+b, color);
+			gdispTileDrawPixel(pt, x+b, y+a, color);
+			gdispTileDrawPixel(pt, x-a, y+b, color);
+			gdispTileDrawPixel(pt, x-b, y+a, color);
+			gdispTileDrawPixel(pt, x+b, y-a, color);
+			gdispTileDrawPixel(pt, x+a, y-b, color);
+			gdispTileDrawPixel(pt, x-a, y-b, color);
+			gdispTileDrawPixel(pt, x-b, y-a, color);
+			if (P < 0)
+				P += 3 + 2*a++;
+			else
+				P += 5 + 2*(a++ - b--);
+		} while(a <= b);
+	}
+
+	void gdispTileFillCircle(gdispTile *pt, coord_t x, coord_t y, coord_t radius, color_t color) {
+		coord_t a, b, P;
+
+		if (!gdispTileIntersects(pt, x-radius, y-radius, 2*radius+1, 2*radius+1))
+			return;
+
+		a = 0;
+		b = radius;
+		P = 1 - radius;
+
+		do {
+			gdispTileFillArea(pt, x-a, y+b, 2*a+1, 1, color);
+			gdispTileFillArea(pt, x-a, y-b, 2*a+1, 1, color);
+			gdispTileFillArea(pt, x-b, y+a, 2*b+1, 1, color);
+			gdispTileFillArea(pt, x-b, y-a, 2*b+1, 1, color);
+			if (P < 0)
+				P += 3 + 2*a++;
+			else
+				P += 5 + 2*(a++ - b--);
+		} while(a <= b);
+	}
+#endif
+
+#if GDISP_NEED_TEXT
+	void gdispTileDrawChar(gdispTile *pt, coord_t x, coord_t y, unicode_t c, font_t font, color_t color) {
+		const fontcolumn_t	*ptr;
+		fontcolumn_t		column;
+		coord_t				width, height, xscale, yscale;
+		coord_t				i, j, xs, ys;
+		#if GDISP_NEED_FONT_LOAD
+			bool_t			paged;
+		#endif
+
+		/* Check we actually have something to print */
+		width = _getCharWidth(font, c);
+		if (!width) return;
+
+		xscale = font->xscale;
+		yscale = font->yscale;
+		height = font->height * yscale;
+		width *= xscale;
+
+		if (!gdispTileIntersects(pt, x, y, width, height))
+			return;
+
+		#if GDISP_NEED_FONT_LOAD
+			/* A loaded font's glyph cache is shared with the display drawing. It is only used with the GDISP lock held. */
+			paged = (font->format & FONT_FORMAT_PAGED) != 0;
+			if (paged)
+				gdispLock();
+		#endif
+
+		/* Row based fonts - each run of foreground pixels is a single fill.
+		 *	Anti-aliased edges are blended with the tile pixels.
+		 */
+		if (_getFontFormat(font) != FONT_FORMAT_COLUMNS) {
+			fontdecoder_t	d;
+			uint8_t			level, max;
+			coord_t			n;
+			pixel_t			*p;
+
+			max = (1 << (font->bpp ? font->bpp : 1)) - 1;
+			fontDecodeStart(&d, font, c);
+			for(j = 0; j < height; j += yscale) {
+				for(i = 0; i < width; i += n) {
+					n = fontDecodeRun(&d, &level) * xscale;
+					if (level == max)
+						gdispTileFillArea(pt, x+i, y+j, n, yscale, color);
+					else if (level) {
+						for(ys = y+j; ys < y+j+yscale; ys++) {
+							if (ys < pt->y0 || ys >= pt->y1) continue;
+							for(xs = x+i; xs < x+i+n; xs++) {
+								if (xs < pt->x0 || xs >= pt->x1) continue;
+								p = TILEPIXEL(pt, xs, ys);
+								*p = fontBlendColor(color, *p, level, font->bpp);
+							}
+						}
+					}
+				}
+			}
+			#if GDISP_NEED_FONT_LOAD
+				if (paged)
+					gdispUnlock();
+			#endif
+			return;
+		}
+
+		ptr = _getCharData(font, c);
+
+		/* Loop through the data and display. The font data is LSBit first, down the column */
+		for(i=0; i < width; i+=xscale) {
+			/* Get the font bitmap data for the column */
+			column = *ptr++;
+
+			/* Draw each pixel */
+			for(j=0; j < height; j+=yscale, column >>= 1) {
+				if (column & 0x01) {
+					for(xs=0; xs < xscale; xs++)
+						for(ys=0; ys < yscale; ys++)
+							gdispTileDrawPixel(pt, x+i+xs, y+j+ys, color);
+				}
+			}
+		}
+		#if GDISP_NEED_FONT_LOAD
+			if (paged)
+				gdispUnlock();
+		#endif
+	}
+
+	void gdispTileFillChar(gdispTile *pt, coord_t x, coord_t y, unicode_t c, font_t font, color_t color, color_t bgcolor) {
+		coord_t			width, height;
+
+		/* Check we actually have something to print */
+		width = _getCharWidth(font, c) * font->xscale;
+		if (!width) return;
+		height = font->height * font->yscale;
+
+		/* It's all in RAM so the background fill is cheap */
+		gdispTileFillArea(pt, x, y, width, height, bgcolor);
+		gdispTileDrawChar(pt, x, y, c, font, color);
+	}
+
+	void gdispTileDrawString(gdispTile *pt, coord_t x, coord_t y, const char *str, font_t font, color_t color) {
+		coord_t		w, p;
+		unicode_t	c;
+		int			first;
+
+		/* Nothing to do if the line of text isn't in this tile */
+		if (y >= pt->y1 || y + font->height * font->yscale <= pt->y0)
+			return;
+
+		first = 1;
+		p = font->charPadding * font->xscale;
+		while(*str && x < pt->x1) {
+			/* Get the next printable character */
+			c = _getStringChar(str);
+			w = _getCharWidth(font, c) * font->xscale;
+			if (!w) continue;
+
+			/* Handle inter-character padding */
+			if (p) {
+				if (!first)
+					x += p;
+				else
+					first = 0;
+			}
+
+			/* Print the character */
+			gdispTileDrawChar(pt, x, y, c, font, color);
+			x += w;
+		}
+	}
+
+	void gdispTileFillString(gdispTile *pt, coord_t x, coord_t y, const char *str, font_t font, color_t color, color_t bgcolor) {
+		coord_t		w, h, p;
+		unicode_t	c;
+		int			first;
+
+		/* Nothing to do if the line of text isn't in this tile */
+		h = font->height * font->yscale;
+		if (y >= pt->y1 || y + h <= pt->y0)
+			return;
+
+		first = 1;
+		p = font->charPadding * font->xscale;
+		while(*str && x < pt->x1) {
+			/* Get the next printable character */
+			c = _getStringChar(str);
+			w = _getCharWidth(font, c) * font->xscale;
+			if (!w) continue;
+
+			/* Handle inter-character padding */
+			if (p) {
+				if (!first) {
+					gdispTileFillArea(pt, x, y, p, h, bgcolor);
+					x += p;
+				} else
+					first = 0;
+			}
+
+			/* Print the character */
+			gdispTileFillChar(pt, x, y, c, font, color, bgcolor);
+			x += w;
+		}
+	}
+#endif
+
+/* The render callback used for display lists */
+static void renderList(gdispTile *pt, void *param) {
+	const gdispTileOp	*op, *eop;
+
+	op = ((const gdispTileOp **)param)[0];
+	eop = ((const gdispTileOp **)param)[1];
+
+	for(; op < eop; op++) {
+		switch(op->op) {
+		case GDISP_TILEOP_FILL:
+			gdispTileFillArea(pt, op->x, op->y, op->cx, op->cy, op->color);
+			break;
+		case GDISP_TILEOP_PIXEL:
+			gdispTileDrawPixel(pt, op->x, op->y, op->color);
+			break;
+		case GDISP_TILEOP_LINE:
+			gdispTileDrawLine(pt, op->x, op->y, op->cx, op->cy, op->color);
+			break;
+		case GDISP_TILEOP_BOX:
+			if (gdispTileIntersects(pt, op->x, op->y, op->cx, op->cy))
+				gdispTileDrawBox(pt, op->x, op->y, op->cx, op->cy, op->color);
+			break;
+		case GDISP_TILEOP_BLIT:
+			gdispTileBlitArea(pt, op->x, op->y, op->cx, op->cy, 0, 0, op->cx, (const pixel_t *)op->ptr);
+			break;
+		#if GDISP_NEED_CIRCLE
+			case GDISP_TILEOP_CIRCLE:
+				gdispTileDrawCircle(pt, op->x, op->y, op->cx, op->color);
+				break;
+			case GDISP_TILEOP_FILLCIRCLE:
+				gdispTileFillCircle(pt, op->x, op->y, op->cx, op->color);
+				break;
+		#endif
+		#if GDISP_NEED_TEXT
+			case GDISP_TILEOP_STRING:
+				gdispTileDrawString(pt, op->x, op->y, (const char *)op->ptr, op->font, op->color);
+				break;
+			case GDISP_TILEOP_FILLSTRING:
+				gdispTileFillString(pt, op->x, op->y, (const char *)op->ptr, op->font, op->color, op->bgcolor);
+				break;
+		#endif
+		default:
+			break;
+		}
+	}
+}
+
+void gdispTileRenderList(coord_t x, coord_t y, coord_t cx, coord_t cy, pixel_t *buf, size_t bufsize, const gdispTileOp *ops, unsigned cnt) {
+	const gdispTileOp	*range[2];
+
+	range[0] = ops;
+	range[1] = ops + cnt;
+	gdispTileRender(x, y, cx, cy, buf, bufsize, renderList, range);
+}
+
+#endif /* GFX_USE_GDISP && GDISP_NEED_TILE */
+/** @} */
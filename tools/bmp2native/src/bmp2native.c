@@ -0,0 +1,386 @@
+/*
+    ChibiOS/GFX - Copyright (C) 2012, 2013
+                 Joel Bodenmann aka Tectu <joel@unormal.org>
+
+    This file is part of ChibiOS/GFX.
+
+    ChibiOS/GFX is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    ChibiOS/GFX is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_SIZE		0x7FFF		/* Widths and heights must fit in a coord_t */
+#define MAX_LITERAL		128			/* The longest literal run */
+#define MAX_REPEAT		128			/* The longest repeat run */
+
+#define FORMAT_RAW		1			/* A plain 'NI' native image */
+#define FORMAT_RLE		2			/* An RLE compressed 'NR' native image */
+
+static unsigned char	*bmp;		/* The input file */
+static unsigned long	bmplen;
+static unsigned long	*pixels;	/* width x height 0x00RRGGBB pixels */
+static int				width, height;
+
+/* Read little endian values from the BMP file */
+static unsigned get16(unsigned long pos) {
+	return pos + 2 <= bmplen ? bmp[pos] | (bmp[pos+1] << 8) : 0;
+}
+
+static unsigned long get32(unsigned long pos) {
+	return get16(pos) | ((unsigned long)get16(pos+2) << 16);
+}
+
+/* Write big endian values to the native image header */
+static void put16(FILE *f, unsigned v) {
+	fputc((v >> 8) & 0xFF, f);
+	fputc(v & 0xFF, f);
+}
+
+static void put32(FILE *f, unsigned long v) {
+	put16(f, (v >> 16) & 0xFFFF);
+	put16(f, v & 0xFFFF);
+}
+
+static char *filenameof(char *fname) {
+	char *p;
+
+#ifdef WIN32
+	if (fname[1] == ':')
+		fname = fname+2;
+	p = strrchr(fname, '\\');
+	if (p) fname = p+1;
+#endif
+	p = strrchr(fname, '/');
+	if (p) fname = p+1;
+	p = strchr(fname, '.');
+	if (p) *p = 0;
+	return fname;
+}
+
+/**
+ * Read an uncompressed BMP into pixels[].
+ *	1, 4, 8, 16 (5-5-5), 24 and 32 bit images are supported.
+ */
+static int readbmp(FILE *f) {
+	unsigned long	hdrsize, offset, stride, pos, v;
+	unsigned		bpp, compression, palsize, palentry;
+	int				x, y, topdown;
+
+	/* Read the whole file */
+	bmplen = 0;
+	bmp = 0;
+	do {
+		if (!(bmp = realloc(bmp, bmplen + 65536))) {
+			fprintf(stderr, "Out of memory\n");
+			return 0;
+		}
+		bmplen += fread(bmp + bmplen, 1, 65536, f);
+	} while(!feof(f) && !ferror(f));
+
+	if (bmplen < 26 || bmp[0] != 'B' || bmp[1] != 'M') {
+		fprintf(stderr, "The input file is not a BMP file\n");
+		return 0;
+	}
+	offset = get32(10);
+	hdrsize = get32(14);
+	if (hdrsize == 12) {
+		/* An old OS/2 header */
+		width = get16(18);
+		height = get16(20);
+		bpp = get16(24);
+		compression = 0;
+		palsize = 0;
+		palentry = 3;
+	} else {
+		width = (long)get32(18);
+		height = (long)get32(22);
+		bpp = get16(28);
+		compression = get32(30);
+		palsize = get32(46);
+		palentry = 4;
+	}
+	topdown = height < 0;
+	if (topdown)
+		height = -height;
+	if (width <= 0 || width > MAX_SIZE || height <= 0 || height > MAX_SIZE) {
+		fprintf(stderr, "Bad image size %dx%d\n", width, height);
+		return 0;
+	}
+	if (compression != 0 || (bpp != 1 && bpp != 4 && bpp != 8 && bpp != 16 && bpp != 24 && bpp != 32)) {
+		fprintf(stderr, "Only uncompressed 1, 4, 8, 16, 24 and 32 bit BMP files are supported\n");
+		return 0;
+	}
+	if (!palsize && bpp <= 8)
+		palsize = 1 << bpp;
+
+	stride = ((width * bpp + 31) / 32) * 4;
+	if (offset + stride * height > bmplen) {
+		fprintf(stderr, "The BMP file is truncated\n");
+		return 0;
+	}
+	if (!(pixels = malloc(sizeof(unsigned long) * width * height))) {
+		fprintf(stderr, "Out of memory\n");
+		return 0;
+	}
+
+	for(y = 0; y < height; y++) {
+		pos = offset + stride * (topdown ? y : height - 1 - y);
+		for(x = 0; x < width; x++) {
+			switch(bpp) {
+			case 1:		v = (bmp[pos + x/8] >> (7 - (x & 7))) & 1;					break;
+			case 4:		v = (bmp[pos + x/2] >> ((x & 1) ? 0 : 4)) & 0x0F;			break;
+			case 8:		v = bmp[pos + x];											break;
+			case 16:
+				v = get16(pos + x*2);
+				v = ((v & 0x7C00) << 9) | ((v & 0x03E0) << 6) | ((v & 0x001F) << 3);
+				v |= (v >> 5) & 0x070707;
+				break;
+			case 24:	v = bmp[pos + x*3] | (bmp[pos + x*3+1] << 8) | ((unsigned long)bmp[pos + x*3+2] << 16);	break;
+			default:	v = get32(pos + x*4) & 0xFFFFFF;							break;
+			}
+			if (bpp <= 8) {
+				if (v >= palsize) {
+					fprintf(stderr, "Bad palette index %lu\n", v);
+					return 0;
+				}
+				v = 14 + hdrsize + v * palentry;
+				if (v + 3 > bmplen) {
+					fprintf(stderr, "The BMP palette is truncated\n");
+					return 0;
+				}
+				v = bmp[v] | (bmp[v+1] << 8) | ((unsigned long)bmp[v+2] << 16);
+			}
+			pixels[y * width + x] = v;
+		}
+	}
+	return 1;
+}
+
+/* Convert a 0x00RRGGBB pixel to the display pixel format - as RGB2COLOR() does */
+static unsigned long tocolor(unsigned long v, int format) {
+	unsigned	r, g, b;
+
+	r = (v >> 16) & 0xFF;
+	g = (v >> 8) & 0xFF;
+	b = v & 0xFF;
+	switch(format) {
+	case 1:		return (r|g|b) ? 1 : 0;
+	case 888:	return v;
+	case 444:	return ((r & 0xF0)<<4) | (g & 0xF0) | ((b & 0xF0)>>4);
+	case 332:	return (r & 0xE0) | ((g & 0xE0)>>3) | ((b & 0xC0)>>6);
+	case 666:	return ((r & 0xFC)<<10) | ((g & 0xFC)<<4) | ((b & 0xFC)>>2);
+	default:	return ((r & 0xF8)<<8) | ((g & 0xFC)<<3) | ((b & 0xF8)>>3);
+	}
+}
+
+/* Write a pixel_t in the byte order of the display processor */
+static void putpixel(FILE *f, unsigned long v, int size, int bigendian) {
+	int		i;
+
+	for(i = 0; i < size; i++)
+		fputc((v >> (8 * (bigendian ? size - 1 - i : i))) & 0xFF, f);
+}
+
+/* How many identical pixels start at p (up to max) */
+static int runlength(unsigned long *p, int max) {
+	int		n;
+
+	for(n = 1; n < max && p[n] == p[0]; n++);
+	return n;
+}
+
+/**
+ * Encode (or just measure if f is NULL) a row of pixels as PackBits style runs.
+ *	A control byte of 0 to 127 is followed by that many plus one literal pixels.
+ *	A control byte of 129 to 255 is followed by one pixel repeated 257 minus the control byte times.
+ */
+static unsigned long encoderow(FILE *f, unsigned long *p, int size, int bigendian) {
+	unsigned long	len;
+	int				x, n, lit;
+
+	len = 0;
+	for(x = 0; x < width; ) {
+		/* A repeat run - two identical pixels are enough to be worth it */
+		n = runlength(p+x, width - x < MAX_REPEAT ? width - x : MAX_REPEAT);
+		if (n >= 2) {
+			if (f) {
+				fputc(257 - n, f);
+				putpixel(f, p[x], size, bigendian);
+			}
+			len += 1 + size;
+			x += n;
+			continue;
+		}
+
+		/* A literal run - up to the next repeat run */
+		for(lit = 1; x + lit < width && lit < MAX_LITERAL; lit++) {
+			if (x + lit + 1 < width && p[x+lit] == p[x+lit+1])
+				break;
+		}
+		if (f) {
+			fputc(lit - 1, f);
+			for(n = 0; n < lit; n++)
+				putpixel(f, p[x+n], size, bigendian);
+		}
+		len += 1 + lit * size;
+		x += lit;
+	}
+	return len;
+}
+
+int main(int argc, char * argv[])
+{
+char *		opt_progname;
+char *		opt_inputfile;
+char *		opt_outputfile;
+int			opt_format;
+int			opt_pixelformat;
+int			opt_bigendian;
+FILE *		f_input;
+FILE *		f_output;
+int			y, size;
+unsigned long	i, rawlen, rlelen, pos;
+
+	/* Default values for our parameters */
+	opt_progname = filenameof(argv[0]);
+	opt_inputfile = 0;
+	opt_outputfile = 0;
+	opt_format = 0;
+	opt_pixelformat = 565;
+	opt_bigendian = 0;
+
+	/* Read the arguments */
+	while(*++argv) {
+		if (argv[0][0] == '-') {
+			while (*++(argv[0])) {
+				switch(argv[0][0]) {
+				case '?': case 'h':							goto usage;
+				case 'u':		opt_format = FORMAT_RAW;	break;
+				case 'r':		opt_format = FORMAT_RLE;	break;
+				case 'B':		opt_bigendian = 1;			break;
+				case 'f':
+					if (!*++argv) goto usage;
+					opt_pixelformat = strcmp(*argv, "mono") ? strtol(*argv, 0, 0) : 1;
+					goto nextarg;
+				default:
+					fprintf(stderr, "Unknown flag -%c\n", argv[0][0]);
+					goto usage;
+				}
+			}
+		} else if (!opt_inputfile)
+			opt_inputfile = argv[0];
+		else if (!opt_outputfile)
+			opt_outputfile = argv[0];
+		else {
+			usage:
+			fprintf(stderr, "Usage:\n\t%s -?\n"
+							"\t%s [-urB] [-f format] [inputfile] [outputfile]\n"
+							"\t\t-?\tThis help\n"
+							"\t\t-h\tThis help\n"
+							"\t\t-u\tMake an uncompressed native image ('NI')\n"
+							"\t\t-r\tMake a run length compressed native image ('NR')\n"
+							"\t\t\tThe default is whichever is smaller\n"
+							"\t\t-B\tThe display processor is big endian (default little endian)\n"
+							"\t\t-f format\tThe display pixel format - GDISP_PIXELFORMAT\n"
+							"\t\t\tOne of 565 (default), 888, 444, 332, 666 or mono\n"
+							"\tThe input file must be an uncompressed BMP file.\n"
+					, opt_progname, opt_progname);
+			return 1;
+		}
+	nextarg:	;
+	}
+	switch(opt_pixelformat) {
+	case 1: case 332:		size = 1;	break;
+	case 565: case 444:		size = 2;	break;
+	case 888: case 666:		size = 4;	break;
+	default:				goto usage;
+	}
+
+	/* Open and read the input file */
+	if (opt_inputfile) {
+		f_input = fopen(opt_inputfile, "rb");
+		if (!f_input) {
+			fprintf(stderr, "Could not open input file '%s'\n", opt_inputfile);
+			goto usage;
+		}
+	} else
+		f_input = stdin;
+	if (!readbmp(f_input))
+		return 1;
+	if (ferror(f_input)) {
+		fprintf(stderr, "Input file read error\n");
+		return 1;
+	}
+	if (f_input != stdin)
+		fclose(f_input);
+
+	/* Convert to the display pixel format */
+	for(i = 0; i < (unsigned long)width * height; i++)
+		pixels[i] = tocolor(pixels[i], opt_pixelformat);
+
+	/* Choose the format */
+	rawlen = (unsigned long)width * height * size;
+	rlelen = ((unsigned long)height + 1) * 4;
+	for(y = 0; y < height; y++)
+		rlelen += encoderow(0, pixels + (unsigned long)y * width, size, opt_bigendian);
+	if (!opt_format)
+		opt_format = rlelen < rawlen ? FORMAT_RLE : FORMAT_RAW;
+
+	/* Open the output file */
+	if (opt_outputfile) {
+		f_output = fopen(opt_outputfile, "wb");
+		if (!f_output) {
+			fprintf(stderr, "Could not open output file '%s'\n", opt_outputfile);
+			goto usage;
+		}
+	} else
+		f_output = stdout;
+
+	/* The 8 byte header */
+	fputc('N', f_output);
+	fputc(opt_format == FORMAT_RLE ? 'R' : 'I', f_output);
+	put16(f_output, width);
+	put16(f_output, height);
+	put16(f_output, opt_pixelformat);
+
+	if (opt_format == FORMAT_RLE) {
+		/* The row offset table (with the end of the last row) followed by the rows */
+		pos = 8 + ((unsigned long)height + 1) * 4;
+		for(y = 0; y < height; y++) {
+			put32(f_output, pos);
+			pos += encoderow(0, pixels + (unsigned long)y * width, size, opt_bigendian);
+		}
+		put32(f_output, pos);
+		for(y = 0; y < height; y++)
+			encoderow(f_output, pixels + (unsigned long)y * width, size, opt_bigendian);
+	} else {
+		for(i = 0; i < (unsigned long)width * height; i++)
+			putpixel(f_output, pixels[i], size, opt_bigendian);
+	}
+
+	fflush(f_output);
+	if (ferror(f_output)) {
+		fprintf(stderr, "Output file write error\n");
+		return 1;
+	}
+	if (f_output != stdout)
+		fclose(f_output);
+
+	fprintf(stderr, "%dx%d %s image, %lu bytes (%lu uncompressed)\n", width, height,
+				opt_format == FORMAT_RLE ? "RLE" : "uncompressed",
+				8 + (opt_format == FORMAT_RLE ? rlelen : rawlen), 8 + rawlen);
+	return 0;
+}
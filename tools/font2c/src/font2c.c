@@ -0,0 +1,594 @@
+/*
+    ChibiOS/GFX - Copyright (C) 2012, 2013
+                 Joel Bodenmann aka Tectu <joel@unormal.org>
+
+    This file is part of ChibiOS/GFX.
+
+    ChibiOS/GFX is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    ChibiOS/GFX is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_CHARS		0x10000		/* The unicode basic multilingual plane */
+#define MAX_DENSE		0x7F		/* The last character that can be minChar to maxChar */
+#define MAX_SIZE		255			/* Widths and heights are a uint8_t */
+#define MAX_DATA		0x400000	/* The largest glyph data we can make */
+#define MAX_OFFSET		0xFFFF		/* Offsets are a uint16_t (relative to the range base) */
+#define MAX_GAP			4			/* Missing characters in a range before starting a new one */
+
+#define FORMAT_ROWS		1			/* FONT_FORMAT_ROWS */
+#define FORMAT_RLE		2			/* FONT_FORMAT_RLE */
+
+typedef struct glyph {
+	int				width;			/* The advance width (DWIDTH) */
+	unsigned char	*cell;			/* width x height pixels - one byte per pixel */
+} glyph;
+
+static glyph			glyphs[MAX_CHARS];
+static int				ascent, descent, height, bpp;
+static char				fontname[256];
+static unsigned char	rows[MAX_DATA], rle[MAX_DATA];
+static unsigned			rowsoffsets[MAX_CHARS], rleoffsets[MAX_CHARS];
+static unsigned			table[MAX_CHARS];		/* The characters in width table order */
+static unsigned			rangefirst[MAX_CHARS], rangecount[MAX_CHARS], rangeindex[MAX_CHARS], rangebase[MAX_CHARS];
+static char				line[1024];
+
+/* Write little endian values to a binary font file */
+static void put16(FILE *f, unsigned v) {
+	fputc(v & 0xFF, f);
+	fputc((v >> 8) & 0xFF, f);
+}
+
+static void put32(FILE *f, unsigned v) {
+	put16(f, v & 0xFFFF);
+	put16(f, v >> 16);
+}
+
+static char *filenameof(char *fname) {
+	char *p;
+
+#ifdef WIN32
+	if (fname[1] == ':')
+		fname = fname+2;
+	p = strrchr(fname, '\\');
+	if (p) fname = p+1;
+#endif
+	p = strrchr(fname, '/');
+	if (p) fname = p+1;
+	p = strchr(fname, '.');
+	if (p) *p = 0;
+	return fname;
+}
+
+static char *clean4c(char *fname) {
+	char *p;
+
+	while((p = strpbrk(fname, "-+ `~!@#$%^&*(){}[]|:;'\",<>?/|=.\\"))) *p = '_';
+	return fname;
+}
+
+static int hexdigit(char c) {
+	if (c >= '0' && c <= '9') return c - '0';
+	if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+	if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+	return 0;
+}
+
+/**
+ * Read a BDF font into glyphs[].
+ *	Each glyph is placed in a cell that is the full font height with the baseline
+ *	"descent" pixels above the bottom. Anything outside the cell is clipped.
+ */
+static int readbdf(FILE *f, int first, int last) {
+	int		bbw, bbh, bbx, bby;
+	int		fbbh, fbby;
+	int		enc, dwidth, r, c, x, y, len;
+	char	*p;
+
+	fbbh = fbby = 0;
+	ascent = descent = -1;
+	enc = -1;
+	dwidth = bbw = bbh = bbx = bby = 0;
+
+	while(fgets(line, sizeof(line), f)) {
+		if (!strncmp(line, "FONTBOUNDINGBOX ", 16)) {
+			sscanf(line+16, "%*d %d %*d %d", &fbbh, &fbby);
+		} else if (!strncmp(line, "FAMILY_NAME ", 12)) {
+			if ((p = strchr(line, '"'))) {
+				strncpy(fontname, p+1, sizeof(fontname)-1);
+				if ((p = strchr(fontname, '"'))) *p = 0;
+			}
+		} else if (!strncmp(line, "FONT_ASCENT ", 12)) {
+			ascent = atoi(line+12);
+		} else if (!strncmp(line, "FONT_DESCENT ", 13)) {
+			descent = atoi(line+13);
+		} else if (!strncmp(line, "CHARS ", 6)) {
+			/* All the properties have been read - fix up the cell height */
+			if (ascent < 0) ascent = fbbh + fbby;
+			if (descent < 0) descent = -fbby;
+			height = ascent + descent;
+			if (height <= 0 || height > MAX_SIZE) {
+				fprintf(stderr, "Bad font height %d\n", height);
+				return 0;
+			}
+		} else if (!strncmp(line, "ENCODING ", 9)) {
+			enc = atoi(line+9);
+		} else if (!strncmp(line, "DWIDTH ", 7)) {
+			dwidth = atoi(line+7);
+		} else if (!strncmp(line, "BBX ", 4)) {
+			sscanf(line+4, "%d %d %d %d", &bbw, &bbh, &bbx, &bby);
+		} else if (!strncmp(line, "BITMAP", 6)) {
+			if (!height) {
+				fprintf(stderr, "Missing CHARS line\n");
+				return 0;
+			}
+			if (enc < first || enc > last) {
+				enc = -1;
+				continue;
+			}
+			if (dwidth < 0 || dwidth > MAX_SIZE) {
+				fprintf(stderr, "Bad width %d for character %d\n", dwidth, enc);
+				return 0;
+			}
+			glyphs[enc].width = dwidth;
+			glyphs[enc].cell = calloc(dwidth * height + 1, 1);
+			for(r = 0; r < bbh && fgets(line, sizeof(line), f); r++) {
+				y = ascent - (bby + bbh) + r;
+				if (y < 0 || y >= height)
+					continue;
+				len = strspn(line, "0123456789abcdefABCDEF") * 4;
+				for(c = 0; c < bbw && c < len; c++) {
+					x = bbx + c;
+					if (x < 0 || x >= dwidth)
+						continue;
+					if (hexdigit(line[c/4]) & (0x08 >> (c & 3)))
+						glyphs[enc].cell[y * dwidth + x] = 1;
+				}
+			}
+			enc = -1;
+		} else if (!strncmp(line, "ENDCHAR", 7)) {
+			enc = -1;
+			dwidth = bbw = bbh = bbx = bby = 0;
+		}
+	}
+	if (!height) {
+		fprintf(stderr, "Not a BDF font\n");
+		return 0;
+	}
+	return 1;
+}
+
+/**
+ * Shrink the glyphs by "scale" turning each scale x scale block of pixels into a coverage level.
+ *	This produces an anti-aliased font from a BDF rasterized at "scale" times the wanted size.
+ */
+static void antialias(int scale) {
+	int				c, x, y, xs, ys, w, h, cnt;
+	unsigned char	*cell;
+
+	h = (height + scale - 1) / scale;
+	for(c = 0; c < MAX_CHARS; c++) {
+		if (!glyphs[c].cell)
+			continue;
+		w = (glyphs[c].width + scale/2) / scale;
+		cell = calloc(w * h + 1, 1);
+		for(y = 0; y < h; y++) {
+			for(x = 0; x < w; x++) {
+				cnt = 0;
+				for(ys = y*scale; ys < y*scale+scale && ys < height; ys++)
+					for(xs = x*scale; xs < x*scale+scale && xs < glyphs[c].width; xs++)
+						cnt += glyphs[c].cell[ys * glyphs[c].width + xs];
+				cell[y * w + x] = (cnt * ((1 << bpp) - 1) + scale*scale/2) / (scale*scale);
+			}
+		}
+		free(glyphs[c].cell);
+		glyphs[c].cell = cell;
+		glyphs[c].width = w;
+	}
+	descent = (descent + scale/2) / scale;
+	height = h;
+}
+
+/* Encode a glyph as rows of pixels - MSBit on the left, each row padded to a byte */
+static unsigned encoderows(glyph *g, unsigned pos) {
+	int		x, y, bit;
+
+	for(y = 0; y < height; y++) {
+		for(x = 0, bit = 0; x < g->width; x++, bit = (bit + bpp) & 7) {
+			if (pos >= MAX_DATA) return pos+1;
+			if (!bit) rows[pos++] = 0;
+			rows[pos-1] |= g->cell[y * g->width + x] << (8 - bpp - bit);
+		}
+	}
+	return pos;
+}
+
+/* Encode a glyph as alternating background and foreground runs starting with background */
+static unsigned encoderle(glyph *g, unsigned pos) {
+	int		i, total;
+	int		on, run;
+
+	total = g->width * height;
+	on = 0;
+	for(i = 0; i < total; on = !on) {
+		for(run = 0; i < total && g->cell[i] == on; i++, run++);
+		while(run > 255) {
+			if (pos+2 >= MAX_DATA) return MAX_DATA+1;
+			rle[pos++] = 255;
+			rle[pos++] = 0;
+			run -= 255;
+		}
+		if (pos >= MAX_DATA) return MAX_DATA+1;
+		rle[pos++] = run;
+	}
+	return pos;
+}
+
+int main(int argc, char * argv[])
+{
+char *		opt_progname;
+char *		opt_inputfile;
+char *		opt_outputfile;
+char *		opt_fontname;
+int			opt_format;
+int			opt_first;
+int			opt_last;
+int			opt_padding;
+int			opt_scale;
+int			opt_binary;
+FILE *		f_input;
+FILE *		f_output;
+unsigned	rowslen, rlelen, len, rowsmax, rlemax, maxglyph;
+unsigned	*offsets;
+unsigned char *data;
+int			c, first, last, minwidth, maxwidth;
+int			densefirst, denselast, tablelen, ranges, prev;
+
+	/* Default values for our parameters */
+	opt_progname = filenameof(argv[0]);
+	opt_inputfile = 0;
+	opt_outputfile = 0;
+	opt_fontname = 0;
+	opt_format = 0;
+	opt_first = ' ';
+	opt_last = '~';
+	opt_padding = 0;
+	opt_scale = 4;
+	opt_binary = 0;
+	bpp = 1;
+
+	/* Read the arguments */
+	while(*++argv) {
+		if (argv[0][0] == '-') {
+			while (*++(argv[0])) {
+				switch(argv[0][0]) {
+				case '?': case 'h':							goto usage;
+				case 'r':		opt_format = FORMAT_ROWS;	break;
+				case 'l':		opt_format = FORMAT_RLE;	break;
+				case 'b':		opt_binary = 1;				break;
+				case 'n':		opt_fontname = *++argv;		goto nextarg;
+				case 'f':		opt_first = strtol(*++argv, 0, 0);		goto nextarg;
+				case 'e':		opt_last = strtol(*++argv, 0, 0);		goto nextarg;
+				case 'p':		opt_padding = strtol(*++argv, 0, 0);	goto nextarg;
+				case 'a':		bpp = strtol(*++argv, 0, 0);			goto nextarg;
+				case 's':		opt_scale = strtol(*++argv, 0, 0);		goto nextarg;
+				default:
+					fprintf(stderr, "Unknown flag -%c\n", argv[0][0]);
+					goto usage;
+				}
+			}
+		} else if (!opt_inputfile)
+			opt_inputfile = argv[0];
+		else if (!opt_outputfile)
+			opt_outputfile = argv[0];
+		else {
+			usage:
+			fprintf(stderr, "Usage:\n\t%s -?\n"
+							"\t%s [-rlb] [-n name] [-f first] [-e last] [-p padding] [-a bpp [-s scale]] [inputfile] [outputfile]\n"
+							"\t\t-?\tThis help\n"
+							"\t\t-h\tThis help\n"
+							"\t\t-r\tUse the row format (FONT_FORMAT_ROWS)\n"
+							"\t\t-l\tUse the run length format (FONT_FORMAT_RLE)\n"
+							"\t\t\tThe default is whichever is smaller\n"
+							"\t\t-b\tMake a binary font file for gdispLoadFont() instead of C source\n"
+							"\t\t-n name\tUse \"name\" as the name of the font structure\n"
+							"\t\t-f first\tThe first character to convert (default 32)\n"
+							"\t\t-e last\tThe last character to convert (default 126, maximum 0xFFFF)\n"
+							"\t\t-p padding\tThe pixels between characters (default 0)\n"
+							"\t\t-a bpp\tMake an anti-aliased font with 2 or 4 bits per pixel.\n"
+							"\t\t\tThe input font must be \"scale\" times the wanted size.\n"
+							"\t\t\tIt is always in the row format.\n"
+							"\t\t-s scale\tHow much bigger the input font is for -a (default 4)\n"
+							"\tThe input file must be a BDF font with unicode encodings.\n"
+							"\tCharacters above 127 are stored as sparse ranges.\n"
+					, opt_progname, opt_progname);
+			return 1;
+		}
+	nextarg:	;
+	}
+	if (opt_first < 1 || opt_last >= MAX_CHARS || opt_first > opt_last || opt_padding < 0 || opt_padding > MAX_SIZE)
+		goto usage;
+	if ((bpp != 1 && bpp != 2 && bpp != 4) || opt_scale < 1 || opt_scale > 16)
+		goto usage;
+	if (bpp != 1) {
+		if (opt_format == FORMAT_RLE) {
+			fprintf(stderr, "Anti-aliased fonts can't use the run length format\n");
+			goto usage;
+		}
+		opt_format = FORMAT_ROWS;
+	}
+
+	/* Open and read the input file */
+	if (opt_inputfile) {
+		f_input = fopen(opt_inputfile, "r");
+		if (!f_input) {
+			fprintf(stderr, "Could not open input file '%s'\n", opt_inputfile);
+			goto usage;
+		}
+	} else
+		f_input = stdin;
+	if (!readbdf(f_input, opt_first, opt_last))
+		return 1;
+	if (ferror(f_input)) {
+		fprintf(stderr, "Input file read error\n");
+		return 1;
+	}
+	if (f_input != stdin)
+		fclose(f_input);
+	if (bpp != 1)
+		antialias(opt_scale);
+
+	/* Find the range of characters actually in the font */
+	for(first = opt_first; first <= opt_last && !glyphs[first].cell; first++);
+	for(last = opt_last; last >= first && !glyphs[last].cell; last--);
+	if (first > last) {
+		fprintf(stderr, "No characters found\n");
+		return 1;
+	}
+
+	/* Encode in both formats */
+	minwidth = MAX_SIZE;
+	maxwidth = 0;
+	rowslen = rlelen = 0;
+	rowsmax = rlemax = 0;
+	for(c = first; c <= last; c++) {
+		rowsoffsets[c] = rowslen;
+		rleoffsets[c] = rlelen;
+		if (!glyphs[c].width)
+			continue;
+		if (glyphs[c].width < minwidth) minwidth = glyphs[c].width;
+		if (glyphs[c].width > maxwidth) maxwidth = glyphs[c].width;
+		rowslen = encoderows(&glyphs[c], rowslen);
+		if (rowslen - rowsoffsets[c] > rowsmax) rowsmax = rowslen - rowsoffsets[c];
+		if (bpp == 1) {
+			rlelen = encoderle(&glyphs[c], rlelen);
+			if (rlelen - rleoffsets[c] > rlemax) rlemax = rlelen - rleoffsets[c];
+		}
+	}
+	if (minwidth > maxwidth)
+		minwidth = maxwidth;
+
+	/* Choose the format */
+	if (!opt_format)
+		opt_format = rlelen < rowslen ? FORMAT_RLE : FORMAT_ROWS;
+	if (opt_format == FORMAT_RLE) {
+		len = rlelen;
+		data = rle;
+		offsets = rleoffsets;
+		maxglyph = rlemax;
+	} else {
+		len = rowslen;
+		data = rows;
+		offsets = rowsoffsets;
+		maxglyph = rowsmax;
+	}
+	if (len > MAX_DATA) {
+		fprintf(stderr, "The font is too large - try a smaller character range\n");
+		return 1;
+	}
+
+	/* The characters up to MAX_DENSE are looked up directly */
+	tablelen = 0;
+	densefirst = 1;
+	denselast = 0;
+	if (first <= MAX_DENSE) {
+		densefirst = first;
+		for(denselast = last < MAX_DENSE ? last : MAX_DENSE; !glyphs[denselast].cell; denselast--);
+		for(c = densefirst; c <= denselast; c++)
+			table[tablelen++] = c;
+		if (offsets[denselast] > MAX_OFFSET) {
+			fprintf(stderr, "The characters up to %d are too large\n", MAX_DENSE);
+			return 1;
+		}
+	}
+
+	/*
+	 * The rest are in sparse ranges.
+	 *	Small gaps are filled with zero width characters as they cost less than a new range.
+	 *	A new range is also needed when the offsets get too big for a uint16_t.
+	 */
+	ranges = 0;
+	prev = 0;
+	for(c = denselast+1 > first ? denselast+1 : first; c <= last; c++) {
+		if (!glyphs[c].cell)
+			continue;
+		if (!ranges || c - prev > MAX_GAP+1 || offsets[c] - rangebase[ranges-1] > MAX_OFFSET || c - rangefirst[ranges-1] >= 0xFFFF) {
+			rangefirst[ranges] = c;
+			rangeindex[ranges] = tablelen;
+			rangebase[ranges] = offsets[c];
+			ranges++;
+		} else {
+			for(prev++; prev < c; prev++)
+				table[tablelen++] = prev;
+		}
+		table[tablelen++] = c;
+		rangecount[ranges-1] = c - rangefirst[ranges-1] + 1;
+		prev = c;
+	}
+	if (tablelen > 0xFFFF) {
+		fprintf(stderr, "The font has too many characters\n");
+		return 1;
+	}
+	if (maxglyph > 0xFFFF) {
+		fprintf(stderr, "The glyphs are too large for a font file\n");
+		return 1;
+	}
+
+	/* Open the output file */
+	if (opt_outputfile) {
+		f_output = fopen(opt_outputfile, opt_binary ? "wb" : "w");
+		if (!f_output) {
+			fprintf(stderr, "Could not open output file '%s'\n", opt_outputfile);
+			goto usage;
+		}
+	} else
+		f_output = stdout;
+
+	/* The font name for a binary font is the BDF family name */
+	if (opt_binary) {
+		if (!fontname[0])
+			strcpy(fontname, opt_fontname ? opt_fontname : "font");
+		fontname[255] = 0;
+
+		/* The header */
+		fwrite("GFNT", 4, 1, f_output);
+		fputc(1, f_output);
+		fputc(opt_format, f_output);
+		fputc(bpp, f_output);
+		fputc(height, f_output);
+		fputc(opt_padding, f_output);
+		fputc(height, f_output);
+		fputc(descent, f_output);
+		fputc(minwidth, f_output);
+		fputc(maxwidth, f_output);
+		fputc(densefirst, f_output);
+		fputc(denselast, f_output);
+		fputc(0, f_output);
+		put16(f_output, tablelen);
+		put16(f_output, ranges);
+		put16(f_output, maxglyph);
+		fputc(strlen(fontname), f_output);
+		fputc(0, f_output);
+		put32(f_output, len);
+
+		/* The name and the tables */
+		fwrite(fontname, strlen(fontname), 1, f_output);
+		for(c = 0; c < tablelen; c++)
+			fputc(glyphs[table[c]].width, f_output);
+		for(c = 0, prev = -1; c < tablelen; c++) {
+			if (prev+1 < ranges && c == (int)rangeindex[prev+1])
+				prev++;
+			put16(f_output, offsets[table[c]] - (prev >= 0 ? rangebase[prev] : 0));
+		}
+		for(c = 0; c < ranges; c++) {
+			put32(f_output, rangefirst[c]);
+			put16(f_output, rangecount[c]);
+			put16(f_output, rangeindex[c]);
+			put32(f_output, rangebase[c]);
+		}
+
+		/* The glyph data */
+		fwrite(data, len, 1, f_output);
+		goto done;
+	}
+
+	/* Print the comment header */
+	fprintf(f_output, "/**\n * This file was generated ");
+	if (opt_inputfile) fprintf(f_output, "from \"%s\" ", opt_inputfile);
+	fprintf(f_output, "using...\n *\n *\t%s", opt_progname);
+	if (opt_format == FORMAT_RLE) fprintf(f_output, " -l");
+	else fprintf(f_output, " -r");
+	if (opt_fontname) fprintf(f_output, " -n %s", opt_fontname);
+	if (opt_first != ' ') fprintf(f_output, " -f %d", opt_first);
+	if (opt_last != '~') fprintf(f_output, " -e %d", opt_last);
+	if (opt_padding) fprintf(f_output, " -p %d", opt_padding);
+	if (bpp != 1) fprintf(f_output, " -a %d -s %d", bpp, opt_scale);
+	if (opt_inputfile) fprintf(f_output, " %s", opt_inputfile);
+	if (opt_outputfile) fprintf(f_output, " %s", opt_outputfile);
+	fprintf(f_output, "\n *\n */\n");
+
+	/*
+	 * Set the font name.
+	 *	We do this after printing opt_inputfile for the last time as we
+	 *  modify opt_inputfile in place to generate opt_fontname.
+	 */
+	if (!opt_fontname) {
+		if (opt_inputfile)
+			opt_fontname = filenameof(opt_inputfile);
+		if (!opt_fontname || !opt_fontname[0])
+			opt_fontname = "font";
+	}
+	opt_fontname = clean4c(opt_fontname);
+	if (!fontname[0])
+		strcpy(fontname, opt_fontname);
+
+	fprintf(f_output, "\n#include \"ch.h\"\n#include \"hal.h\"\n#include \"gfx.h\"\n\n"
+						"#if GFX_USE_GDISP && GDISP_NEED_TEXT\n\n#include \"gdisp/fonts.h\"\n");
+
+	/* The width table */
+	fprintf(f_output, "\nstatic const uint8_t %s_Widths[] = {", opt_fontname);
+	for(c = 0; c < tablelen; c++)
+		fprintf(f_output, (c & 0x0F) ? " %d," : "\n\t%d,", glyphs[table[c]].width);
+
+	/* The offset table - relative to the base of each range */
+	fprintf(f_output, "\n};\n\nstatic const uint16_t %s_Offsets[] = {", opt_fontname);
+	for(c = 0, prev = -1; c < tablelen; c++) {
+		if (prev+1 < ranges && c == (int)rangeindex[prev+1])
+			prev++;
+		fprintf(f_output, (c & 0x07) ? " 0x%04X," : "\n\t0x%04X,", offsets[table[c]] - (prev >= 0 ? rangebase[prev] : 0));
+	}
+
+	/* The sparse ranges */
+	if (ranges) {
+		fprintf(f_output, "\n};\n\nstatic const fontrange_t %s_Ranges[] = {", opt_fontname);
+		for(c = 0; c < ranges; c++)
+			fprintf(f_output, "\n\t{0x%04X, %u, %u, 0x%X},", rangefirst[c], rangecount[c], rangeindex[c], rangebase[c]);
+	}
+
+	/* The glyph data */
+	fprintf(f_output, "\n};\n\nstatic const uint8_t %s_Data[] = {", opt_fontname);
+	for(len = 0; len < (opt_format == FORMAT_RLE ? rlelen : rowslen); len++)
+		fprintf(f_output, (len & 0x0F) ? " 0x%02X," : "\n\t0x%02X,", data[len]);
+	if (!len)
+		fprintf(f_output, "\n\t0");
+
+	/* The font structure */
+	fprintf(f_output, "\n};\n\nconst struct font %s = {\n"
+						"\t\"%s\",\n"
+						"\t%d, %d, %d, %d, %d, %d, %d, %d, 1, 1,\n"
+						"\t%s_Widths,\n"
+						"\t%s_Offsets,\n"
+						"\t0,\n"
+						"\t%s, %d, %s_Data,\n",
+				opt_fontname, fontname,
+				height, opt_padding, height, descent, minwidth, maxwidth, densefirst, denselast,
+				opt_fontname, opt_fontname,
+				opt_format == FORMAT_RLE ? "FONT_FORMAT_RLE" : "FONT_FORMAT_ROWS", bpp, opt_fontname);
+	if (ranges)
+		fprintf(f_output, "\t%s_Ranges, %d};\n", opt_fontname, ranges);
+	else
+		fprintf(f_output, "\t0, 0};\n");
+	fprintf(f_output, "\n#endif /* GFX_USE_GDISP && GDISP_NEED_TEXT */\n");
+
+	/* Clean up */
+done:
+	if (ferror(f_output))
+		fprintf(stderr, "Output file write error - disk full?\n");
+	if (f_output != stdout)
+		fclose(f_output);
+
+	return 0;
+}